@@ -210,6 +210,7 @@ function(halide_library_from_generator BASENAME)
   set(assembly_ext ".s")
   set(bitcode_ext ".bc")
   set(c_header_ext ".h")
+  set(compile_profile_ext ".compile_profile.json")
   set(featurization_ext ".featurization")
   set(llvm_assembly_ext ".ll")
   set(object_ext ${CMAKE_C_OUTPUT_EXTENSION})
@@ -519,6 +520,7 @@ function(_halide_runtime_target_name HALIDE_TARGET OUTVAR)
         wasm_signext
         sve
         sve2
+        llvm_fast_compile
       )
     # Synthesize a one-or-two-char abbreviation based on the feature's position
     # in the KNOWN_FEATURES list.
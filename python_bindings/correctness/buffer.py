@@ -258,6 +258,98 @@ def test_buffer_to_str():
     b = hl.Buffer(hl.Int(32), [128, 256])
     assert str(b) == '<halide.Buffer of type int32 shape:[[0,128,1],[0,256,128]]>'
 
+def test_reverse_axes_and_negative_strides():
+    a = np.arange(12, dtype=np.int32).reshape(3, 4)
+
+    b = hl.Buffer(a, reverse_axes = True)
+    assert b.dim(0).extent() == 4 and b.dim(0).stride() == 1
+    assert b.dim(1).extent() == 3 and b.dim(1).stride() == 4
+    assert b[3, 1] == a[1, 3]
+
+    # A reversed view shares the data, with negative strides.
+    r = a[::-1, ::-1]
+    b = hl.Buffer(r)
+    assert b.dim(0).stride() == -4 and b.dim(1).stride() == -1
+    for y in range(3):
+        for x in range(4):
+            assert b[y, x] == r[y, x]
+    b[0, 0] = 99
+    assert a[2, 3] == 99
+
+def test_array_interface():
+    class Wrapper:
+        # Exposes the array interface but not the buffer protocol.
+        def __init__(self, a):
+            self.a = a
+            self.__array_interface__ = a.__array_interface__
+
+    a = np.arange(24, dtype=np.float32).reshape(2, 3, 4)[:, ::-1, ::2]
+    b = hl.Buffer.from_array_interface(Wrapper(a), reverse_axes = True)
+    assert b.type() == hl.Float(32)
+    assert b.dim(0).extent() == 2 and b.dim(0).stride() == 2
+    assert b.dim(1).extent() == 3 and b.dim(1).stride() == -4
+    assert b[1, 2, 1] == a[1, 2, 1]
+
+    # Export, and check that no copy was made.
+    del a
+    gc.collect()
+    c = np.asarray(b)
+    b[0, 0, 0] = -1
+    assert c[0, 0, 0] == -1
+    iface = b.__array_interface__
+    assert iface["typestr"] == "<f4"
+    assert iface["shape"] == (2, 3, 2)
+    assert iface["strides"] == (8, -16, 48)
+
+    # Halide may write to any Buffer, so read-only arrays are refused.
+    r = np.zeros((2, 2), dtype=np.float32)
+    r.flags.writeable = False
+    try:
+        hl.Buffer.from_array_interface(Wrapper(r))
+    except ValueError:
+        pass
+    else:
+        assert False, "Expected a read-only array interface to be refused"
+
+def test_dlpack():
+    if not hasattr(np.ndarray, "__dlpack__"):
+        print("Skipping test_dlpack: numpy has no DLPack support")
+        return
+
+    a = np.arange(12, dtype=np.int16).reshape(3, 4)[:, 1:]
+
+    b = hl.Buffer.from_dlpack(a, reverse_axes = True)
+    assert b.type() == hl.Int(16)
+    assert b.dim(0).extent() == 3 and b.dim(1).extent() == 3
+    assert b[2, 1] == a[1, 2]
+    b[2, 1] = 1000
+    assert a[1, 2] == 1000
+
+    # The capsule is consumed, and its deleter runs when the Buffer goes away.
+    capsule = a.__dlpack__()
+    b = hl.Buffer.from_dlpack(capsule)
+    del b
+    gc.collect()
+
+    if hasattr(np, "from_dlpack"):
+        buf = hl.Buffer(hl.UInt(8), [4, 5])
+        buf.fill(7)
+        n = np.from_dlpack(buf)
+        assert n.shape == (4, 5)
+        buf[1, 2] = 3
+        assert n[1, 2] == 3
+        del buf
+        gc.collect()
+        # The export keeps the Buffer's memory alive.
+        assert n[0, 0] == 7
+
+        # Including when the Buffer is itself a view of a numpy array.
+        a = np.full((3, 2), 5, dtype=np.int32)
+        n = np.from_dlpack(hl.Buffer(a))
+        del a
+        gc.collect()
+        assert (n == 5).all()
+
 if __name__ == "__main__":
     test_make_interleaved()
     test_interleaved_ndarray()
@@ -271,3 +363,6 @@ if __name__ == "__main__":
     test_reorder()
     test_overflow()
     test_buffer_to_str()
+    test_reverse_axes_and_negative_strides()
+    test_array_interface()
+    test_dlpack()
@@ -0,0 +1,21 @@
+#include "Halide.h"
+
+using namespace Halide;
+
+class BufferConversionGenerator : public Halide::Generator<BufferConversionGenerator> {
+public:
+    Input<Buffer<int16_t>> input{"input", 2};
+
+    Output<Buffer<int16_t>> output{"output", 2};
+
+    Var x, y;
+
+    void generate() {
+        output(x, y) = input(x, y) * 2 + 1;
+    }
+
+    void schedule() {
+    }
+};
+
+HALIDE_REGISTER_GENERATOR(BufferConversionGenerator, buffer_conversion)
@@ -0,0 +1,106 @@
+import buffer_conversion
+import numpy
+import sys
+
+
+class ArrayInterfaceOnly:
+    """Exposes an array only through __array_interface__."""
+    def __init__(self, array):
+        self.array = array
+        self.__array_interface__ = array.__array_interface__
+
+
+class DLPackOnly:
+    """Exposes an array only through __dlpack__."""
+    def __init__(self, array):
+        self.array = array
+
+    def __dlpack__(self, stream=None):
+        return self.array.__dlpack__()
+
+    def __dlpack_device__(self):
+        return self.array.__dlpack_device__()
+
+
+def make_input(shape):
+    return numpy.arange(numpy.prod(shape), dtype=numpy.int16).reshape(shape)
+
+
+def check(input, output, wrap_input=lambda a: a, wrap_output=lambda a: a):
+    output[...] = 0
+    input_refs = sys.getrefcount(input)
+    output_refs = sys.getrefcount(output)
+    buffer_conversion.buffer_conversion(wrap_input(input), wrap_output(output))
+    assert numpy.array_equal(output, input * 2 + 1)
+    # Whatever kept the arrays alive during the call has been released.
+    assert sys.getrefcount(input) == input_refs
+    assert sys.getrefcount(output) == output_refs
+
+
+def check_all_paths(input, output):
+    check(input, output)
+    check(input, output, ArrayInterfaceOnly, ArrayInterfaceOnly)
+    check(input, output, DLPackOnly, DLPackOnly)
+
+
+def expect_error(input, output):
+    try:
+        buffer_conversion.buffer_conversion(input, output)
+    except (BufferError, ValueError):
+        return
+    assert False, "Expected an error"
+
+
+def test_compact():
+    check_all_paths(make_input((5, 7)), numpy.zeros((5, 7), dtype=numpy.int16))
+    check_all_paths(numpy.asfortranarray(make_input((5, 7))),
+                    numpy.zeros((5, 7), dtype=numpy.int16, order='F'))
+
+
+def test_strided():
+    input = make_input((10, 21))[::2, ::3]
+    output = numpy.zeros((15, 14), dtype=numpy.int16)[::3, ::2]
+    assert input.shape == output.shape
+    check_all_paths(input, output)
+
+
+def test_negative_strides():
+    input = make_input((5, 7))[::-1, :]
+    output = numpy.zeros((5, 7), dtype=numpy.int16)[:, ::-1]
+    check_all_paths(input, output)
+    check_all_paths(make_input((10, 14))[::-2, ::-2],
+                    numpy.zeros((5, 7), dtype=numpy.int16))
+
+
+def test_read_only():
+    input = make_input((5, 7))
+    input.flags.writeable = False
+    output = numpy.zeros((5, 7), dtype=numpy.int16)
+    # Read-only inputs are fine...
+    check(input, output)
+    check(input, output, ArrayInterfaceOnly)
+    # ...but read-only outputs are not.
+    read_only = numpy.zeros((5, 7), dtype=numpy.int16)
+    read_only.flags.writeable = False
+    expect_error(output, read_only)
+    expect_error(output, ArrayInterfaceOnly(read_only))
+    expect_error(output, DLPackOnly(read_only))
+    assert not read_only.any()
+
+
+def test_wrong_arguments():
+    output = numpy.zeros((5, 7), dtype=numpy.int16)
+    expect_error(make_input((35,)), output)
+    expect_error(ArrayInterfaceOnly(make_input((35,))), output)
+    expect_error(DLPackOnly(make_input((35,))), output)
+    expect_error(make_input((5, 7)).astype(numpy.float32), output)
+    # The input must cover the output.
+    expect_error(make_input((4, 7)), output)
+
+
+if __name__ == "__main__":
+    test_compact()
+    test_strided()
+    test_negative_strides()
+    test_read_only()
+    test_wrong_arguments()
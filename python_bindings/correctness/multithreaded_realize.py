@@ -0,0 +1,99 @@
+import halide as hl
+import os
+import tempfile
+import threading
+import time
+
+# Pipelines run, and compile, with the GIL released, so realizations
+# from several Python threads may run concurrently.
+
+def make_slow_func():
+    x, y = hl.Var('x'), hl.Var('y')
+    r = hl.RDom([(0, 200)])
+    f = hl.Func('slow')
+    f[x, y] = hl.f32(0)
+    f[x, y] += hl.sin(hl.f32(x + y + r.x))
+    # No parallelism inside the pipeline: any speedup must come from
+    # the Python threads themselves.
+    return f
+
+def run_in_threads(fn, count):
+    threads = [threading.Thread(target = fn, args = (i,)) for i in range(count)]
+    start = time.time()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return time.time() - start
+
+def test_concurrent_realize():
+    f = make_slow_func()
+    f.compile_jit()
+
+    num_threads = 4
+    reps = 4
+    size = 256
+    expected = f.realize(size, size)
+    results = [None] * num_threads
+
+    def work(i):
+        for _ in range(reps):
+            buf = hl.Buffer(hl.Float(32), [size, size])
+            f.realize(buf)
+            results[i] = buf
+
+    # Take the best of a few tries, to be less sensitive to the load on
+    # the machine.
+    serial = min(run_in_threads(work, 1) for _ in range(3)) * num_threads
+    parallel = min(run_in_threads(work, num_threads) for _ in range(3))
+    print("Serial: %f s, %d threads: %f s" % (serial, num_threads, parallel))
+    if (os.cpu_count() or 1) >= 2:
+        assert parallel < 0.8 * serial, "Realizing from several threads was not faster"
+
+    for buf in results:
+        for y in range(0, size, 37):
+            for x in range(0, size, 41):
+                assert buf[x, y] == expected[x, y]
+
+def test_print_from_thread():
+    # Printing calls back into Python, which must not wait for the GIL.
+    x = hl.Var('x')
+    f = hl.Func('printer')
+    f[x] = hl.print_when(x == 0, x, "printed from a pipeline on a Python thread")
+    f.compile_jit()
+
+    def work(i):
+        f.realize(4)
+
+    run_in_threads(work, 2)
+
+def test_warning_while_compiling():
+    # A warning issued while one thread compiles must not wait for the
+    # GIL, which another thread may hold while it waits to compile.
+    x, xo, xi = hl.Var('x'), hl.Var('xo'), hl.Var('xi')
+    g = hl.Func('inlined')
+    g[x] = x
+    # Splitting a Func that is inlined warns when it is lowered.
+    g.split(x, xo, xi, 4)
+    f = hl.Func('warns')
+    f[x] = g[x] + 1
+    other = hl.Func('other')
+    other[x] = x * 2
+
+    with tempfile.TemporaryDirectory() as dir:
+        def work(i):
+            for _ in range(4):
+                if i == 0:
+                    f.compile_jit()
+                    f.compile_to_lowered_stmt(os.path.join(dir, "warns.stmt"), [])
+                else:
+                    other.compile_to_lowered_stmt(os.path.join(dir, "other.stmt"), [])
+
+        run_in_threads(work, 2)
+
+    assert f.realize(4)[3] == 4
+
+if __name__ == "__main__":
+    test_concurrent_realize()
+    test_print_from_thread()
+    test_warning_while_compiling()
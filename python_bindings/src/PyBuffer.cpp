@@ -228,31 +228,322 @@ py::object buffer_setitem_operator(Buffer<> &buf, const std::vector<int> &pos, p
     return py::object();
 }
 
+// The subset of DLPack (https://github.com/dmlc/dlpack) needed to
+// exchange tensors that live in host memory.
+struct DLDevice {
+    int32_t device_type;
+    int32_t device_id;
+};
+
+struct DLDataType {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+};
+
+struct DLTensor {
+    void *data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t *shape;
+    int64_t *strides;
+    uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void *manager_ctx;
+    void (*deleter)(DLManagedTensor *self);
+};
+
+enum { kDLCPU = 1,
+       kDLCPUPinned = 3 };
+
+enum { kDLInt = 0,
+       kDLUInt = 1,
+       kDLFloat = 2,
+       kDLBfloat = 4,
+       kDLBool = 6 };
+
+// Make the dimensions of a view of an array with the given shape and
+// strides (in elements), which are outermost-first as Python orders
+// them. Python's order is kept unless reverse_axes is set, in which
+// case the last axis becomes dimension 0, as is usual in Halide.
+std::vector<halide_dimension_t> make_dims(const std::vector<int64_t> &shape,
+                                          const std::vector<int64_t> &strides,
+                                          bool reverse_axes) {
+    const size_t n = shape.size();
+    std::vector<halide_dimension_t> dims(n);
+    for (size_t i = 0; i < n; i++) {
+        const size_t j = reverse_axes ? n - 1 - i : i;
+        if (shape[j] > INT_MAX || strides[j] > INT_MAX || strides[j] < -INT_MAX) {
+            throw py::value_error("Out of range arguments to make_dims.");
+        }
+        dims[i] = {0, (int32_t)shape[j], (int32_t)strides[j]};
+    }
+    return dims;
+}
+
+// The strides of a compact row-major array, as implied by a missing
+// strides field in DLPack and the array interface.
+std::vector<int64_t> row_major_strides(const std::vector<int64_t> &shape) {
+    std::vector<int64_t> strides(shape.size());
+    int64_t stride = 1;
+    for (size_t i = shape.size(); i > 0; i--) {
+        strides[i - 1] = stride;
+        stride *= shape[i - 1];
+    }
+    return strides;
+}
+
+// Wrap a Buffer<> viewing memory owned by someone else in a Python
+// object. The caller must keep the owner alive for as long as the
+// result exists.
+py::object wrap_foreign_buffer(Buffer<> b) {
+    // As with buffers made from a py::buffer, assume the host data is
+    // current.
+    b.set_host_dirty();
+    return py::cast(b);
+}
+
+// Keep owner alive until nurse is garbage collected, by holding a
+// reference to it in the callback of a weak reference to nurse.
+void keep_alive_while(py::handle nurse, py::object owner) {
+    py::cpp_function release([owner](py::handle weakref) {
+        weakref.dec_ref();
+    });
+    (void)py::weakref(nurse, release).release();
+}
+
+py::object buffer_from_dlpack(py::object obj, const std::string &name, bool reverse_axes) {
+    py::object capsule = py::hasattr(obj, "__dlpack__") ? obj.attr("__dlpack__")() : obj;
+    DLManagedTensor *managed = (DLManagedTensor *)PyCapsule_GetPointer(capsule.ptr(), "dltensor");
+    if (!managed) {
+        throw py::error_already_set();
+    }
+    // We now own the tensor, and must call its deleter exactly once,
+    // when the last Buffer<> viewing it goes away.
+    PyCapsule_SetName(capsule.ptr(), "used_dltensor");
+    py::capsule owner(managed, [](void *p) {
+        DLManagedTensor *t = (DLManagedTensor *)p;
+        if (t->deleter) {
+            t->deleter(t);
+        }
+    });
+
+    const DLTensor &t = managed->dl_tensor;
+    if (t.device.device_type != kDLCPU && t.device.device_type != kDLCPUPinned) {
+        throw py::value_error("Only DLPack tensors in host memory can be converted to a Buffer.");
+    }
+    if (t.dtype.lanes != 1) {
+        throw py::value_error("Vector DLPack types are not supported.");
+    }
+    Type type;
+    switch (t.dtype.code) {
+    case kDLInt:
+        type = Int(t.dtype.bits);
+        break;
+    case kDLUInt:
+        type = UInt(t.dtype.bits);
+        break;
+    case kDLFloat:
+        type = Float(t.dtype.bits);
+        break;
+    case kDLBfloat:
+        type = BFloat(t.dtype.bits);
+        break;
+    case kDLBool:
+        type = Bool();
+        break;
+    default:
+        throw py::value_error("Unsupported DLPack type.");
+    }
+
+    std::vector<int64_t> shape(t.shape, t.shape + t.ndim);
+    std::vector<int64_t> strides = t.strides ? std::vector<int64_t>(t.strides, t.strides + t.ndim) : row_major_strides(shape);
+    Buffer<> b(type, (void *)((uint8_t *)t.data + t.byte_offset), t.ndim,
+               make_dims(shape, strides, reverse_axes).data(), name);
+    py::object result = wrap_foreign_buffer(b);
+    keep_alive_while(result, owner);
+    return result;
+}
+
+py::capsule buffer_to_dlpack(py::object self) {
+    const Buffer<> &b = self.cast<const Buffer<> &>();
+    if (b.data() == nullptr) {
+        throw py::value_error("Cannot export a Buffer<> with null host ptr through DLPack.");
+    }
+    if (b.device_dirty()) {
+        throw py::value_error("Cannot export a Buffer<> through DLPack while it is dirty on the device; call copy_to_host() first.");
+    }
+
+    // Everything the consumer sees, kept alive until it calls the
+    // deleter. The Python object, rather than just the Buffer<>, is
+    // held, as it may be what keeps the memory alive (e.g. for a
+    // Buffer made from a numpy array).
+    struct Export {
+        py::object owner;
+        std::vector<int64_t> shape, strides;
+        DLManagedTensor tensor;
+    };
+    std::unique_ptr<Export> e(new Export);
+    e->owner = self;
+    for (int i = 0; i < b.dimensions(); i++) {
+        e->shape.push_back(b.dim(i).extent());
+        e->strides.push_back(b.dim(i).stride());
+    }
+
+    const Type t = b.type();
+    DLDataType dtype = {0, (uint8_t)t.bits(), 1};
+    if (t.is_bool()) {
+        dtype = {kDLBool, 8, 1};
+    } else if (t.is_int()) {
+        dtype.code = kDLInt;
+    } else if (t.is_uint()) {
+        dtype.code = kDLUInt;
+    } else if (t.is_bfloat()) {
+        dtype.code = kDLBfloat;
+    } else if (t.is_float()) {
+        dtype.code = kDLFloat;
+    } else {
+        throw py::value_error("Unsupported Buffer<> type for DLPack.");
+    }
+
+    DLTensor &dl = e->tensor.dl_tensor;
+    dl.data = b.data();
+    dl.device = {kDLCPU, 0};
+    dl.ndim = b.dimensions();
+    dl.dtype = dtype;
+    dl.shape = e->shape.data();
+    dl.strides = e->strides.data();
+    dl.byte_offset = 0;
+    e->tensor.manager_ctx = e.get();
+    e->tensor.deleter = [](DLManagedTensor *t) {
+        // The consumer may call this from any thread, and releasing
+        // the owner needs the GIL.
+        py::gil_scoped_acquire acquire;
+        delete (Export *)t->manager_ctx;
+    };
+
+    // If the capsule is never consumed, free the tensor with it.
+    return py::capsule(&e.release()->tensor, "dltensor", [](PyObject *capsule) {
+        if (PyCapsule_IsValid(capsule, "dltensor")) {
+            DLManagedTensor *t = (DLManagedTensor *)PyCapsule_GetPointer(capsule, "dltensor");
+            t->deleter(t);
+        }
+    });
+}
+
+// See https://numpy.org/doc/stable/reference/arrays.interface.html
+std::string type_to_typestr(const Type &t) {
+    char kind;
+    if (t.is_bool()) {
+        return "|b1";
+    } else if (t.is_int()) {
+        kind = 'i';
+    } else if (t.is_uint()) {
+        kind = 'u';
+    } else if (t.is_float() && !t.is_bfloat()) {
+        kind = 'f';
+    } else {
+        throw py::value_error("Unsupported Buffer<> type for the array interface.");
+    }
+    return std::string(t.bytes() == 1 ? "|" : "<") + kind + std::to_string(t.bytes());
+}
+
+Type typestr_to_type(const std::string &typestr) {
+    if (typestr.size() < 3 || typestr[0] == '>') {
+        throw py::value_error("Unsupported array interface type: " + typestr);
+    }
+    const int bits = std::atoi(typestr.c_str() + 2) * 8;
+    switch (typestr[1]) {
+    case 'b':
+        return Bool();
+    case 'i':
+        return Int(bits);
+    case 'u':
+        return UInt(bits);
+    case 'f':
+        return Float(bits);
+    default:
+        throw py::value_error("Unsupported array interface type: " + typestr);
+    }
+}
+
+py::dict buffer_to_array_interface(const Buffer<> &b) {
+    if (b.data() == nullptr) {
+        throw py::value_error("Cannot export a Buffer<> with null host ptr through the array interface.");
+    }
+    const int bytes = b.type().bytes();
+    py::list shape, strides;
+    for (int i = 0; i < b.dimensions(); i++) {
+        shape.append(b.dim(i).extent());
+        strides.append((int64_t)b.dim(i).stride() * bytes);
+    }
+    py::dict d;
+    d["version"] = 3;
+    d["shape"] = py::tuple(shape);
+    d["strides"] = py::tuple(strides);
+    d["typestr"] = type_to_typestr(b.type());
+    d["data"] = py::make_tuple((uintptr_t)b.data(), false);
+    return d;
+}
+
+py::object buffer_from_array_interface(py::object obj, const std::string &name, bool reverse_axes) {
+    py::dict d = obj.attr("__array_interface__");
+    if (!py::isinstance<py::tuple>(d["data"])) {
+        throw py::value_error("Only array interfaces with a (pointer, read_only) data tuple are supported.");
+    }
+    py::tuple data_tuple = d["data"].cast<py::tuple>();
+    // Halide may write to any Buffer<>, so refuse read-only memory, as
+    // the buffer protocol constructor does.
+    if (data_tuple[1].cast<bool>()) {
+        throw py::value_error("Cannot make a Buffer<> from a read-only array interface.");
+    }
+    const Type type = typestr_to_type(py::str(d["typestr"]));
+    std::vector<int64_t> shape = d["shape"].cast<std::vector<int64_t>>();
+    std::vector<int64_t> strides;
+    if (d.contains("strides") && !d["strides"].is_none()) {
+        for (int64_t s : d["strides"].cast<std::vector<int64_t>>()) {
+            if (s % type.bytes()) {
+                throw py::value_error("Array interface strides must be a multiple of the element size.");
+            }
+            strides.push_back(s / type.bytes());
+        }
+    } else {
+        strides = row_major_strides(shape);
+    }
+    void *data = (void *)data_tuple[0].cast<uintptr_t>();
+    Buffer<> b(type, data, (int)shape.size(), make_dims(shape, strides, reverse_axes).data(), name);
+    return wrap_foreign_buffer(b);
+}
+
 // Use an alias class so that if we are created via a py::buffer, we can
 // keep the py::buffer_info class alive for the life of the Buffer<>,
 // ensuring the data isn't collected out from under us.
 class PyBuffer : public Buffer<> {
     py::buffer_info info;
 
-    static std::vector<halide_dimension_t> make_dim_vec(const py::buffer_info &info) {
+    static std::vector<halide_dimension_t> make_dim_vec(const py::buffer_info &info, bool reverse_axes) {
         const Type t = format_descriptor_to_type(info.format);
-        std::vector<halide_dimension_t> dims;
-        dims.reserve(info.ndim);
+        std::vector<int64_t> shape, strides;
         for (int i = 0; i < info.ndim; i++) {
-            if (INT_MAX < info.shape[i] || INT_MAX < (info.strides[i] / t.bytes())) {
-                throw py::value_error("Out of range arguments to make_dim_vec.");
+            if (info.strides[i] % t.bytes()) {
+                throw py::value_error("Buffer strides must be a multiple of the element size.");
             }
-            dims.push_back({0, (int32_t)info.shape[i], (int32_t)(info.strides[i] / t.bytes())});
+            shape.push_back(info.shape[i]);
+            strides.push_back(info.strides[i] / t.bytes());
         }
-        return dims;
+        return make_dims(shape, strides, reverse_axes);
     }
 
-    PyBuffer(py::buffer_info &&info, const std::string &name)
+    PyBuffer(py::buffer_info &&info, const std::string &name, bool reverse_axes)
         : Buffer<>(
               format_descriptor_to_type(info.format),
               info.ptr,
               (int)info.ndim,
-              make_dim_vec(info).data(),
+              make_dim_vec(info, reverse_axes).data(),
               name),
           info(std::move(info)) {
     }
@@ -266,8 +557,8 @@ public:
         : Buffer<>(b), info() {
     }
 
-    PyBuffer(py::buffer buffer, const std::string &name)
-        : PyBuffer(buffer.request(/*writable*/ true), name) {
+    PyBuffer(py::buffer buffer, const std::string &name, bool reverse_axes)
+        : PyBuffer(buffer.request(/*writable*/ true), name, reverse_axes) {
         // Default to setting host-dirty on any PyBuffer we create from an existing py::buffer;
         // this allows (e.g.) code like
         //
@@ -329,8 +620,10 @@ void define_buffer(py::module &m) {
             })
 
             // This allows us to use any buffer-like python entity to create a Buffer<>
-            // (most notably, an ndarray)
-            .def(py::init_alias<py::buffer, const std::string &>(), py::arg("buffer"), py::arg("name") = "")
+            // (most notably, an ndarray). Negative strides are honored. By default,
+            // dimension i of the Buffer<> is axis i of the array; pass reverse_axes=True
+            // to make the last (usually innermost) axis dimension 0 instead.
+            .def(py::init_alias<py::buffer, const std::string &, bool>(), py::arg("buffer"), py::arg("name") = "", py::arg("reverse_axes") = false)
             .def(py::init_alias<>())
             .def(py::init_alias<const Buffer<> &>())
             .def(py::init([](Type type, const std::vector<int> &sizes, const std::string &name) -> Buffer<> {
@@ -359,6 +652,25 @@ void define_buffer(py::module &m) {
                 },
                 py::arg("src"), py::arg("name") = "")
 
+            // Zero-copy views of tensors from other frameworks (e.g. PyTorch), through
+            // DLPack or the NumPy array interface. The Buffer<> keeps the source alive.
+            .def_static("from_dlpack", &buffer_from_dlpack,
+                        py::arg("tensor"), py::arg("name") = "", py::arg("reverse_axes") = false)
+            .def_static("from_array_interface", &buffer_from_array_interface,
+                        py::arg("array"), py::arg("name") = "", py::arg("reverse_axes") = false,
+                        py::keep_alive<0, 1>())  // Keep the array alive while the Buffer<> exists
+
+            // Zero-copy export, in the same dimension order as the buffer protocol.
+            // Host memory needs no stream synchronization, so the stream
+            // (and any other consumer-specific arguments) can be ignored.
+            .def("__dlpack__", [](py::object self, py::args args, py::kwargs kwargs) -> py::capsule {
+                return buffer_to_dlpack(self);
+            })
+            .def("__dlpack_device__", [](const Buffer<> &b) -> py::tuple {
+                return py::make_tuple((int)kDLCPU, 0);
+            })
+            .def_property_readonly("__array_interface__", &buffer_to_array_interface)
+
             .def("set_name", &Buffer<>::set_name)
             .def("name", &Buffer<>::name)
 
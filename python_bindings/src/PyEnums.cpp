@@ -4,6 +4,11 @@ namespace Halide {
 namespace PythonBindings {
 
 void define_enums(py::module &m) {
+    py::enum_<ApproximationPrecision>(m, "ApproximationPrecision")
+        .value("Low", ApproximationPrecision::Low)
+        .value("Medium", ApproximationPrecision::Medium)
+        .value("High", ApproximationPrecision::High);
+
     py::enum_<Argument::Kind>(m, "ArgumentKind")
         .value("InputScalar", Argument::Kind::InputScalar)
         .value("InputBuffer", Argument::Kind::InputBuffer)
@@ -142,6 +147,7 @@ void define_enums(py::module &m) {
         .value("WasmSignExt", Target::Feature::WasmSignExt)
         .value("SVE", Target::Feature::SVE)
         .value("SVE2", Target::Feature::SVE2)
+        .value("LLVMFastCompile", Target::Feature::LLVMFastCompile)
         .value("FeatureEnd", Target::Feature::FeatureEnd);
 
     py::enum_<halide_type_code_t>(m, "TypeCode")
@@ -155,6 +161,7 @@ void define_enums(py::module &m) {
         .value("bitcode", Output::bitcode)
         .value("c_header", Output::c_header)
         .value("c_source", Output::c_source)
+        .value("compile_profile", Output::compile_profile)
         .value("cpp_stub", Output::cpp_stub)
         .value("featurization", Output::featurization)
         .value("llvm_assembly", Output::llvm_assembly)
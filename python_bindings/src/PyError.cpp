@@ -1,22 +1,60 @@
 #include "PyError.h"
 
+#include <mutex>
+#include <string>
+
 namespace Halide {
 namespace PythonBindings {
 
 namespace {
 
+// Pipelines run, and compilation happens, with the GIL released, so
+// messages may come from threads that don't hold it. Acquiring it
+// there can deadlock, e.g. when a warning is issued by a compilation
+// holding locks that the thread holding the GIL is waiting for. So
+// messages are queued, and printed by the main thread once it next
+// holds the GIL.
+std::mutex pending_output_mutex;
+std::string pending_output;
+bool print_scheduled = false;
+
+int print_pending_output(void *) {
+    std::string msg;
+    {
+        std::lock_guard<std::mutex> lock(pending_output_mutex);
+        msg.swap(pending_output);
+        print_scheduled = false;
+    }
+    try {
+        py::print(msg, py::arg("end") = "");
+    } catch (py::error_already_set &e) {
+        e.restore();
+        return -1;
+    }
+    return 0;
+}
+
+void print_later(const char *msg) {
+    std::lock_guard<std::mutex> lock(pending_output_mutex);
+    pending_output += msg;
+    if (!print_scheduled) {
+        // If Python's queue is full, the next message tries again.
+        print_scheduled = Py_AddPendingCall(print_pending_output, nullptr) == 0;
+    }
+}
+
 void halide_python_error(void *, const char *msg) {
     throw Error(msg);
 }
 
 void halide_python_print(void *, const char *msg) {
-    py::print(msg, py::arg("end") = "");
+    print_later(msg);
 }
 
 class HalidePythonCompileTimeErrorReporter : public CompileTimeErrorReporter {
 public:
     void warning(const char *msg) {
-        py::print(msg, py::arg("end") = "");
+        print_later(msg);
     }
 
     void error(const char *msg) {
@@ -4,6 +4,7 @@
 #include "PyExpr.h"
 #include "PyFuncRef.h"
 #include "PyLoopLevel.h"
+#include "PyRealization.h"
 #include "PyScheduleMethods.h"
 #include "PyStage.h"
 #include "PyTuple.h"
@@ -68,16 +69,6 @@ void define_set_func_ref<double>(py::class_<Func> &func_class) {
              });
 }
 
-py::object realization_to_object(const Realization &r) {
-    // Only one Buffer -> just return it
-    if (r.size() == 1) {
-        return py::cast(r[0]);
-    }
-
-    // Multiple -> return as Python tuple
-    return to_python_tuple(r);
-}
-
 }  // namespace
 
 void define_func(py::module &m) {
@@ -117,7 +108,7 @@ void define_func(py::module &m) {
                 [](Func &f, Buffer<> buffer, const Target &target) -> void {
                     f.realize(buffer, target);
                 },
-                py::arg("dst"), py::arg("target") = Target())
+                py::arg("dst"), py::arg("target") = Target(), py::call_guard<py::gil_scoped_release>())
 
             // This will actually allow a list-of-buffers as well as a tuple-of-buffers, but that's OK.
             .def(
@@ -125,12 +116,12 @@ void define_func(py::module &m) {
                 [](Func &f, std::vector<Buffer<>> buffers, const Target &t) -> void {
                     f.realize(Realization(buffers), t);
                 },
-                py::arg("dst"), py::arg("target") = Target())
+                py::arg("dst"), py::arg("target") = Target(), py::call_guard<py::gil_scoped_release>())
 
             .def(
                 "realize",
                 [](Func &f, std::vector<int32_t> sizes, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(sizes, target));
+                    return realize_without_gil([&]() { return f.realize(sizes, target); });
                 },
                 py::arg("sizes") = std::vector<int32_t>{}, py::arg("target") = Target())
 
@@ -138,7 +129,7 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, int x_size, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(x_size, target));
+                    return realize_without_gil([&]() { return f.realize(x_size, target); });
                 },
                 py::arg("x_size"), py::arg("target") = Target())
 
@@ -146,7 +137,7 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, int x_size, int y_size, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(x_size, y_size, target));
+                    return realize_without_gil([&]() { return f.realize(x_size, y_size, target); });
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("target") = Target())
 
@@ -154,7 +145,7 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, int x_size, int y_size, int z_size, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(x_size, y_size, z_size, target));
+                    return realize_without_gil([&]() { return f.realize(x_size, y_size, z_size, target); });
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("target") = Target())
 
@@ -162,7 +153,7 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, int x_size, int y_size, int z_size, int w_size, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(x_size, y_size, z_size, w_size, target));
+                    return realize_without_gil([&]() { return f.realize(x_size, y_size, z_size, w_size, target); });
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("w_size"), py::arg("target") = Target())
 
@@ -199,37 +190,38 @@ void define_func(py::module &m) {
             .def("store_root", &Func::store_root)
 
             .def("store_in", &Func::store_in, py::arg("memory_type"))
+            .def("store_nontemporal", &Func::store_nontemporal)
 
-            .def("compile_to", &Func::compile_to, py::arg("outputs"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+            .def("compile_to", &Func::compile_to, py::arg("outputs"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_bitcode", (void (Func::*)(const std::string &, const std::vector<Argument> &, const std::string &, const Target &target)) & Func::compile_to_bitcode, py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
-            .def("compile_to_bitcode", (void (Func::*)(const std::string &, const std::vector<Argument> &, const Target &target)) & Func::compile_to_bitcode, py::arg("filename"), py::arg("arguments"), py::arg("target") = get_target_from_environment())
+            .def("compile_to_bitcode", (void (Func::*)(const std::string &, const std::vector<Argument> &, const std::string &, const Target &target)) & Func::compile_to_bitcode, py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
+            .def("compile_to_bitcode", (void (Func::*)(const std::string &, const std::vector<Argument> &, const Target &target)) & Func::compile_to_bitcode, py::arg("filename"), py::arg("arguments"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_llvm_assembly", (void (Func::*)(const std::string &, const std::vector<Argument> &, const std::string &, const Target &target)) & Func::compile_to_llvm_assembly, py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
-            .def("compile_to_llvm_assembly", (void (Func::*)(const std::string &, const std::vector<Argument> &, const Target &target)) & Func::compile_to_llvm_assembly, py::arg("filename"), py::arg("arguments"), py::arg("target") = get_target_from_environment())
+            .def("compile_to_llvm_assembly", (void (Func::*)(const std::string &, const std::vector<Argument> &, const std::string &, const Target &target)) & Func::compile_to_llvm_assembly, py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
+            .def("compile_to_llvm_assembly", (void (Func::*)(const std::string &, const std::vector<Argument> &, const Target &target)) & Func::compile_to_llvm_assembly, py::arg("filename"), py::arg("arguments"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_object", (void (Func::*)(const std::string &, const std::vector<Argument> &, const std::string &, const Target &target)) & Func::compile_to_object, py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
-            .def("compile_to_object", (void (Func::*)(const std::string &, const std::vector<Argument> &, const Target &target)) & Func::compile_to_object, py::arg("filename"), py::arg("arguments"), py::arg("target") = get_target_from_environment())
+            .def("compile_to_object", (void (Func::*)(const std::string &, const std::vector<Argument> &, const std::string &, const Target &target)) & Func::compile_to_object, py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
+            .def("compile_to_object", (void (Func::*)(const std::string &, const std::vector<Argument> &, const Target &target)) & Func::compile_to_object, py::arg("filename"), py::arg("arguments"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_header", &Func::compile_to_header, py::arg("filename"), py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment())
+            .def("compile_to_header", &Func::compile_to_header, py::arg("filename"), py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_assembly", (void (Func::*)(const std::string &, const std::vector<Argument> &, const std::string &, const Target &target)) & Func::compile_to_assembly, py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
-            .def("compile_to_assembly", (void (Func::*)(const std::string &, const std::vector<Argument> &, const Target &target)) & Func::compile_to_assembly, py::arg("filename"), py::arg("arguments"), py::arg("target") = get_target_from_environment())
+            .def("compile_to_assembly", (void (Func::*)(const std::string &, const std::vector<Argument> &, const std::string &, const Target &target)) & Func::compile_to_assembly, py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
+            .def("compile_to_assembly", (void (Func::*)(const std::string &, const std::vector<Argument> &, const Target &target)) & Func::compile_to_assembly, py::arg("filename"), py::arg("arguments"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_c", &Func::compile_to_c, py::arg("filename"), py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment())
+            .def("compile_to_c", &Func::compile_to_c, py::arg("filename"), py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_lowered_stmt", &Func::compile_to_lowered_stmt, py::arg("filename"), py::arg("arguments"), py::arg("fmt") = Text, py::arg("target") = get_target_from_environment())
+            .def("compile_to_lowered_stmt", &Func::compile_to_lowered_stmt, py::arg("filename"), py::arg("arguments"), py::arg("fmt") = Text, py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_file", &Func::compile_to_file, py::arg("filename_prefix"), py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment())
+            .def("compile_to_file", &Func::compile_to_file, py::arg("filename_prefix"), py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_static_library", &Func::compile_to_static_library, py::arg("filename_prefix"), py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment())
+            .def("compile_to_static_library", &Func::compile_to_static_library, py::arg("filename_prefix"), py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_to_multitarget_static_library", &Func::compile_to_multitarget_static_library, py::arg("filename_prefix"), py::arg("arguments"), py::arg("targets"))
+            .def("compile_to_multitarget_static_library", &Func::compile_to_multitarget_static_library, py::arg("filename_prefix"), py::arg("arguments"), py::arg("targets"), py::call_guard<py::gil_scoped_release>())
 
             // TODO: useless until Module is defined.
-            .def("compile_to_module", &Func::compile_to_module, py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment())
+            .def("compile_to_module", &Func::compile_to_module, py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_jit", &Func::compile_jit, py::arg("target") = get_jit_target_from_environment())
+            .def("compile_jit", &Func::compile_jit, py::arg("target") = get_jit_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
             .def("has_update_definition", &Func::has_update_definition)
             .def("num_update_definitions", &Func::num_update_definitions)
@@ -272,19 +264,19 @@ void define_func(py::module &m) {
                 "infer_input_bounds", [](Func &f, int x_size, int y_size, int z_size, int w_size) -> void {
                     f.infer_input_bounds(x_size, y_size, z_size, w_size);
                 },
-                py::arg("x_size") = 0, py::arg("y_size") = 0, py::arg("z_size") = 0, py::arg("w_size") = 0)
+                py::arg("x_size") = 0, py::arg("y_size") = 0, py::arg("z_size") = 0, py::arg("w_size") = 0, py::call_guard<py::gil_scoped_release>())
 
             .def(
                 "infer_input_bounds", [](Func &f, Buffer<> buffer) -> void {
                     f.infer_input_bounds(buffer);
                 },
-                py::arg("dst"))
+                py::arg("dst"), py::call_guard<py::gil_scoped_release>())
 
             .def(
                 "infer_input_bounds", [](Func &f, std::vector<Buffer<>> buffer) -> void {
                     f.infer_input_bounds(Realization(buffer));
                 },
-                py::arg("dst"))
+                py::arg("dst"), py::call_guard<py::gil_scoped_release>())
 
             .def("in_", (Func(Func::*)(const Func &)) & Func::in, py::arg("f"))
             .def("in_", (Func(Func::*)(const std::vector<Func> &fs)) & Func::in, py::arg("fs"))
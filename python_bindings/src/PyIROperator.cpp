@@ -134,6 +134,13 @@ void define_operators(py::module &m) {
     m.def("fast_log", &fast_log);
     m.def("fast_exp", &fast_exp);
     m.def("fast_pow", &fast_pow);
+    m.def("fast_exp2", &fast_exp2, py::arg("x"), py::arg("precision") = ApproximationPrecision::Medium);
+    m.def("fast_log2", &fast_log2, py::arg("x"), py::arg("precision") = ApproximationPrecision::Medium);
+    m.def("fast_tanh", &fast_tanh, py::arg("x"), py::arg("precision") = ApproximationPrecision::Medium);
+    m.def("fast_sigmoid", &fast_sigmoid, py::arg("x"), py::arg("precision") = ApproximationPrecision::Medium);
+    m.def("fast_erf", &fast_erf, py::arg("x"), py::arg("precision") = ApproximationPrecision::Medium);
+    m.def("fast_atan", &fast_atan, py::arg("x"), py::arg("precision") = ApproximationPrecision::Medium);
+    m.def("fast_atan2", &fast_atan2, py::arg("y"), py::arg("x"), py::arg("precision") = ApproximationPrecision::Medium);
     m.def("fast_inverse", &fast_inverse);
     m.def("fast_inverse_sqrt", &fast_inverse_sqrt);
     m.def("floor", &floor);
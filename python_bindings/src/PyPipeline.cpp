@@ -1,24 +1,11 @@
 #include "PyPipeline.h"
 
+#include "PyRealization.h"
 #include "PyTuple.h"
 
 namespace Halide {
 namespace PythonBindings {
 
-namespace {
-
-py::object realization_to_object(const Realization &r) {
-    // Only one Buffer -> just return it
-    if (r.size() == 1) {
-        return py::cast(r[0]);
-    }
-
-    // Multiple -> return as Python tuple
-    return to_python_tuple(r);
-}
-
-}  // namespace
-
 void define_pipeline(py::module &m) {
 
     // Deliberately not supported, because they don't seem to make sense for Python:
@@ -60,80 +47,80 @@ void define_pipeline(py::module &m) {
             .def("print_loop_nest", &Pipeline::print_loop_nest)
 
             .def("compile_to", &Pipeline::compile_to,
-                 py::arg("outputs"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+                 py::arg("outputs"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
             .def("compile_to_bitcode", &Pipeline::compile_to_bitcode,
-                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
             .def("compile_to_llvm_assembly", &Pipeline::compile_to_llvm_assembly,
-                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
             .def("compile_to_object", &Pipeline::compile_to_object,
-                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
             .def("compile_to_header", &Pipeline::compile_to_header,
-                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
             .def("compile_to_assembly", &Pipeline::compile_to_assembly,
-                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
             .def("compile_to_c", &Pipeline::compile_to_c,
-                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
             .def("compile_to_file", &Pipeline::compile_to_file,
-                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
             .def("compile_to_static_library", &Pipeline::compile_to_static_library,
-                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
+                 py::arg("filename"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
             .def("compile_to_lowered_stmt", &Pipeline::compile_to_lowered_stmt,
-                 py::arg("filename"), py::arg("arguments"), py::arg("format") = StmtOutputFormat::Text, py::arg("target") = get_target_from_environment())
+                 py::arg("filename"), py::arg("arguments"), py::arg("format") = StmtOutputFormat::Text, py::arg("target") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
             .def("compile_to_multitarget_static_library", &Pipeline::compile_to_multitarget_static_library,
-                 py::arg("filename_prefix"), py::arg("arguments"), py::arg("targets") = get_target_from_environment())
+                 py::arg("filename_prefix"), py::arg("arguments"), py::arg("targets") = get_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
             .def("compile_to_module", &Pipeline::compile_to_module,
-                 py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::arg("linkage") = LinkageType::ExternalPlusMetadata)
+                 py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::arg("linkage") = LinkageType::ExternalPlusMetadata, py::call_guard<py::gil_scoped_release>())
 
-            .def("compile_jit", &Pipeline::compile_jit, py::arg("target") = get_jit_target_from_environment())
+            .def("compile_jit", &Pipeline::compile_jit, py::arg("target") = get_jit_target_from_environment(), py::call_guard<py::gil_scoped_release>())
 
             .def(
                 "realize", [](Pipeline &p, Buffer<> buffer, const Target &target) -> void {
                     p.realize(Realization(buffer), target);
                 },
-                py::arg("dst"), py::arg("target") = Target())
+                py::arg("dst"), py::arg("target") = Target(), py::call_guard<py::gil_scoped_release>())
 
             // This will actually allow a list-of-buffers as well as a tuple-of-buffers, but that's OK.
             .def(
                 "realize", [](Pipeline &p, std::vector<Buffer<>> buffers, const Target &t) -> void {
                     p.realize(Realization(buffers), t);
                 },
-                py::arg("dst"), py::arg("target") = Target())
+                py::arg("dst"), py::arg("target") = Target(), py::call_guard<py::gil_scoped_release>())
 
             .def(
                 "realize", [](Pipeline &p, std::vector<int32_t> sizes, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(sizes, target));
+                    return realize_without_gil([&]() { return p.realize(sizes, target); });
                 },
                 py::arg("sizes") = std::vector<int32_t>{}, py::arg("target") = Target())
 
             // TODO: deprecate in favor of std::vector<int32_t> size version?
             .def(
                 "realize", [](Pipeline &p, int x_size, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(x_size, target));
+                    return realize_without_gil([&]() { return p.realize(x_size, target); });
                 },
                 py::arg("x_size"), py::arg("target") = Target())
 
             // TODO: deprecate in favor of std::vector<int32_t> size version?
             .def(
                 "realize", [](Pipeline &p, int x_size, int y_size, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(x_size, y_size, target));
+                    return realize_without_gil([&]() { return p.realize(x_size, y_size, target); });
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("target") = Target())
 
             // TODO: deprecate in favor of std::vector<int32_t> size version?
             .def(
                 "realize", [](Pipeline &p, int x_size, int y_size, int z_size, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(x_size, y_size, z_size, target));
+                    return realize_without_gil([&]() { return p.realize(x_size, y_size, z_size, target); });
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("target") = Target())
 
             // TODO: deprecate in favor of std::vector<int32_t> size version?
             .def(
                 "realize", [](Pipeline &p, int x_size, int y_size, int z_size, int w_size, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(x_size, y_size, z_size, w_size, target));
+                    return realize_without_gil([&]() { return p.realize(x_size, y_size, z_size, w_size, target); });
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("w_size"), py::arg("target") = Target())
 
@@ -141,18 +128,18 @@ void define_pipeline(py::module &m) {
                 "infer_input_bounds", [](Pipeline &p, int x_size, int y_size, int z_size, int w_size) -> void {
                     p.infer_input_bounds(x_size, y_size, z_size, w_size);
                 },
-                py::arg("x_size") = 0, py::arg("y_size") = 0, py::arg("z_size") = 0, py::arg("w_size") = 0)
+                py::arg("x_size") = 0, py::arg("y_size") = 0, py::arg("z_size") = 0, py::arg("w_size") = 0, py::call_guard<py::gil_scoped_release>())
 
             .def(
                 "infer_input_bounds", [](Pipeline &p, Buffer<> buffer) -> void {
                     p.infer_input_bounds(Realization(buffer));
                 },
-                py::arg("dst"))
+                py::arg("dst"), py::call_guard<py::gil_scoped_release>())
             .def(
                 "infer_input_bounds", [](Pipeline &p, std::vector<Buffer<>> buffers) -> void {
                     p.infer_input_bounds(Realization(buffers));
                 },
-                py::arg("dst"))
+                py::arg("dst"), py::call_guard<py::gil_scoped_release>())
 
             .def("infer_arguments", [](Pipeline &p) -> std::vector<Argument> {
                 return p.infer_arguments();
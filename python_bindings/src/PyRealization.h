@@ -0,0 +1,39 @@
+#ifndef HALIDE_PYTHON_BINDINGS_PYREALIZATION_H
+#define HALIDE_PYTHON_BINDINGS_PYREALIZATION_H
+
+#include "PyHalide.h"
+#include "PyTuple.h"
+
+namespace Halide {
+namespace PythonBindings {
+
+// Helpers shared by the realize methods of Func and Pipeline.
+
+inline py::object realization_to_object(const Realization &r) {
+    // Only one Buffer -> just return it
+    if (r.size() == 1) {
+        return py::cast(r[0]);
+    }
+
+    // Multiple -> return as Python tuple
+    return to_python_tuple(r);
+}
+
+// Realize with the GIL released, so that other Python threads can run
+// while the pipeline is compiled and executed. Pipeline::compile_jit
+// serializes compilation, so threads may realize the same pipeline at
+// once.
+template<typename RealizeFn>
+py::object realize_without_gil(RealizeFn realize) {
+    std::unique_ptr<Realization> r;
+    {
+        py::gil_scoped_release release;
+        r.reset(new Realization(realize()));
+    }
+    return realization_to_object(*r);
+}
+
+}  // namespace PythonBindings
+}  // namespace Halide
+
+#endif  // HALIDE_PYTHON_BINDINGS_PYREALIZATION_H
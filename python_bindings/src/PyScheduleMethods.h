@@ -22,6 +22,12 @@ HALIDE_NEVER_INLINE void add_schedule_methods(PythonClass &class_instance) {
              py::arg("var"))
         .def("unroll", (T & (T::*)(const VarOrRVar &, const Expr &, TailStrategy)) & T::unroll,
              py::arg("var"), py::arg("factor"), py::arg("tail") = TailStrategy::Auto)
+        .def("unroll_and_jam", (T & (T::*)(const VarOrRVar &)) & T::unroll_and_jam,
+             py::arg("var"))
+        .def("unroll_and_jam", (T & (T::*)(const VarOrRVar &, const Expr &, TailStrategy)) & T::unroll_and_jam,
+             py::arg("var"), py::arg("factor"), py::arg("tail") = TailStrategy::Auto)
+        .def("software_pipeline", &T::software_pipeline,
+             py::arg("var"))
 
         .def("split", (T & (T::*)(const VarOrRVar &, const VarOrRVar &, const VarOrRVar &, const Expr &, TailStrategy)) & T::split,
              py::arg("old"), py::arg("outer"), py::arg("inner"), py::arg("factor"), py::arg("tail") = TailStrategy::Auto)
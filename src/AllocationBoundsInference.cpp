@@ -149,6 +149,9 @@ class StripDeclareBoxTouched : public IRMutator {
 Stmt allocation_bounds_inference(Stmt s,
                                  const map<string, Function> &env,
                                  const FuncValueBounds &fb) {
+    // The boxes touched by nested allocations are found by walking
+    // the same lets and loops over and over.
+    BoundsCache cache(fb);
     s = AllocationInference(env, fb).mutate(s);
     s = StripDeclareBoxTouched().mutate(s);
     return s;
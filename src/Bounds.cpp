@@ -1,4 +1,5 @@
 #include <iostream>
+#include <unordered_map>
 #include <utility>
 
 #include "Bounds.h"
@@ -1430,7 +1431,147 @@ private:
     }
 };
 
+struct BoundsCache::Contents {
+    const FuncValueBounds &func_bounds;
+
+    // A previous query about some Expr.
+    struct Query {
+        // The bounds the scope gave each free variable of the Expr,
+        // if any.
+        vector<pair<bool, Interval>> bindings;
+        bool const_bound, simplified;
+        // Whether the bounds of Func calls came from func_bounds, or
+        // were left unbounded.
+        bool used_func_bounds;
+        Interval result;
+    };
+
+    struct Entry {
+        // Keeps the node the entry is keyed on alive.
+        Expr expr;
+        vector<string> vars;
+        vector<Query> queries;
+    };
+
+    // Deeply-nested loops give the same Expr many different
+    // bindings. Past this many we stop remembering new ones.
+    static constexpr size_t max_queries_per_expr = 16;
+
+    std::unordered_map<const IRNode *, Entry> entries;
+
+    Contents(const FuncValueBounds &fb)
+        : func_bounds(fb) {
+    }
+
+    // Queries must either use the func_bounds the cache was made with,
+    // or none at all.
+    bool cacheable(const FuncValueBounds &fb) const {
+        return &fb == &func_bounds || fb.empty();
+    }
+
+    static bool same_bounds(const Interval &a, const Interval &b) {
+        return ((a.min.same_as(b.min) || equal(a.min, b.min)) &&
+                (a.max.same_as(b.max) || equal(a.max, b.max)));
+    }
+
+    bool find(const Expr &expr, const Scope<Interval> &scope,
+              bool const_bound, bool simplified, bool used_func_bounds,
+              Interval *result) const {
+        auto it = entries.find(expr.get());
+        if (it == entries.end()) {
+            return false;
+        }
+        const Entry &entry = it->second;
+        for (const Query &q : entry.queries) {
+            if (q.const_bound != const_bound ||
+                q.simplified != simplified ||
+                q.used_func_bounds != used_func_bounds) {
+                continue;
+            }
+            bool match = true;
+            for (size_t i = 0; match && i < entry.vars.size(); i++) {
+                const pair<bool, Interval> &b = q.bindings[i];
+                if (scope.contains(entry.vars[i])) {
+                    match = b.first && same_bounds(b.second, scope.get(entry.vars[i]));
+                } else {
+                    match = !b.first;
+                }
+            }
+            if (match) {
+                *result = q.result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void insert(const Expr &expr, const Scope<Interval> &scope,
+                bool const_bound, bool simplified, bool used_func_bounds,
+                const Interval &result) {
+        Entry &entry = entries[expr.get()];
+        if (!entry.expr.defined()) {
+            class FreeVars : public IRGraphVisitor {
+                using IRGraphVisitor::visit;
+
+                set<string> seen;
+
+                void visit(const Variable *op) override {
+                    if (seen.insert(op->name).second) {
+                        names.push_back(op->name);
+                    }
+                }
+
+            public:
+                vector<string> names;
+            } free_vars;
+            expr.accept(&free_vars);
+            entry.expr = expr;
+            entry.vars.swap(free_vars.names);
+        }
+        if (entry.queries.size() >= max_queries_per_expr) {
+            return;
+        }
+        Query q;
+        for (const string &v : entry.vars) {
+            if (scope.contains(v)) {
+                q.bindings.emplace_back(true, scope.get(v));
+            } else {
+                q.bindings.emplace_back(false, Interval());
+            }
+        }
+        q.const_bound = const_bound;
+        q.simplified = simplified;
+        q.used_func_bounds = used_func_bounds;
+        q.result = result;
+        entry.queries.push_back(std::move(q));
+    }
+};
+
+namespace {
+// The innermost live BoundsCache on this thread, if any.
+thread_local BoundsCache::Contents *active_bounds_cache = nullptr;
+}  // namespace
+
+BoundsCache::BoundsCache(const FuncValueBounds &func_bounds)
+    : contents(new Contents(func_bounds)), outer(active_bounds_cache) {
+    active_bounds_cache = contents.get();
+}
+
+BoundsCache::~BoundsCache() {
+    internal_assert(active_bounds_cache == contents.get())
+        << "BoundsCaches must be destroyed in the reverse order they were created\n";
+    active_bounds_cache = outer;
+}
+
 Interval bounds_of_expr_in_scope(const Expr &expr, const Scope<Interval> &scope, const FuncValueBounds &fb, bool const_bound) {
+    BoundsCache::Contents *cache = active_bounds_cache;
+    if (cache && !cache->cacheable(fb)) {
+        cache = nullptr;
+    }
+    Interval cached;
+    if (cache && cache->find(expr, scope, const_bound, false, !fb.empty(), &cached)) {
+        return cached;
+    }
     //debug(3) << "computing bounds_of_expr_in_scope " << expr << "\n";
     Bounds b(&scope, fb, const_bound);
     expr.accept(&b);
@@ -1448,9 +1589,37 @@ Interval bounds_of_expr_in_scope(const Expr &expr, const Scope<Interval> &scope,
             << " should have been a scalar of type " << expected
             << ": " << b.interval.max << "\n";
     }
+    if (cache) {
+        cache->insert(expr, scope, const_bound, false, !fb.empty(), b.interval);
+    }
     return b.interval;
 }
 
+namespace {
+
+// The bounds of an Expr, simplified. Uses the active BoundsCache to
+// skip the simplification too.
+Interval simplified_bounds_of_expr_in_scope(const Expr &expr, const Scope<Interval> &scope, const FuncValueBounds &fb) {
+    BoundsCache::Contents *cache = active_bounds_cache;
+    if (cache && !cache->cacheable(fb)) {
+        cache = nullptr;
+    }
+    Interval result;
+    if (cache && cache->find(expr, scope, false, true, !fb.empty(), &result)) {
+        return result;
+    }
+    result = bounds_of_expr_in_scope(expr, scope, fb);
+    bool fixed = result.min.same_as(result.max);
+    result.min = simplify(result.min);
+    result.max = fixed ? result.min : simplify(result.max);
+    if (cache) {
+        cache->insert(expr, scope, false, true, !fb.empty(), result);
+    }
+    return result;
+}
+
+}  // namespace
+
 Region region_union(const Region &a, const Region &b) {
     internal_assert(a.size() == b.size()) << "Mismatched dimensionality in region union\n";
     Region result;
@@ -2005,11 +2174,8 @@ private:
 
             op->value.accept(this);
 
-            f.value_bounds = bounds_of_expr_in_scope(op->value, scope, func_bounds);
-
+            f.value_bounds = simplified_bounds_of_expr_in_scope(op->value, scope, func_bounds);
             bool fixed = f.value_bounds.min.same_as(f.value_bounds.max);
-            f.value_bounds.min = simplify(f.value_bounds.min);
-            f.value_bounds.max = fixed ? f.value_bounds.min : simplify(f.value_bounds.max);
 
             if (is_small_enough_to_substitute(f.value_bounds.min) &&
                 (fixed || is_small_enough_to_substitute(f.value_bounds.max))) {
@@ -2197,10 +2363,7 @@ private:
                                                       expr_uses_var(box[i].max, l.min_name)))) {
                         internal_assert(let_stmts.contains(l.var));
                         const Expr &val = let_stmts.get(l.var);
-                        v_bound = bounds_of_expr_in_scope(val, scope, func_bounds);
-                        bool fixed = v_bound.min.same_as(v_bound.max);
-                        v_bound.min = simplify(v_bound.min);
-                        v_bound.max = fixed ? v_bound.min : simplify(v_bound.max);
+                        v_bound = simplified_bounds_of_expr_in_scope(val, scope, func_bounds);
 
                         internal_assert(scope.contains(l.var));
                         const Interval &old_bound = scope.get(l.var);
@@ -3120,6 +3283,43 @@ void bounds_test() {
         check_constant_bound(e4, u16(0), u16(65535));
     }
 
+    // Check that cached bounds are only reused when the free variables
+    // have the same bounds.
+    {
+        BoundsCache cache;
+        Expr e = x * 2 + y;
+        Scope<Interval> s1, s2;
+        s1.push("x", Interval(Expr(0), Expr(10)));
+        s1.push("y", Interval(Expr(1), Expr(2)));
+        s2.push("x", Interval(Expr(0), Expr(10)));
+        Interval a = bounds_of_expr_in_scope(e, s1);
+        Interval b = bounds_of_expr_in_scope(e, s1);
+        internal_assert(a.min.same_as(b.min) && a.max.same_as(b.max))
+            << "Asking for the same bounds twice did not reuse the cached bounds\n";
+        check(s1, e, 1, 22);
+        check(s2, e, y, y + 20);
+        s2.push("y", Interval(Expr(3), Expr(4)));
+        check(s2, e, 3, 24);
+        s2.pop("y");
+        check(s2, e, y, y + 20);
+    }
+
+    // Check that bounds computed without the cache's FuncValueBounds
+    // aren't reused when they are given, and vice versa.
+    {
+        FuncValueBounds fb;
+        fb[{"f", 0}] = Interval(Expr(0), Expr(10));
+        BoundsCache cache(fb);
+        Expr call = Call::make(Int(32), "f", {x}, Call::Halide);
+        Scope<Interval> s;
+        Interval without = bounds_of_expr_in_scope(call, s);
+        Interval with = bounds_of_expr_in_scope(call, s, fb);
+        Interval without_again = bounds_of_expr_in_scope(call, s);
+        internal_assert(!without.is_bounded() && !without_again.is_bounded() &&
+                        equal(with.min, 0) && equal(with.max, 10))
+            << "Cached bounds were reused with different FuncValueBounds\n";
+    }
+
     std::cout << "Bounds test passed" << std::endl;
 }
 
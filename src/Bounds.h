@@ -6,6 +6,8 @@
  * and the regions of a function read or written by a statement.
  */
 
+#include <memory>
+
 #include "Interval.h"
 #include "Scope.h"
 
@@ -35,6 +37,30 @@ Interval bounds_of_expr_in_scope(const Expr &expr,
                                  const FuncValueBounds &func_bounds = empty_func_value_bounds(),
                                  bool const_bound = false);
 
+/** While an object of this type is alive, bounds_of_expr_in_scope on
+ * the same thread remembers the bounds it computes, and reuses them
+ * when asked about the same Expr again with the same bounds given to
+ * its free variables by the scope. Everything built on it (e.g.
+ * boxes_required and boxes_provided) benefits. Queries that use the
+ * FuncValueBounds given here, and queries that use an empty one, are
+ * cached separately. Queries that use any other FuncValueBounds are
+ * not cached. The FuncValueBounds, and the bounds of any Parameters
+ * used, must not change while the cache is alive. */
+class BoundsCache {
+public:
+    struct Contents;
+
+    explicit BoundsCache(const FuncValueBounds &func_bounds = empty_func_value_bounds());
+    ~BoundsCache();
+
+    BoundsCache(const BoundsCache &) = delete;
+    BoundsCache &operator=(const BoundsCache &) = delete;
+
+private:
+    std::unique_ptr<Contents> contents;
+    Contents *outer;
+};
+
 /** Given a varying expression, try to find a constant that is either:
  * An upper bound (always greater than or equal to the expression), or
  * A lower bound (always less than or equal to the expression)
@@ -1263,6 +1263,9 @@ Stmt bounds_inference(Stmt s,
     // Add an outermost bounds inference marker
     s = For::make("<outermost>", 0, 1, ForType::Serial, DeviceAPI::None, s);
 
+    // Many stages ask for the bounds of the same expressions in the
+    // same loop nests.
+    BoundsCache cache(func_bounds);
     s = BoundsInference(funcs, fused_func_groups, fused_pairs_in_groups,
                         outputs, func_bounds, target)
             .mutate(s);
@@ -1,4 +1,6 @@
+#include <functional>
 #include <map>
+#include <set>
 
 #include "CSE.h"
 #include "IREquality.h"
@@ -143,14 +145,30 @@ public:
     }
 };
 
-/** Fill in the use counts in a global value numbering. */
+/** Rebuild all the Exprs in a Stmt using a single global value
+ * numbering, so that equal Exprs share nodes. */
+class HashConsExprs : public IRMutator {
+    GVN gvn;
+
+public:
+    using IRMutator::mutate;
+
+    Expr mutate(const Expr &e) override {
+        return gvn.mutate(e);
+    }
+};
+
+/** Fill in the use counts in a global value numbering. Exprs in the
+ * optional set of pinned nodes are treated like ones that shouldn't be
+ * extracted. */
 class ComputeUseCounts : public IRGraphVisitor {
     GVN &gvn;
     bool lift_all;
+    const std::set<const IRNode *> *pinned;
 
 public:
-    ComputeUseCounts(GVN &g, bool l)
-        : gvn(g), lift_all(l) {
+    ComputeUseCounts(GVN &g, bool l, const std::set<const IRNode *> *p = nullptr)
+        : gvn(g), lift_all(l), pinned(p) {
     }
 
     using IRGraphVisitor::include;
@@ -162,7 +180,8 @@ public:
         // the children.
         debug(4) << "Include: " << e
                  << "; should extract: " << should_extract(e, lift_all) << "\n";
-        if (!should_extract(e, lift_all)) {
+        if (!should_extract(e, lift_all) ||
+            (pinned && pinned->count(e.get()))) {
             e.accept(this);
             return;
         }
@@ -241,6 +260,304 @@ public:
     }
 };
 
+/** Apply a function to the Exprs a statement always evaluates when it
+ * runs, e.g. the index and value of a Store or the bounds of a
+ * loop. Exprs that are conditionally evaluated (loop bodies, branches
+ * of ifs, assert messages) are left alone, as are the contents of
+ * nested Blocks, which get their own turn. Also records the names
+ * bound by the LetStmts and Allocates it passes through. */
+class MutateUnconditionalExprs : public IRMutator {
+    std::function<Expr(const Expr &)> fn;
+
+    using IRMutator::visit;
+
+    Stmt visit(const LetStmt *op) override {
+        lets.insert(op->name);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const For *op) override {
+        Expr min = mutate(op->min);
+        Expr extent = mutate(op->extent);
+        if (min.same_as(op->min) && extent.same_as(op->extent)) {
+            return op;
+        }
+        return For::make(op->name, min, extent, op->for_type, op->device_api, op->body);
+    }
+
+    Stmt visit(const IfThenElse *op) override {
+        Expr condition = mutate(op->condition);
+        if (condition.same_as(op->condition)) {
+            return op;
+        }
+        return IfThenElse::make(condition, op->then_case, op->else_case);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        // Exprs in the body may refer to the allocation itself,
+        // e.g. by reinterpreting its name as a handle.
+        lets.insert(op->name);
+        Stmt body = mutate(op->body);
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return Allocate::make(op->name, op->type, op->memory_type, op->extents,
+                              op->condition, body, op->new_expr, op->free_function);
+    }
+
+    Stmt visit(const Block *op) override {
+        return op;
+    }
+
+    Stmt visit(const AssertStmt *op) override {
+        return op;
+    }
+
+    Stmt visit(const Prefetch *op) override {
+        return op;
+    }
+
+    Stmt visit(const Acquire *op) override {
+        return op;
+    }
+
+    Stmt visit(const Fork *op) override {
+        return op;
+    }
+
+    Stmt visit(const Atomic *op) override {
+        return op;
+    }
+
+    Stmt visit(const Realize *op) override {
+        return op;
+    }
+
+public:
+    std::set<string> lets;
+
+    using IRMutator::mutate;
+
+    Expr mutate(const Expr &e) override {
+        return e.defined() ? fn(e) : e;
+    }
+
+    MutateUnconditionalExprs(std::function<Expr(const Expr &)> f)
+        : fn(std::move(f)) {
+    }
+};
+
+/** Find the names bound by lets within some Exprs. */
+class FindLetNames : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Let *op) override {
+        names.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    using IRGraphVisitor::include;
+
+    std::set<string> &names;
+
+    FindLetNames(std::set<string> &n)
+        : names(n) {
+    }
+};
+
+/** Find what a sequence of statements does that makes it unsafe to
+ * load from memory before it runs. */
+class FindMemoryEffects : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Allocate *op) override {
+        written.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Free *op) override {
+        written.insert(op->name);
+    }
+
+    void visit(const Store *op) override {
+        written.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const AssertStmt *op) override {
+        // A load after an assert may only be safe because the assert
+        // passed.
+        unsafe_to_load = true;
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Call *op) override {
+        if (!op->is_pure()) {
+            unsafe_to_load = true;
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    // Buffers written, allocated or freed.
+    std::set<string> written;
+    // Whether the statements do anything that makes moving any load
+    // earlier unsafe.
+    bool unsafe_to_load = false;
+};
+
+/** Find the Exprs that must stay inside the statements of a sequence:
+ * those that use variables defined within the sequence, that load
+ * from memory the sequence may change, or that have side-effects. */
+class FindPinnedExprs : public IRGraphVisitor {
+    const vector<Stmt> &stmts;
+    const std::set<string> &bound;
+    std::map<const IRNode *, bool> memo;
+    bool found = false;
+
+    // Only worked out if the Exprs contain a load.
+    std::unique_ptr<FindMemoryEffects> effects;
+
+    using IRGraphVisitor::visit;
+
+    void visit(const Variable *op) override {
+        if (bound.count(op->name)) {
+            found = true;
+        }
+    }
+
+    void visit(const Load *op) override {
+        if (!effects) {
+            effects.reset(new FindMemoryEffects);
+            for (const Stmt &s : stmts) {
+                s.accept(effects.get());
+            }
+        }
+        if (effects->unsafe_to_load || effects->written.count(op->name)) {
+            found = true;
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Call *op) override {
+        if (!op->is_pure()) {
+            found = true;
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    std::set<const IRNode *> pinned;
+
+    using IRGraphVisitor::include;
+
+    void include(const Expr &e) override {
+        auto iter = memo.find(e.get());
+        if (iter != memo.end()) {
+            found = found || iter->second;
+            return;
+        }
+        bool outer = found;
+        found = false;
+        e.accept(this);
+        memo[e.get()] = found;
+        if (found) {
+            pinned.insert(e.get());
+        }
+        found = found || outer;
+    }
+
+    FindPinnedExprs(const vector<Stmt> &s, const std::set<string> &b)
+        : stmts(s), bound(b) {
+    }
+};
+
+/** Lift Exprs computed redundantly by the statements of a Block (or
+ * by several Exprs of one statement) into lets that enclose the whole
+ * Block. Only Exprs the statements always evaluate are considered,
+ * so no new work or loads are introduced on any path. */
+class CSEAcrossStatements : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const Block *op) override {
+        vector<Stmt> stmts;
+        bool changed = false;
+        Stmt rest = op;
+        while (const Block *b = rest.as<Block>()) {
+            stmts.push_back(mutate(b->first));
+            changed = changed || !stmts.back().same_as(b->first);
+            rest = b->rest;
+        }
+        stmts.push_back(mutate(rest));
+        changed = changed || !stmts.back().same_as(rest);
+
+        // Number all the Exprs in the statements together, so that
+        // equal Exprs in different statements share nodes.
+        GVN gvn;
+        vector<Expr> roots;
+        vector<Stmt> numbered;
+        MutateUnconditionalExprs number([&](const Expr &e) {
+            Expr n = gvn.mutate(e);
+            roots.push_back(n);
+            return n;
+        });
+        for (const Stmt &s : stmts) {
+            numbered.push_back(number.mutate(s));
+        }
+
+        // The same name may be bound in more than one statement
+        // (e.g. in the iterations of an unrolled loop), so Exprs that
+        // refer to those names mean different things in each.
+        std::set<string> bound;
+        bound.swap(number.lets);
+        FindLetNames find_lets(bound);
+        for (const Expr &e : roots) {
+            find_lets.include(e);
+        }
+
+        FindPinnedExprs pinned(stmts, bound);
+        for (const Expr &e : roots) {
+            pinned.include(e);
+        }
+        ComputeUseCounts count_uses(gvn, false, &pinned.pinned);
+        for (const Expr &e : roots) {
+            count_uses.include(e);
+        }
+
+        vector<pair<string, Expr>> lets;
+        map<Expr, Expr, ExprCompare> replacements;
+        for (const auto &e : gvn.entries) {
+            if (e->use_count > 1) {
+                string name = unique_name('t');
+                lets.emplace_back(name, e->expr);
+                replacements[e->expr] = Variable::make(e->expr.type(), name);
+            }
+        }
+
+        if (lets.empty()) {
+            return changed ? Block::make(stmts) : Stmt(op);
+        }
+
+        Replacer replacer(replacements);
+        MutateUnconditionalExprs replace([&](const Expr &e) {
+            return replacer.mutate(e);
+        });
+        for (Stmt &s : numbered) {
+            s = replace.mutate(s);
+        }
+
+        Stmt result = Block::make(numbered);
+        for (size_t i = lets.size(); i > 0; i--) {
+            Expr value = lets[i - 1].second;
+            replacer.erase(value);
+            value = replacer.mutate(value);
+            result = LetStmt::make(lets[i - 1].first, value, result);
+        }
+        return result;
+    }
+};
+
 }  // namespace
 
 Expr common_subexpression_elimination(const Expr &e_in, bool lift_all) {
@@ -303,6 +620,14 @@ Stmt common_subexpression_elimination(const Stmt &s, bool lift_all) {
     return CSEEveryExprInStmt(lift_all).mutate(s);
 }
 
+Stmt hash_cons(const Stmt &s) {
+    return HashConsExprs().mutate(s);
+}
+
+Stmt cse_across_statements(const Stmt &s) {
+    return CSEAcrossStatements().mutate(s);
+}
+
 // Testing code.
 
 namespace {
@@ -479,6 +804,58 @@ void cse_test() {
         check(e, correct);
     }
 
+    {
+        // Hash-consing a statement makes equal Exprs share nodes.
+        Expr a = x * y + 3, b = x * y + 3;
+        Stmt s = Block::make(Evaluate::make(a), Evaluate::make(b));
+        s = hash_cons(s);
+        const Block *block = s.as<Block>();
+        internal_assert(block);
+        const Evaluate *ea = block->first.as<Evaluate>();
+        const Evaluate *eb = block->rest.as<Evaluate>();
+        internal_assert(ea && eb && ea->value.same_as(eb->value) && equal(ea->value, a))
+            << "hash_cons failed to share equal Exprs in:\n"
+            << s << "\n";
+    }
+
+    {
+        // Index math shared by two stores is lifted out of the block.
+        Expr index = x * y + x;
+        Stmt s = Block::make(Store::make("buf", x, index, Parameter(), const_true(), ModulusRemainder()),
+                             Store::make("buf", y, index + 1, Parameter(), const_true(), ModulusRemainder()));
+        s = cse_across_statements(s);
+        const LetStmt *let = s.as<LetStmt>();
+        internal_assert(let && equal(let->value, index) && let->body.as<Block>())
+            << "cse_across_statements failed to lift shared index math from:\n"
+            << s << "\n";
+    }
+
+    {
+        // A load is not lifted above a store to the same buffer.
+        Expr load = Load::make(Int(32), "buf", x, Buffer<>(), Parameter(), const_true(), ModulusRemainder());
+        Stmt s = Block::make({Store::make("out", load, 0, Parameter(), const_true(), ModulusRemainder()),
+                              Store::make("buf", y, x, Parameter(), const_true(), ModulusRemainder()),
+                              Store::make("out", load, 1, Parameter(), const_true(), ModulusRemainder())});
+        Stmt result = cse_across_statements(s);
+        internal_assert(result.same_as(s))
+            << "cse_across_statements lifted a load above a store to its buffer:\n"
+            << result << "\n";
+    }
+
+    {
+        // An Expr that refers to an allocation is not lifted above it,
+        // even if an equal Expr refers to another allocation of the
+        // same name.
+        Expr handle = reinterpret(UInt(64), Variable::make(Handle(), "foo"));
+        Stmt use = Store::make("out", handle + x, 0, Parameter(), const_true(), ModulusRemainder());
+        Stmt alloc = Allocate::make("foo", Int(32), MemoryType::Stack, {16}, const_true(), use);
+        Stmt s = Block::make(alloc, alloc);
+        Stmt result = cse_across_statements(s);
+        internal_assert(result.same_as(s))
+            << "cse_across_statements lifted a use of an allocation above it:\n"
+            << result << "\n";
+    }
+
     debug(0) << "common_subexpression_elimination test passed\n";
 }
 
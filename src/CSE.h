@@ -29,6 +29,21 @@ Expr common_subexpression_elimination(const Expr &, bool lift_all = false);
  * statement. Does not introduce let statements. */
 Stmt common_subexpression_elimination(const Stmt &, bool lift_all = false);
 
+/** Make structurally equal Exprs throughout a statement share the
+ * same IR nodes (i.e. hash-cons them). Afterwards, two Exprs in the
+ * statement are equal if and only if they are the same node, and each
+ * distinct Expr takes up memory once. Does not introduce let
+ * statements. */
+Stmt hash_cons(const Stmt &);
+
+/** Lift common sub-expressions shared between the statements of each
+ * Block in a statement (e.g. the address arithmetic and loads of an
+ * unrolled loop body) into let statements that enclose the Block. Only
+ * expressions that every statement evaluates unconditionally are
+ * lifted, and loads are only lifted when nothing in the Block could
+ * change the memory they read. */
+Stmt cse_across_statements(const Stmt &);
+
 void cse_test();
 
 }  // namespace Internal
@@ -4,6 +4,7 @@
 #include "CodeGen_C.h"
 #include "CodeGen_Internal.h"
 #include "Deinterleave.h"
+#include "FindIntrinsics.h"
 #include "IROperator.h"
 #include "Lerp.h"
 #include "Param.h"
@@ -208,6 +209,71 @@ public:
     }
 };
 } // namespace
+
+// Parallel loops and async producers are emitted as calls to
+// HALIDE_CPP_PARALLEL_FOR(min, extent, body) and
+// HALIDE_CPP_FORK(first, rest), where the bodies are callables that
+// return zero on success or an error code. Waits on a semaphore call
+// HALIDE_CPP_YIELD() between attempts to acquire it. Define these
+// macros before this point to use your own task system. The default
+// versions use OpenMP if it is enabled, and run serially otherwise.
+template<typename Body>
+inline int halide_cpp_parallel_for(int min, int extent, const Body &body) {
+    int result = 0;
+#ifdef _OPENMP
+    #pragma omp parallel for
+    for (int i = min; i < min + extent; i++) {
+        int r = body(i);
+        if (r != 0) {
+            #pragma omp critical
+            result = r;
+        }
+    }
+#else
+    for (int i = min; i < min + extent && result == 0; i++) {
+        result = body(i);
+    }
+#endif
+    return result;
+}
+
+template<typename First, typename Rest>
+inline int halide_cpp_fork(const First &first, const Rest &rest) {
+    int first_result = 0, rest_result = 0;
+#ifdef _OPENMP
+    #pragma omp parallel
+    #pragma omp single
+    {
+        #pragma omp task shared(first_result)
+        first_result = first();
+        #pragma omp task shared(rest_result)
+        rest_result = rest();
+        #pragma omp taskwait
+    }
+#else
+    first_result = first();
+    rest_result = rest();
+#endif
+    return first_result != 0 ? first_result : rest_result;
+}
+
+inline void halide_cpp_yield() {
+#ifdef _OPENMP
+    #pragma omp taskyield
+#endif
+}
+
+#ifndef HALIDE_CPP_PARALLEL_FOR
+#define HALIDE_CPP_PARALLEL_FOR halide_cpp_parallel_for
+#endif
+
+#ifndef HALIDE_CPP_FORK
+#define HALIDE_CPP_FORK halide_cpp_fork
+#endif
+
+#ifndef HALIDE_CPP_YIELD
+#define HALIDE_CPP_YIELD halide_cpp_yield
+#endif
 )INLINE_CODE";
 }  // namespace
 
@@ -261,6 +327,10 @@ protected:
     // the size of its input vector. Make sure this type exists.
     void visit(const Shuffle *op) override {
         vector_types_used.insert(Int(32, op->vectors[0].type().lanes()));
+        if (op->vectors.size() > 1) {
+            // The inputs are concatenated before they are shuffled.
+            include_type(op->vectors[0].type().with_lanes(op->vectors[0].type().lanes() * op->vectors.size()));
+        }
         IRGraphVisitor::visit(op);
     }
 
@@ -526,7 +596,8 @@ public:
         }
     }
 
-    static Vec shuffle(const Vec &a, const int32_t indices[Lanes]) {
+    template<typename InputVec>
+    static Vec shuffle(const InputVec &a, const int32_t indices[Lanes]) {
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             if (indices[i] < 0) {
@@ -537,6 +608,13 @@ public:
         return r;
     }
 
+    template<int... Indices, typename InputVec>
+    static Vec shuffle(const InputVec &a) {
+        static_assert(sizeof...(Indices) == Lanes, "Lanes mismatch");
+        const int32_t indices[Lanes] = {Indices...};
+        return shuffle(a, indices);
+    }
+
     template<size_t InputLanes>
     static Vec concat(size_t count, const CppVector<ElementType, InputLanes> vecs[]) {
         Vec r(empty);
@@ -566,7 +644,7 @@ public:
     Vec operator!() const {
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
-            r.elements[i] = !r.elements[i];
+            r.elements[i] = !elements[i];
         }
         return r;
     }
@@ -905,6 +983,14 @@ private:
 
         const char *native_vector_decl = R"INLINE_CODE(
 #if __has_attribute(ext_vector_type) || __has_attribute(vector_size)
+// The signed integer type with the same width as a vector element. Native
+// vector comparisons produce lanes of this type that are all ones or all zeros.
+template <size_t Bytes> struct NativeVectorIntOfSize;
+template <> struct NativeVectorIntOfSize<1> { typedef int8_t type; };
+template <> struct NativeVectorIntOfSize<2> { typedef int16_t type; };
+template <> struct NativeVectorIntOfSize<4> { typedef int32_t type; };
+template <> struct NativeVectorIntOfSize<8> { typedef int64_t type; };
+
 template <typename ElementType_, size_t Lanes_>
 class NativeVector {
 public:
@@ -912,11 +998,14 @@ public:
     static const size_t Lanes = Lanes_;
     typedef NativeVector<ElementType, Lanes> Vec;
     typedef NativeVector<uint8_t, Lanes> Mask;
+    typedef typename NativeVectorIntOfSize<sizeof(ElementType)>::type IntElementType;
 
 #if __has_attribute(ext_vector_type)
     typedef ElementType_ NativeVectorType __attribute__((ext_vector_type(Lanes), aligned(sizeof(ElementType))));
+    typedef IntElementType NativeIntVectorType __attribute__((ext_vector_type(Lanes), aligned(sizeof(ElementType))));
 #elif __has_attribute(vector_size) || __GNUC__
     typedef ElementType_ NativeVectorType __attribute__((vector_size(Lanes * sizeof(ElementType)), aligned(sizeof(ElementType))));
+    typedef IntElementType NativeIntVectorType __attribute__((vector_size(Lanes * sizeof(ElementType)), aligned(sizeof(ElementType))));
 #endif
 
     NativeVector &operator=(const Vec &src) {
@@ -986,8 +1075,8 @@ public:
         }
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
-    static Vec shuffle(const Vec &a, const int32_t indices[Lanes]) {
+    template<typename InputVec>
+    static Vec shuffle(const InputVec &a, const int32_t indices[Lanes]) {
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             if (indices[i] < 0) {
@@ -998,12 +1087,27 @@ public:
         return r;
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
+#if __has_builtin(__builtin_shufflevector)
+    template<int... Indices, size_t InputLanes>
+    static Vec shuffle(const NativeVector<ElementType, InputLanes> &a) {
+        static_assert(sizeof...(Indices) == Lanes, "Lanes mismatch");
+        return Vec(from_native_vector, __builtin_shufflevector(a.native_vector, a.native_vector, Indices...));
+    }
+#endif
+
+    template<int... Indices, typename InputVec>
+    static Vec shuffle(const InputVec &a) {
+        static_assert(sizeof...(Indices) == Lanes, "Lanes mismatch");
+        const int32_t indices[Lanes] = {Indices...};
+        return shuffle(a, indices);
+    }
+
     template<size_t InputLanes>
     static Vec concat(size_t count, const NativeVector<ElementType, InputLanes> vecs[]) {
         Vec r(empty);
-        for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = vecs[i / InputLanes][i % InputLanes];
+        // As in load(), only copy the lanes in the logical type of each input.
+        for (size_t i = 0; i < count; i++) {
+            memcpy((ElementType *)&r.native_vector + i * InputLanes, &vecs[i].native_vector, sizeof(ElementType) * InputLanes);
         }
         return r;
     }
@@ -1150,67 +1254,32 @@ public:
         return r;
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator<(const Vec &a, const Vec &b) {
-        Mask r;
-        for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = a[i] < b[i] ? 0xff : 0x00;
-        }
-        return r;
+        return Mask::from_comparison(a.native_vector < b.native_vector);
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator<=(const Vec &a, const Vec &b) {
-        Mask r;
-        for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = a[i] <= b[i] ? 0xff : 0x00;
-        }
-        return r;
+        return Mask::from_comparison(a.native_vector <= b.native_vector);
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator>(const Vec &a, const Vec &b) {
-        Mask r;
-        for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = a[i] > b[i] ? 0xff : 0x00;
-        }
-        return r;
+        return Mask::from_comparison(a.native_vector > b.native_vector);
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator>=(const Vec &a, const Vec &b) {
-        Mask r;
-        for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = a[i] >= b[i] ? 0xff : 0x00;
-        }
-        return r;
+        return Mask::from_comparison(a.native_vector >= b.native_vector);
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator==(const Vec &a, const Vec &b) {
-        Mask r;
-        for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = a[i] == b[i] ? 0xff : 0x00;
-        }
-        return r;
+        return Mask::from_comparison(a.native_vector == b.native_vector);
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator!=(const Vec &a, const Vec &b) {
-        Mask r;
-        for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = a[i] != b[i] ? 0xff : 0x00;
-        }
-        return r;
+        return Mask::from_comparison(a.native_vector != b.native_vector);
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     static Vec select(const Mask &cond, const Vec &true_value, const Vec &false_value) {
-        Vec r(empty);
-        for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = cond[i] ? true_value[i] : false_value[i];
-        }
-        return r;
+        return blend(cond.template to_int_mask<NativeIntVectorType>(), true_value, false_value);
     }
 
     template <typename OtherVec>
@@ -1218,42 +1287,74 @@ public:
         #if __cplusplus >= 201103L
         static_assert(Vec::Lanes == OtherVec::Lanes, "Lanes mismatch");
         #endif
-#if 0 // __has_builtin(__builtin_convertvector)
-        // Disabled (for now) because __builtin_convertvector appears to have
-        // different float->int rounding behavior in at least some situations;
-        // for now we'll use the much-slower-but-correct explicit C++ code.
+#if __has_builtin(__builtin_convertvector)
+        // __builtin_convertvector appears to have different float->int
+        // rounding behavior in at least some situations, so for those we
+        // use the much-slower-but-correct explicit C++ code.
         // (https://github.com/halide/Halide/issues/2080)
-        return Vec(from_native_vector, __builtin_convertvector(src.native_vector, NativeVectorType));
-#else
+        const bool src_is_float = (typename OtherVec::ElementType)0.5f != 0;
+        const bool dst_is_float = (ElementType)0.5f != 0;
+        if (dst_is_float || !src_is_float) {
+            return Vec(from_native_vector, __builtin_convertvector(src.native_vector, NativeVectorType));
+        }
+#endif
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = static_cast<typename Vec::ElementType>(src.native_vector[i]);
         }
         return r;
-#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
+    // Same semantics as halide_cpp_max/halide_cpp_min, including for NaNs.
     static Vec max(const Vec &a, const Vec &b) {
+        return blend((NativeIntVectorType)(a.native_vector > b.native_vector), a, b);
+    }
+
+    static Vec min(const Vec &a, const Vec &b) {
+        return blend((NativeIntVectorType)(a.native_vector < b.native_vector), a, b);
+    }
+
+    // Make a Mask from the result of a native comparison.
+    template <typename ComparisonVectorType>
+    static Vec from_comparison(const ComparisonVectorType &cmp) {
+#if __has_builtin(__builtin_convertvector)
+        return Vec(from_native_vector, __builtin_convertvector(cmp, NativeVectorType));
+#else
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = ::halide_cpp_max(a[i], b[i]);
+            r.native_vector[i] = cmp[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
-    static Vec min(const Vec &a, const Vec &b) {
-        Vec r(empty);
+    // Expand a Mask into lanes of all ones or all zeros of the given
+    // integer vector type.
+    template <typename IntVectorType>
+    IntVectorType to_int_mask() const {
+        NativeIntVectorType nonzero = (NativeIntVectorType)(native_vector != 0);
+#if __has_builtin(__builtin_convertvector)
+        return __builtin_convertvector(nonzero, IntVectorType);
+#else
+        IntVectorType r;
         for (size_t i = 0; i < Lanes; i++) {
-            r.native_vector[i] = ::halide_cpp_min(a[i], b[i]);
+            r[i] = nonzero[i];
         }
         return r;
+#endif
     }
 
 private:
     template<typename, size_t> friend class NativeVector;
 
+    // Select lanes of a where the lanes of mask are all ones, and
+    // lanes of b where they are all zeros.
+    static Vec blend(const NativeIntVectorType &mask, const Vec &a, const Vec &b) {
+        NativeIntVectorType bits_a = (NativeIntVectorType)a.native_vector;
+        NativeIntVectorType bits_b = (NativeIntVectorType)b.native_vector;
+        return Vec(from_native_vector, (NativeVectorType)((bits_a & mask) | (bits_b & ~mask)));
+    }
+
     template <typename ElementType, typename OtherElementType, size_t Lanes>
     friend NativeVector<ElementType, Lanes> operator<<(
                     const NativeVector<ElementType, Lanes> &a,
@@ -2093,6 +2194,8 @@ void CodeGen_C::visit(const Call *op) {
         internal_assert(op->args.size() == 3);
         Expr e = lower_lerp(op->args[0], op->args[1], op->args[2]);
         rhs << print_expr(e);
+    } else if (is_fixed_point_intrinsic(op)) {
+        rhs << print_expr(lower_intrinsic(op));
     } else if (op->is_intrinsic(Call::absd)) {
         internal_assert(op->args.size() == 2);
         Expr a = op->args[0];
@@ -2306,6 +2409,14 @@ void CodeGen_C::visit(const Call *op) {
         internal_assert(op->args.size() == 1);
         string arg0 = print_expr(op->args[0]);
         rhs << "(" << arg0 << ")";
+    } else if (op->is_intrinsic(Call::nontemporal_store)) {
+        // The C backend just does regular stores, so it doesn't
+        // need any fences either.
+        internal_assert(op->args.size() == 1);
+        string arg0 = print_expr(op->args[0]);
+        rhs << "(" << arg0 << ")";
+    } else if (op->is_intrinsic(Call::store_fence)) {
+        rhs << "0";
     } else if (op->is_intrinsic()) {
         // TODO: other intrinsics
         internal_error << "Unhandled intrinsic in C backend: " << op->name << "\n";
@@ -2556,20 +2667,34 @@ void CodeGen_C::visit(const ProducerConsumer *op) {
 
 void CodeGen_C::visit(const Fork *op) {
     // TODO: This doesn't actually work with nested tasks
-    stream << get_indent() << "#pragma omp parallel\n";
-    open_scope();
-    stream << get_indent() << "#pragma omp single\n";
+    string first = unique_name('_');
+    string rest = unique_name('_');
     open_scope();
-    stream << get_indent() << "#pragma omp task\n";
-    open_scope();
-    print_stmt(op->first);
-    close_scope("");
-    stream << get_indent() << "#pragma omp task\n";
+    print_task_body("auto " + first + " = [&]() -> int", op->first);
+    print_task_body("auto " + rest + " = [&]() -> int", op->rest);
+    print_task_result("HALIDE_CPP_FORK(" + first + ", " + rest + ")");
+    close_scope("fork");
+}
+
+void CodeGen_C::print_task_body(const string &decl, const Stmt &body) {
+    // Like open_scope/close_scope, but the scope is a lambda that
+    // returns zero unless the body returns an error first.
+    cache.clear();
+    stream << get_indent() << decl << " {\n";
+    indent++;
+    print_stmt(body);
+    stream << get_indent() << "return 0;\n";
+    indent--;
+    stream << get_indent() << "};\n";
+    cache.clear();
+}
+
+void CodeGen_C::print_task_result(const string &call) {
+    string result = unique_name('_');
+    stream << get_indent() << "int " << result << " = " << call << ";\n";
+    stream << get_indent() << "if (" << result << " != 0) ";
     open_scope();
-    print_stmt(op->rest);
-    close_scope("");
-    stream << get_indent() << "#pragma omp taskwait\n";
-    close_scope("");
+    stream << get_indent() << "return " << result << ";\n";
     close_scope("");
 }
 
@@ -2579,7 +2704,7 @@ void CodeGen_C::visit(const Acquire *op) {
     open_scope();
     stream << get_indent() << "while (!halide_semaphore_try_acquire(" << id_sem << ", " << id_count << "))\n";
     open_scope();
-    stream << get_indent() << "#pragma omp taskyield\n";
+    stream << get_indent() << "HALIDE_CPP_YIELD();\n";
     close_scope("");
     op->body.accept(this);
     close_scope("");
@@ -2603,12 +2728,20 @@ void CodeGen_C::visit(const For *op) {
     string id_extent = print_expr(op->extent);
 
     if (op->for_type == ForType::Parallel) {
-        stream << get_indent() << "#pragma omp parallel for\n";
-    } else {
-        internal_assert(op->for_type == ForType::Serial)
-            << "Can only emit serial or parallel for loops to C\n";
+        // Wrap the body in a lambda, so that errors inside it can be
+        // returned from the loop, and so that the loop can be handed to
+        // whatever task system HALIDE_CPP_PARALLEL_FOR names.
+        string body = unique_name('_');
+        open_scope();
+        print_task_body("auto " + body + " = [&](int " + print_name(op->name) + ") -> int", op->body);
+        print_task_result("HALIDE_CPP_PARALLEL_FOR(" + id_min + ", " + id_extent + ", " + body + ")");
+        close_scope("parallel for " + print_name(op->name));
+        return;
     }
 
+    internal_assert(op->for_type == ForType::Serial)
+        << "Can only emit serial or parallel for loops to C\n";
+
     stream << get_indent() << "for (int "
            << print_name(op->name)
            << " = " << id_min
@@ -2828,16 +2961,19 @@ void CodeGen_C::visit(const Shuffle *op) {
         string storage_name = unique_name('_');
         stream << get_indent() << "const " << print_type(op->vectors[0].type()) << " " << storage_name << "[] = { " << with_commas(vecs) << " };\n";
 
-        rhs << print_type(op->type) << "::concat(" << op->vectors.size() << ", " << storage_name << ")";
-        src = print_assignment(op->type, rhs.str());
+        // The result of the concat may have more lanes than the
+        // result of the shuffle, e.g. when extracting a slice.
+        Type concat_type = op->vectors[0].type().with_lanes(max_index);
+        rhs << print_type(concat_type) << "::concat(" << op->vectors.size() << ", " << storage_name << ")";
+        src = print_assignment(concat_type, rhs.str());
     }
     ostringstream rhs;
     if (op->type.is_scalar()) {
         rhs << src << "[" << op->indices[0] << "]";
     } else {
-        string indices_name = unique_name('_');
-        stream << get_indent() << "const int32_t " << indices_name << "[" << op->indices.size() << "] = { " << with_commas(op->indices) << " };\n";
-        rhs << print_type(op->type) << "::shuffle(" << src << ", " << indices_name << ")";
+        // Pass the indices as template arguments, so that the
+        // shuffle can be done with a native vector shuffle.
+        rhs << print_type(op->type) << "::shuffle<" << with_commas(op->indices) << ">(" << src << ")";
     }
     print_assignment(op->type, rhs.str());
 }
@@ -83,6 +83,15 @@ protected:
     /** Emit a statement */
     void print_stmt(const Stmt &);
 
+    /** Emit a lambda with the given declaration that runs the body
+     * and returns zero, or the error code of any failure inside
+     * it. Used for the bodies of parallel loops and forks. */
+    void print_task_body(const std::string &decl, const Stmt &body);
+
+    /** Emit a call that returns an error code from a task system,
+     * returning that error from the enclosing function if nonzero. */
+    void print_task_result(const std::string &call);
+
     void create_assertion(const std::string &id_cond, const std::string &id_msg);
     void create_assertion(const std::string &id_cond, const Expr &message);
     void create_assertion(const Expr &cond, const Expr &message);
@@ -10,6 +10,7 @@
 #include "CodeGen_Internal.h"
 #include "Debug.h"
 #include "EliminateBoolVectors.h"
+#include "FindIntrinsics.h"
 #include "HexagonOptimize.h"
 #include "IREquality.h"
 #include "IRMatch.h"
@@ -425,7 +426,9 @@ void CodeGen_Hexagon::compile_func(const LoweredFunc &f,
                                    const string &extern_name) {
     CodeGen_Posix::begin_func(f.linkage, simple_name, extern_name, f.args);
 
-    Stmt body = f.body;
+    // The patterns in HexagonOptimize match plain integer
+    // arithmetic, so lower any fixed-point intrinsics first.
+    Stmt body = lower_intrinsics(f.body);
 
     debug(1) << "Unpredicating loads and stores...\n";
     // Replace dense vector predicated loads with sloppy scalarized
@@ -595,6 +595,12 @@ void get_target_options(const llvm::Module &module, llvm::TargetOptions &options
     options.RelaxELFRelocations = false;
 }
 
+bool use_fast_compile(const llvm::Module &module) {
+    bool fast_compile = false;
+    get_md_bool(module.getModuleFlag("halide_fast_compile"), fast_compile);
+    return fast_compile;
+}
+
 void clone_target_options(const llvm::Module &from, llvm::Module &to) {
     to.setTargetTriple(from.getTargetTriple());
 
@@ -649,7 +655,7 @@ std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &mod
 #else
                                                 llvm::CodeModel::Small,
 #endif
-                                                llvm::CodeGenOpt::Aggressive);
+                                                use_fast_compile(module) ? llvm::CodeGenOpt::None : llvm::CodeGenOpt::Aggressive);
     return std::unique_ptr<llvm::TargetMachine>(tm);
 }
 
@@ -106,6 +106,11 @@ void get_target_options(const llvm::Module &module, llvm::TargetOptions &options
 /** Given two llvm::Modules, clone target options from one to the other */
 void clone_target_options(const llvm::Module &from, llvm::Module &to);
 
+/** Given an llvm::Module, return true if it was generated for a
+ * Target with LLVMFastCompile set, and so should be code-generated at
+ * the lowest optimization level. */
+bool use_fast_compile(const llvm::Module &module);
+
 /** Given an llvm::Module, get or create an llvm:TargetMachine */
 std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &module);
 
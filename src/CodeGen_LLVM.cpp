@@ -15,10 +15,12 @@
 #include "CodeGen_RISCV.h"
 #include "CodeGen_WebAssembly.h"
 #include "CodeGen_X86.h"
+#include "CompileProfiler.h"
 #include "Debug.h"
 #include "Deinterleave.h"
 #include "EmulateFloat16Math.h"
 #include "ExprUsesVar.h"
+#include "FindIntrinsics.h"
 #include "IROperator.h"
 #include "IRPrinter.h"
 #include "IntegerDivisionTable.h"
@@ -291,6 +293,7 @@ CodeGen_LLVM::CodeGen_LLVM(Target t)
 
       inside_atomic_mutex_node(false),
       emit_atomic_stores(false),
+      emit_nontemporal_stores(false),
 
       destructor_block(nullptr),
       strict_float(t.has_feature(Target::StrictFloat)) {
@@ -598,6 +601,7 @@ void CodeGen_LLVM::init_codegen(const std::string &name, bool any_strict_float)
     module->addModuleFlag(llvm::Module::Warning, "halide_mattrs", MDString::get(*context, mattrs()));
     module->addModuleFlag(llvm::Module::Warning, "halide_use_pic", use_pic() ? 1 : 0);
     module->addModuleFlag(llvm::Module::Warning, "halide_per_instruction_fast_math_flags", any_strict_float);
+    module->addModuleFlag(llvm::Module::Warning, "halide_fast_compile", get_target().has_feature(Target::LLVMFastCompile) ? 1 : 0);
 
     // Ensure some types we need are defined
     halide_buffer_t_type = module->getTypeByName("struct.halide_buffer_t");
@@ -635,6 +639,8 @@ void CodeGen_LLVM::init_codegen(const std::string &name, bool any_strict_float)
 }
 
 std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
+    CompilePhase phase("llvm_codegen " + input.name(), "llvm");
+
     init_codegen(input.name(), input.any_strict_float());
 
     internal_assert(module && context && builder)
@@ -667,6 +673,7 @@ std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
 
     debug(2) << module.get() << "\n";
 
+    phase.record_count("llvm_instructions", module->getInstructionCount());
     return finish_codegen();
 }
 
@@ -798,9 +805,14 @@ void CodeGen_LLVM::compile_func(const LoweredFunc &f, const std::string &simple_
         }
     }
 
+    // Lower any fixed-point intrinsics we can't handle directly.
+    Stmt body = lower_intrinsics(f.body, [this](const Call *op) {
+        return supports_fixed_point_intrinsic(op);
+    });
+
     // Generate the function body.
     debug(1) << "Generating llvm bitcode for function " << f.name << "...\n";
-    f.body.accept(this);
+    body.accept(this);
 
     // Clean up and return.
     end_func(f.args);
@@ -1210,6 +1222,7 @@ llvm::Type *CodeGen_LLVM::llvm_type_of(const Type &t) const {
 }
 
 void CodeGen_LLVM::optimize_module() {
+    CompilePhase phase("llvm_optimize", "llvm");
     debug(3) << "Optimizing module\n";
 
     if (debug::debug_level() >= 3) {
@@ -1224,13 +1237,18 @@ void CodeGen_LLVM::optimize_module() {
     // See https://github.com/halide/Halide/issues/4113 for more info.
     // (Note that setting EnableLLVMLoopOpt always enables loop opt, regardless
     // of the setting of DisableLLVMLoopOpt.)
-    const bool do_loop_opt = !get_target().has_feature(Target::DisableLLVMLoopOpt) ||
-                             get_target().has_feature(Target::EnableLLVMLoopOpt);
+    // LLVMFastCompile overrides both of them: it asks for code as
+    // quickly as possible, so we run the cheapest pipeline that still
+    // cleans up after codegen, and skip all of LLVM's vectorizers.
+    const bool fast_compile = get_target().has_feature(Target::LLVMFastCompile);
+    const bool do_loop_opt = !fast_compile &&
+                             (!get_target().has_feature(Target::DisableLLVMLoopOpt) ||
+                              get_target().has_feature(Target::EnableLLVMLoopOpt));
 
     PipelineTuningOptions pto;
     pto.LoopInterleaving = do_loop_opt;
     pto.LoopVectorization = do_loop_opt;
-    pto.SLPVectorization = true;  // Note: SLP vectorization has no analogue in the Halide scheduling model
+    pto.SLPVectorization = !fast_compile;  // Note: SLP vectorization has no analogue in the Halide scheduling model
     pto.LoopUnrolling = do_loop_opt;
     // Clear ScEv info for all loops. Certain Halide applications spend a very
     // long time compiling in forgetLoop, and prefer to forget everything
@@ -1259,7 +1277,8 @@ void CodeGen_LLVM::optimize_module() {
     pb.crossRegisterProxies(lam, fam, cgam, mam);
     ModulePassManager mpm(debug_pass_manager);
 
-    PassBuilder::OptimizationLevel level = PassBuilder::OptimizationLevel::O3;
+    PassBuilder::OptimizationLevel level =
+        fast_compile ? PassBuilder::OptimizationLevel::O1 : PassBuilder::OptimizationLevel::O3;
 
     if (get_target().has_feature(Target::ASAN)) {
         pb.registerPipelineStartEPCallback([&](ModulePassManager &mpm) {
@@ -1315,6 +1334,7 @@ void CodeGen_LLVM::optimize_module() {
 
     mpm = pb.buildPerModuleDefaultPipeline(level, debug_pass_manager);
     mpm.run(*module, mam);
+    phase.record_count("llvm_instructions", module->getInstructionCount());
 
     if (llvm::verifyModule(*module, &errs()))
         report_fatal_error("Transformation resulted in an invalid module\n");
@@ -2533,6 +2553,8 @@ void CodeGen_LLVM::visit(const Call *op) {
 
         value = builder->CreateCall(debug_to_file, args);
 
+    } else if (is_fixed_point_intrinsic(op)) {
+        value = codegen(lower_intrinsics(lower_intrinsic(op)));
     } else if (op->is_intrinsic(Call::bitwise_and)) {
         internal_assert(op->args.size() == 2);
         Value *a = codegen(op->args[0]);
@@ -3136,6 +3158,17 @@ void CodeGen_LLVM::visit(const Call *op) {
                       " Halide.\n";
     } else if (op->is_intrinsic(Call::undef)) {
         value = UndefValue::get(llvm_type_of(op->type));
+    } else if (op->is_intrinsic(Call::store_fence)) {
+        if (target.arch == Target::X86) {
+            // A release fence is a no-op on x86, but non-temporal
+            // stores need an sfence to be ordered with later stores.
+            llvm::FunctionType *fn_type = llvm::FunctionType::get(void_t, false);
+            llvm::FunctionCallee fn = module->getOrInsertFunction("llvm.x86.sse.sfence", fn_type);
+            builder->CreateCall(fn);
+        } else {
+            builder->CreateFence(llvm::AtomicOrdering::Release);
+        }
+        value = ConstantInt::get(i32_t, 0);
     } else if (op->is_intrinsic(Call::size_of_halide_buffer_t)) {
         llvm::DataLayout d(module.get());
         value = ConstantInt::get(i32_t, (int)d.getTypeAllocSize(halide_buffer_t_type));
@@ -3950,6 +3983,15 @@ void CodeGen_LLVM::visit(const Fork *op) {
 }
 
 void CodeGen_LLVM::visit(const Store *op) {
+    // Non-temporal store.
+    if (const Call *c = op->value.as<Call>()) {
+        if (c->is_intrinsic(Call::nontemporal_store)) {
+            ScopedValue<bool> old_emit_nontemporal_stores(emit_nontemporal_stores, true);
+            codegen(Store::make(op->name, c->args[0], op->index, op->param, op->predicate, op->alignment));
+            return;
+        }
+    }
+
     Halide::Type value_type = op->value.type();
     Halide::Type storage_type = upgrade_type_for_storage(value_type);
     if (value_type != storage_type) {
@@ -4027,6 +4069,12 @@ void CodeGen_LLVM::visit(const Store *op) {
                 Value *vec_ptr = builder->CreatePointerCast(elt_ptr, slice_val->getType()->getPointerTo());
                 StoreInst *store = builder->CreateAlignedStore(slice_val, vec_ptr, make_alignment(alignment));
                 add_tbaa_metadata(store, op->name, slice_index);
+                if (emit_nontemporal_stores) {
+                    // LLVM only emits a streaming store (e.g. movntps
+                    // or stnp) if the store turns out to be aligned.
+                    llvm::Metadata *one = ConstantAsMetadata::get(ConstantInt::get(i32_t, 1));
+                    store->setMetadata(LLVMContext::MD_nontemporal, MDNode::get(*context, {one}));
+                }
             }
         } else if (ramp) {
             Type ptr_type = value_type.element_of();
@@ -4448,6 +4496,10 @@ bool CodeGen_LLVM::supports_atomic_add(const Type &t) const {
     return t.is_int_or_uint();
 }
 
+bool CodeGen_LLVM::supports_fixed_point_intrinsic(const Call *op) const {
+    return false;
+}
+
 bool CodeGen_LLVM::use_pic() const {
     return true;
 }
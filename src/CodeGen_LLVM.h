@@ -512,6 +512,13 @@ protected:
 
     virtual bool supports_atomic_add(const Type &t) const;
 
+    /** Can this backend generate code for the given fixed-point
+     * intrinsic (see FindIntrinsics.h) directly? Any intrinsic for
+     * which this returns false is lowered to plain integer arithmetic
+     * before codegen, in the canonical form the peephole patterns in
+     * each backend look for. */
+    virtual bool supports_fixed_point_intrinsic(const Call *op) const;
+
     /** Are we inside an atomic node that uses mutex locks?
         This is used for detecting deadlocks from nested atomics & illegal vectorization. */
     bool inside_atomic_mutex_node;
@@ -519,6 +526,9 @@ protected:
     /** Emit atomic store instructions? */
     bool emit_atomic_stores;
 
+    /** Mark dense vector stores as non-temporal? */
+    bool emit_nontemporal_stores;
+
 private:
     /** All the values in scope at the current code location during
      * codegen. Use sym_push and sym_pop to access. */
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <sstream>
 
 #include "CodeGen_X86.h"
 #include "ConciseCasts.h"
@@ -368,7 +369,31 @@ void CodeGen_X86::visit(const Cast *op) {
     CodeGen_Posix::visit(op);
 }
 
+bool CodeGen_X86::supports_fixed_point_intrinsic(const Call *op) const {
+    // LLVM's generic saturating arithmetic intrinsics map directly to
+    // padds/paddus/psubs/psubus for 8 and 16-bit vectors.
+    return ((op->is_intrinsic(Call::saturating_add) ||
+             op->is_intrinsic(Call::saturating_sub)) &&
+            op->type.is_vector() &&
+            (op->type.bits() == 8 || op->type.bits() == 16));
+}
+
 void CodeGen_X86::visit(const Call *op) {
+    if ((op->is_intrinsic(Call::saturating_add) ||
+         op->is_intrinsic(Call::saturating_sub)) &&
+        supports_fixed_point_intrinsic(op)) {
+        internal_assert(op->args.size() == 2);
+        int bits = op->type.bits();
+        int intrin_lanes = (target.has_feature(Target::AVX2) ? 256 : 128) / bits;
+        std::ostringstream intrin;
+        intrin << "llvm."
+               << (op->type.is_int() ? "s" : "u")
+               << (op->is_intrinsic(Call::saturating_add) ? "add" : "sub")
+               << ".sat.v" << intrin_lanes << "i" << bits;
+        value = call_intrin(op->type, intrin_lanes, intrin.str(), op->args);
+        return;
+    }
+
     if (op->is_intrinsic(Call::mulhi_shr) &&
         op->type.is_vector() && op->type.bits() == 16) {
         internal_assert(op->args.size() == 3);
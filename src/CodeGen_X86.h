@@ -32,6 +32,8 @@ protected:
 
     llvm::Type *llvm_type_of(const Type &t) const override;
 
+    bool supports_fixed_point_intrinsic(const Call *op) const override;
+
     using CodeGen_Posix::visit;
 
     /** Nodes for which we want to emit specific sse/avx intrinsics */
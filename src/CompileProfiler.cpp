@@ -0,0 +1,267 @@
+#include "CompileProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "IRVisitor.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+struct PhaseRecord {
+    string name, category;
+    double start_us, duration_us;
+    int thread;
+    int64_t peak_rss_delta;
+    vector<std::pair<string, int64_t>> counts;
+};
+
+class CompileProfile {
+public:
+    std::mutex mutex;
+    bool enabled;
+    string report_path;
+    std::chrono::steady_clock::time_point origin;
+    vector<PhaseRecord> phases;
+    // The first of the phases that write_compile_profile writes.
+    size_t first_phase = 0;
+    // How many CompileProfilingScopes that turned profiling on are
+    // alive. Profiling is on while there are any, and only the first
+    // one moves first_phase.
+    int scope_depth = 0;
+    std::map<std::thread::id, int> threads;
+
+    CompileProfile()
+        : origin(std::chrono::steady_clock::now()) {
+        report_path = get_env_variable("HL_COMPILE_PROFILE");
+        enabled = !report_path.empty();
+    }
+
+    ~CompileProfile() {
+        if (!report_path.empty()) {
+            std::ofstream f(report_path);
+            write(f, 0);
+        }
+    }
+
+    void write(std::ostream &out, size_t first);
+};
+
+CompileProfile &compile_profile() {
+    static CompileProfile p;
+    return p;
+}
+
+/** The peak resident set size of the process so far, in KB. */
+int64_t peak_rss() {
+#ifdef _WIN32
+    // Not tracked on Windows.
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    // ru_maxrss is in bytes on macOS, and in KB elsewhere.
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+class CountNodes : public IRGraphVisitor {
+    std::unordered_set<const IRNode *> seen;
+
+    using IRGraphVisitor::visit;
+
+    void include(const Expr &e) override {
+        if (seen.insert(e.get()).second) {
+            count++;
+            e.accept(this);
+        }
+    }
+
+    void include(const Stmt &s) override {
+        if (seen.insert(s.get()).second) {
+            count++;
+            s.accept(this);
+        }
+    }
+
+public:
+    int64_t count = 0;
+
+    void count_nodes(const Stmt &s) {
+        include(s);
+    }
+};
+
+void write_json_string(std::ostream &out, const string &str) {
+    out << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if ((unsigned char)c < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+void CompileProfile::write(std::ostream &out, size_t first) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Phases are recorded when they end, so inner phases come before
+    // the phases that contain them. Put them back in order of starting.
+    vector<const PhaseRecord *> sorted;
+    for (size_t i = first; i < phases.size(); i++) {
+        sorted.push_back(&phases[i]);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const PhaseRecord *a, const PhaseRecord *b) {
+                         return a->start_us < b->start_us;
+                     });
+
+    out << "{\"traceEvents\": [";
+    const char *separator = "\n";
+    for (const PhaseRecord *p : sorted) {
+        out << separator << "  {\"name\": ";
+        write_json_string(out, p->name);
+        out << ", \"cat\": ";
+        write_json_string(out, p->category);
+        out << ", \"ph\": \"X\", \"ts\": " << p->start_us
+            << ", \"dur\": " << p->duration_us
+            << ", \"pid\": 0, \"tid\": " << p->thread
+            << ", \"args\": {\"peak_rss_delta_kb\": " << p->peak_rss_delta;
+        for (const auto &c : p->counts) {
+            out << ", ";
+            write_json_string(out, c.first);
+            out << ": " << c.second;
+        }
+        out << "}}";
+        separator = ",\n";
+    }
+    out << "\n],\n\"displayTimeUnit\": \"ms\"}\n";
+}
+
+}  // namespace
+
+void set_compile_profiling(bool enabled) {
+    CompileProfile &p = compile_profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    p.enabled = enabled;
+}
+
+bool compile_profiling_enabled() {
+    CompileProfile &p = compile_profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    return p.enabled || p.scope_depth > 0;
+}
+
+void reset_compile_profile() {
+    CompileProfile &p = compile_profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    p.phases.clear();
+    p.first_phase = 0;
+}
+
+void write_compile_profile(std::ostream &out) {
+    CompileProfile &p = compile_profile();
+    size_t first;
+    {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        first = p.first_phase;
+    }
+    p.write(out, first);
+}
+
+CompileProfilingScope::CompileProfilingScope(bool enable)
+    : enable(enable) {
+    if (!enable) {
+        return;
+    }
+    CompileProfile &p = compile_profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    if (p.scope_depth++ == 0) {
+        p.first_phase = p.phases.size();
+    }
+}
+
+CompileProfilingScope::~CompileProfilingScope() {
+    if (!enable) {
+        return;
+    }
+    CompileProfile &p = compile_profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    if (--p.scope_depth == 0) {
+        p.first_phase = 0;
+    }
+}
+
+CompilePhase::CompilePhase(const string &name, const string &category)
+    : is_active(compile_profiling_enabled()), overhead(0) {
+    if (is_active) {
+        this->name = name;
+        this->category = category;
+        start_peak_rss = peak_rss();
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+CompilePhase::~CompilePhase() {
+    if (!is_active) {
+        return;
+    }
+    auto end = std::chrono::steady_clock::now();
+    int64_t end_peak_rss = peak_rss();
+
+    CompileProfile &p = compile_profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    PhaseRecord r;
+    r.name = std::move(name);
+    r.category = std::move(category);
+    r.start_us = std::chrono::duration<double, std::micro>(start - p.origin).count();
+    r.duration_us = std::chrono::duration<double, std::micro>(end - start - overhead).count();
+    auto inserted = p.threads.emplace(std::this_thread::get_id(), (int)p.threads.size());
+    r.thread = inserted.first->second;
+    r.peak_rss_delta = end_peak_rss - start_peak_rss;
+    r.counts = std::move(counts);
+    p.phases.push_back(std::move(r));
+}
+
+void CompilePhase::record_ir_size(const Stmt &s) {
+    if (is_active && s.defined()) {
+        auto t = std::chrono::steady_clock::now();
+        CountNodes c;
+        c.count_nodes(s);
+        record_count("ir_nodes", c.count);
+        overhead += std::chrono::steady_clock::now() - t;
+    }
+}
+
+void CompilePhase::record_count(const string &name, int64_t count) {
+    if (is_active) {
+        counts.emplace_back(name, count);
+    }
+}
+
+}  // namespace Internal
+}  // namespace Halide
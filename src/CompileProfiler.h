@@ -0,0 +1,94 @@
+#ifndef HALIDE_COMPILE_PROFILER_H
+#define HALIDE_COMPILE_PROFILER_H
+
+/** \file
+ * Defines a profiler for the compiler itself, which records how long
+ * each lowering pass and each LLVM phase takes, to help find out why a
+ * pipeline is slow to compile.
+ */
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Turn compile-time profiling on or off. It is off by default, unless
+ * the environment variable HL_COMPILE_PROFILE is set to the name of a
+ * file, in which case a report of everything compiled is written to
+ * that file when the process exits. */
+void set_compile_profiling(bool enabled);
+
+/** Check whether compile-time profiling is on. */
+bool compile_profiling_enabled();
+
+/** Discard everything recorded so far. */
+void reset_compile_profile();
+
+/** Write everything recorded so far as JSON in the Chrome trace event
+ * format, which can be loaded by chrome://tracing or Perfetto. Each
+ * phase of compilation is an event with its wall time, the amount the
+ * peak resident set size of the process grew by during it (in KB),
+ * and the size of the IR it produced. */
+void write_compile_profile(std::ostream &out);
+
+/** Turns compile-time profiling on for its lifetime, if asked to.
+ * Profiling stays on while any such scope is alive, on any thread,
+ * whatever set_compile_profiling says. While one is alive,
+ * write_compile_profile only writes the phases recorded since the
+ * first of them was constructed, so that the profile of one
+ * compilation doesn't include the ones before it. Everything is still
+ * kept for the report written at exit when HL_COMPILE_PROFILE is
+ * set. */
+class CompileProfilingScope {
+public:
+    explicit CompileProfilingScope(bool enable);
+    ~CompileProfilingScope();
+
+    CompileProfilingScope(const CompileProfilingScope &) = delete;
+    CompileProfilingScope &operator=(const CompileProfilingScope &) = delete;
+
+private:
+    bool enable;
+};
+
+/** Records a phase of compilation, from when it is constructed until
+ * it is destroyed, if compile-time profiling is on. Phases may nest. */
+class CompilePhase {
+public:
+    CompilePhase(const std::string &name, const std::string &category);
+    ~CompilePhase();
+
+    CompilePhase(const CompilePhase &) = delete;
+    CompilePhase &operator=(const CompilePhase &) = delete;
+
+    /** Record the number of distinct IR nodes in a Stmt produced by
+     * this phase. The time taken to count them is not included in the
+     * time for the phase. */
+    void record_ir_size(const Stmt &s);
+
+    /** Record some other measure of the work done in this phase. */
+    void record_count(const std::string &name, int64_t count);
+
+    bool active() const {
+        return is_active;
+    }
+
+private:
+    bool is_active;
+    std::string name, category;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration overhead;
+    int64_t start_peak_rss;
+    std::vector<std::pair<std::string, int64_t>> counts;
+};
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
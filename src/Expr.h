@@ -386,7 +386,11 @@ namespace Internal {
  * any order, and multiple iterations may occur
  * simultaneously. Vectorized and GPULane are parallel and
  * synchronous: they act as if all iterations occur at the same time
- * in lockstep. */
+ * in lockstep. UnrolledAndJammed is unrolled like Unrolled, but the
+ * copies of the loop directly inside it are then fused into one, so
+ * its iterations are interleaved with those of the inner loop.
+ * SoftwarePipelined is ordered like Serial, but the loads of each
+ * iteration are issued during the iteration before it. */
 enum class ForType {
     Serial,
     Parallel,
@@ -396,6 +400,8 @@ enum class ForType {
     GPUBlock,
     GPUThread,
     GPULane,
+    UnrolledAndJammed,
+    SoftwarePipelined,
 };
 
 /** Check if for_type executes for loop iterations in parallel and unordered. */
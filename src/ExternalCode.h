@@ -8,6 +8,11 @@
 
 namespace Halide {
 
+namespace Internal {
+class Deserializer;
+class Serializer;
+}  // namespace Internal
+
 class ExternalCode {
 private:
     enum Kind {
@@ -28,6 +33,9 @@ private:
         : kind(kind), llvm_target(llvm_target), device_code_kind(device_api), code(code), nametag(name) {
     }
 
+    friend class Internal::Serializer;
+    friend class Internal::Deserializer;
+
 public:
     /** Construct an ExternalCode container from llvm bitcode. The
      * result can be passed to Halide::Module::append to have the
@@ -0,0 +1,362 @@
+#include "FindIntrinsics.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::vector;
+
+namespace {
+
+// The type with the same signedness and twice the bits.
+Type widen(Type t) {
+    return t.with_bits(t.bits() * 2);
+}
+
+Expr widen(const Expr &e) {
+    return cast(widen(e.type()), e);
+}
+
+int64_t type_min_value(Type t) {
+    return t.is_int() ? -(int64_t(1) << (t.bits() - 1)) : 0;
+}
+
+int64_t type_max_value(Type t) {
+    return t.is_int() ? (int64_t(1) << (t.bits() - 1)) - 1 : (int64_t(1) << t.bits()) - 1;
+}
+
+// A version of lossless_cast that refuses to look through casts that
+// change the value, e.g. a uint16 cast of an int8.
+Expr narrow(Type t, const Expr &e) {
+    const Cast *c = e.as<Cast>();
+    if (c && !c->type.can_represent(c->value.type())) {
+        return Expr();
+    }
+    return lossless_cast(t, e);
+}
+
+// Narrow both a and b to t. Fails if either can't be narrowed, or if
+// both are constants (in which case there is nothing to gain).
+bool narrow_args(Type t, const Expr &a, const Expr &b, Expr *na, Expr *nb) {
+    *na = narrow(t, a);
+    *nb = narrow(t, b);
+    return na->defined() && nb->defined() && !(is_const(*na) && is_const(*nb));
+}
+
+// Match e against x / 2^shift or x >> shift, for a constant positive shift.
+bool is_shift_right(const Expr &e, Expr *x, int *shift) {
+    if (const Div *d = e.as<Div>()) {
+        if (is_const_power_of_two_integer(d->b, shift) && *shift > 0) {
+            *x = d->a;
+            return true;
+        }
+    } else if (const Call *c = e.as<Call>()) {
+        if (c->is_intrinsic(Call::shift_right)) {
+            const int64_t *i = as_const_int(c->args[1]);
+            const uint64_t *u = as_const_uint(c->args[1]);
+            int64_t s = i ? *i : u ? (int64_t)*u : 0;
+            if (s > 0 && s < c->type.bits()) {
+                *x = c->args[0];
+                *shift = (int)s;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Strip a clamp to the range of t from e, in any of the orders the
+// simplifier might produce. has_lo and has_hi record which of the
+// bounds were present.
+Expr strip_clamp(Expr e, Type t, bool *has_lo, bool *has_hi) {
+    const int64_t lo = type_min_value(t);
+    const int64_t hi = type_max_value(t);
+    *has_lo = *has_hi = false;
+    for (int i = 0; i < 2; i++) {
+        const Min *mn = e.as<Min>();
+        const Max *mx = e.as<Max>();
+        if (mn && !*has_hi && is_const(mn->b, hi)) {
+            e = mn->a;
+            *has_hi = true;
+        } else if (mn && !*has_hi && is_const(mn->a, hi)) {
+            e = mn->b;
+            *has_hi = true;
+        } else if (mx && !*has_lo && is_const(mx->b, lo)) {
+            e = mx->a;
+            *has_lo = true;
+        } else if (mx && !*has_lo && is_const(mx->a, lo)) {
+            e = mx->b;
+            *has_lo = true;
+        } else {
+            break;
+        }
+    }
+    return e;
+}
+
+void flatten_adds(const Expr &e, vector<Expr> &terms) {
+    if (const Add *add = e.as<Add>()) {
+        flatten_adds(add->a, terms);
+        flatten_adds(add->b, terms);
+    } else {
+        terms.push_back(e);
+    }
+}
+
+Expr make_intrinsic(Type t, Call::IntrinsicOp op, const vector<Expr> &args) {
+    return Call::make(t, op, args, Call::PureIntrinsic);
+}
+
+class FindIntrinsics : public IRMutator {
+    using IRMutator::visit;
+
+    static bool is_int_vector(Type t) {
+        return t.is_vector() && (t.is_int() || t.is_uint());
+    }
+
+    // Try to match cast(t, v), where v is computed in a type at least
+    // twice as wide as t, against one of the narrowing fixed-point
+    // idioms. All of the idioms below are exact in the wider type, so
+    // they may be computed however the target likes.
+    Expr find_narrowing_idiom(Type t, const Expr &v) {
+        const int bits = t.bits();
+        // A product of two narrow values can't overflow if the wide
+        // type is more than twice as wide, or twice as wide with the
+        // same signedness.
+        const bool mul_is_exact = v.type().bits() > 2 * bits || v.type().code() == t.code();
+
+        Expr a, b;
+        bool has_lo, has_hi;
+        Expr x = strip_clamp(v, t, &has_lo, &has_hi);
+        if (has_lo || has_hi) {
+            if (const Add *add = x.as<Add>()) {
+                // Unsigned sums never need the lower bound.
+                if (narrow_args(t, add->a, add->b, &a, &b) &&
+                    has_hi && (has_lo || t.is_uint())) {
+                    return make_intrinsic(t, Call::saturating_add, {mutate(a), mutate(b)});
+                }
+            } else if (const Sub *sub = x.as<Sub>()) {
+                // Unsigned differences never need the upper bound, but
+                // must be computed in a signed type.
+                if (v.type().is_int() &&
+                    narrow_args(t, sub->a, sub->b, &a, &b) &&
+                    has_lo && (has_hi || t.is_uint())) {
+                    return make_intrinsic(t, Call::saturating_sub, {mutate(a), mutate(b)});
+                }
+            }
+            if (x.type() == widen(t) &&
+                has_hi && (has_lo || t.is_uint())) {
+                return make_intrinsic(t, Call::saturating_narrow, {mutate(x)});
+            }
+            return Expr();
+        }
+
+        int shift = 0;
+        if (!is_shift_right(v, &x, &shift)) {
+            return Expr();
+        }
+
+        if (const Sub *sub = x.as<Sub>()) {
+            if (shift == 1 && narrow_args(t, sub->a, sub->b, &a, &b)) {
+                return make_intrinsic(t, Call::halving_sub, {mutate(a), mutate(b)});
+            }
+            return Expr();
+        }
+
+        // Pull out a rounding term, if there is one.
+        vector<Expr> terms;
+        flatten_adds(x, terms);
+        bool rounding = false;
+        for (size_t i = 0; i < terms.size(); i++) {
+            if (is_const(terms[i], int64_t(1) << (shift - 1))) {
+                terms.erase(terms.begin() + i);
+                rounding = true;
+                break;
+            }
+        }
+
+        Expr q = make_const(UInt(bits), shift);
+        if (terms.size() == 2 && shift == 1) {
+            if (narrow_args(t, terms[0], terms[1], &a, &b)) {
+                return make_intrinsic(t, rounding ? Call::rounding_halving_add : Call::halving_add,
+                                      {mutate(a), mutate(b)});
+            }
+        } else if (terms.size() == 1) {
+            const Mul *mul = terms[0].as<Mul>();
+            if (mul && mul_is_exact && narrow_args(t, mul->a, mul->b, &a, &b)) {
+                if (rounding && shift <= bits) {
+                    return make_intrinsic(t, Call::rounding_mul_shift_right, {mutate(a), mutate(b), q});
+                } else if (!rounding && shift < 2 * bits - (t.is_int() ? 1 : 0)) {
+                    return make_intrinsic(t, Call::mul_shift_right, {mutate(a), mutate(b), q});
+                }
+            } else if (rounding && shift <= bits) {
+                a = narrow(t, terms[0]);
+                if (a.defined() && !is_const(a)) {
+                    return make_intrinsic(t, Call::rounding_shift_right, {mutate(a), q});
+                }
+            }
+        }
+        return Expr();
+    }
+
+    Expr visit(const Cast *op) override {
+        Type t = op->type;
+        Type vt = op->value.type();
+        if (is_int_vector(t) && is_int_vector(vt) &&
+            t.bits() >= 8 && t.bits() <= 32 &&
+            vt.bits() >= 2 * t.bits()) {
+            Expr result = find_narrowing_idiom(t, op->value);
+            if (result.defined()) {
+                return result;
+            }
+        }
+        return IRMutator::visit(op);
+    }
+
+    Expr visit(const Add *op) override {
+        Type t = op->type;
+        Expr a, b;
+        if (is_int_vector(t) && t.bits() >= 16 &&
+            narrow_args(t.with_bits(t.bits() / 2), op->a, op->b, &a, &b)) {
+            return make_intrinsic(t, Call::widening_add, {mutate(a), mutate(b)});
+        }
+        return IRMutator::visit(op);
+    }
+
+    Expr visit(const Sub *op) override {
+        Type t = op->type;
+        Expr a, b;
+        // Widening subtracts always produce a signed result.
+        if (is_int_vector(t) && t.is_int() && t.bits() >= 16 &&
+            (narrow_args(t.with_bits(t.bits() / 2), op->a, op->b, &a, &b) ||
+             narrow_args(UInt(t.bits() / 2, t.lanes()), op->a, op->b, &a, &b))) {
+            return make_intrinsic(t, Call::widening_sub, {mutate(a), mutate(b)});
+        }
+        return IRMutator::visit(op);
+    }
+
+    Expr visit(const Mul *op) override {
+        Type t = op->type;
+        Expr a, b;
+        if (is_int_vector(t) && t.bits() >= 16 &&
+            narrow_args(t.with_bits(t.bits() / 2), op->a, op->b, &a, &b)) {
+            return make_intrinsic(t, Call::widening_mul, {mutate(a), mutate(b)});
+        }
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Device backends have their own ideas about fixed-point arithmetic.
+            return op;
+        }
+        return IRMutator::visit(op);
+    }
+};
+
+class LowerIntrinsics : public IRMutator {
+    using IRMutator::visit;
+
+    const std::function<bool(const Call *)> &keep;
+
+    Expr visit(const Call *op) override {
+        if (is_fixed_point_intrinsic(op) && !(keep && keep(op))) {
+            return mutate(lower_intrinsic(op));
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    LowerIntrinsics(const std::function<bool(const Call *)> &keep)
+        : keep(keep) {
+    }
+};
+
+}  // namespace
+
+bool is_fixed_point_intrinsic(const Call *op) {
+    return (op->is_intrinsic(Call::widening_add) ||
+            op->is_intrinsic(Call::widening_sub) ||
+            op->is_intrinsic(Call::widening_mul) ||
+            op->is_intrinsic(Call::saturating_add) ||
+            op->is_intrinsic(Call::saturating_sub) ||
+            op->is_intrinsic(Call::saturating_narrow) ||
+            op->is_intrinsic(Call::halving_add) ||
+            op->is_intrinsic(Call::halving_sub) ||
+            op->is_intrinsic(Call::rounding_halving_add) ||
+            op->is_intrinsic(Call::rounding_shift_right) ||
+            op->is_intrinsic(Call::mul_shift_right) ||
+            op->is_intrinsic(Call::rounding_mul_shift_right));
+}
+
+Expr lower_intrinsic(const Call *op) {
+    internal_assert(is_fixed_point_intrinsic(op));
+    const Type t = op->type;
+    const Expr &a = op->args[0];
+
+    if (op->is_intrinsic(Call::widening_add)) {
+        return cast(t, a) + cast(t, op->args[1]);
+    } else if (op->is_intrinsic(Call::widening_sub)) {
+        return cast(t, a) - cast(t, op->args[1]);
+    } else if (op->is_intrinsic(Call::widening_mul)) {
+        return cast(t, a) * cast(t, op->args[1]);
+    } else if (op->is_intrinsic(Call::saturating_narrow)) {
+        return saturating_cast(t, a);
+    }
+
+    const Expr &b = op->args[1];
+    const Type w = widen(t);
+    if (op->is_intrinsic(Call::saturating_add)) {
+        return saturating_cast(t, widen(a) + widen(b));
+    } else if (op->is_intrinsic(Call::saturating_sub)) {
+        const Type ws = Int(w.bits(), w.lanes());
+        Expr diff = cast(ws, a) - cast(ws, b);
+        if (t.is_uint()) {
+            return cast(t, max(diff, 0));
+        } else {
+            return saturating_cast(t, diff);
+        }
+    } else if (op->is_intrinsic(Call::halving_add)) {
+        return cast(t, (widen(a) + widen(b)) / 2);
+    } else if (op->is_intrinsic(Call::rounding_halving_add)) {
+        return cast(t, (widen(a) + widen(b) + 1) / 2);
+    } else if (op->is_intrinsic(Call::halving_sub)) {
+        return cast(t, (widen(a) - widen(b)) / 2);
+    } else if (op->is_intrinsic(Call::rounding_shift_right)) {
+        const uint64_t *q = as_const_uint(b);
+        internal_assert(q && *q > 0) << "Shift of rounding_shift_right must be a positive constant\n";
+        return cast(t, (widen(a) + make_const(w, int64_t(1) << (*q - 1))) / make_const(w, int64_t(1) << *q));
+    } else {
+        internal_assert(op->is_intrinsic(Call::mul_shift_right) ||
+                        op->is_intrinsic(Call::rounding_mul_shift_right));
+        const uint64_t *q = as_const_uint(op->args[2]);
+        internal_assert(q) << "Shift of " << op->name << " must be a constant\n";
+        Expr p = widen(a) * widen(b);
+        if (op->is_intrinsic(Call::rounding_mul_shift_right)) {
+            internal_assert(*q > 0);
+            p = p + make_const(w, int64_t(1) << (*q - 1));
+        }
+        return cast(t, p / make_const(w, int64_t(1) << *q));
+    }
+}
+
+Stmt find_intrinsics(const Stmt &s) {
+    return FindIntrinsics().mutate(s);
+}
+
+Expr find_intrinsics(const Expr &e) {
+    return FindIntrinsics().mutate(e);
+}
+
+Stmt lower_intrinsics(const Stmt &s, const std::function<bool(const Call *)> &keep) {
+    return LowerIntrinsics(keep).mutate(s);
+}
+
+Expr lower_intrinsics(const Expr &e, const std::function<bool(const Call *)> &keep) {
+    return LowerIntrinsics(keep).mutate(e);
+}
+
+}  // namespace Internal
+}  // namespace Halide
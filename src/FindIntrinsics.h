@@ -0,0 +1,46 @@
+#ifndef HALIDE_FIND_INTRINSICS_H
+#define HALIDE_FIND_INTRINSICS_H
+
+/** \file
+ * Defines lowering passes that convert fixed-point integer idioms to
+ * and from target-independent intrinsics (widening_add,
+ * saturating_add, rounding_halving_add, mul_shift_right, ...).
+ */
+
+#include <functional>
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Returns true if the call is one of the fixed-point intrinsics
+ * produced by find_intrinsics. */
+bool is_fixed_point_intrinsic(const Call *op);
+
+/** Replace integer vector arithmetic that is equivalent to one of the
+ * fixed-point intrinsics with a call to that intrinsic. This
+ * recognizes the idioms regardless of how the simplifier ordered
+ * them, whether they were written with shifts or divisions, and
+ * which wider type the arithmetic was promoted to. Loops that run on
+ * a device API other than the host are left untouched. */
+Stmt find_intrinsics(const Stmt &s);
+Expr find_intrinsics(const Expr &e);
+
+/** Lower a single fixed-point intrinsic to plain integer arithmetic,
+ * in the canonical form that the backend peephole patterns match
+ * (e.g. rounding_halving_add(a, b) becomes
+ * cast(t, (widen(a) + widen(b) + 1) / 2)). The args are not lowered. */
+Expr lower_intrinsic(const Call *op);
+
+/** Lower all fixed-point intrinsics in a Stmt or Expr. If keep is
+ * provided, intrinsics for which it returns true are left in place
+ * (with their args still lowered), so that a backend can generate
+ * code for them directly. */
+Stmt lower_intrinsics(const Stmt &s, const std::function<bool(const Call *)> &keep = nullptr);
+Expr lower_intrinsics(const Expr &e, const std::function<bool(const Call *)> &keep = nullptr);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <string.h>
 #include <utility>
 
@@ -1489,6 +1490,30 @@ Stage &Stage::unroll(const VarOrRVar &var, const Expr &factor, TailStrategy tail
     return *this;
 }
 
+Stage &Stage::unroll_and_jam(const VarOrRVar &var) {
+    set_dim_type(var, ForType::UnrolledAndJammed);
+    return *this;
+}
+
+Stage &Stage::unroll_and_jam(const VarOrRVar &var, const Expr &factor, TailStrategy tail) {
+    if (var.is_rvar) {
+        RVar tmp;
+        split(var.rvar, var.rvar, tmp, factor, tail);
+        unroll_and_jam(tmp);
+    } else {
+        Var tmp;
+        split(var.var, var.var, tmp, factor, tail);
+        unroll_and_jam(tmp);
+    }
+
+    return *this;
+}
+
+Stage &Stage::software_pipeline(const VarOrRVar &var) {
+    set_dim_type(var, ForType::SoftwarePipelined);
+    return *this;
+}
+
 Stage &Stage::tile(const VarOrRVar &x, const VarOrRVar &y,
                    const VarOrRVar &xo, const VarOrRVar &yo,
                    const VarOrRVar &xi, const VarOrRVar &yi,
@@ -1809,9 +1834,23 @@ std::string Stage::source_location() const {
     return definition.source_location();
 }
 
+namespace {
+
+// Guards the creation of Func::pipeline_, as several threads may
+// realize the same Func at once (e.g. Python threads, as the bindings
+// release the GIL while realizing).
+std::mutex func_pipeline_mutex;
+
+}  // namespace
+
 void Func::invalidate_cache() {
-    if (pipeline_.defined()) {
-        pipeline_.invalidate_cache();
+    Pipeline p;
+    {
+        std::lock_guard<std::mutex> lock(func_pipeline_mutex);
+        p = pipeline_;
+    }
+    if (p.defined()) {
+        p.invalidate_cache();
     }
 }
 
@@ -2034,6 +2073,12 @@ Func &Func::async() {
     return *this;
 }
 
+Func &Func::store_nontemporal() {
+    invalidate_cache();
+    func.schedule().nontemporal_stores() = true;
+    return *this;
+}
+
 Stage Func::specialize(const Expr &c) {
     invalidate_cache();
     return Stage(func, func.definition(), 0).specialize(c);
@@ -2086,6 +2131,24 @@ Func &Func::unroll(const VarOrRVar &var, const Expr &factor, TailStrategy tail)
     return *this;
 }
 
+Func &Func::unroll_and_jam(const VarOrRVar &var) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0).unroll_and_jam(var);
+    return *this;
+}
+
+Func &Func::unroll_and_jam(const VarOrRVar &var, const Expr &factor, TailStrategy tail) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0).unroll_and_jam(var, factor, tail);
+    return *this;
+}
+
+Func &Func::software_pipeline(const VarOrRVar &var) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0).software_pipeline(var);
+    return *this;
+}
+
 Func &Func::bound(const Var &var, Expr min, Expr extent) {
     user_assert(!min.defined() || Int(32).can_represent(min.type())) << "Can't represent min bound in int32\n";
     user_assert(extent.defined()) << "Extent bound of a Func can't be undefined\n";
@@ -2988,6 +3051,7 @@ Func::operator ExternFuncArgument() const {
 }
 
 Pipeline Func::pipeline() {
+    std::lock_guard<std::mutex> lock(func_pipeline_mutex);
     if (!pipeline_.defined()) {
         pipeline_ = Pipeline(*this);
     }
@@ -3152,4 +3216,12 @@ void Func::compile_jit(const Target &target) {
     pipeline().compile_jit(target);
 }
 
+void Func::compile_jit_tiered(const Target &target) {
+    pipeline().compile_jit_tiered(target);
+}
+
+Callable Func::compile_to_callable(const std::vector<Argument> &args, const Target &target) {
+    return pipeline().compile_to_callable(args, target);
+}
+
 }  // namespace Halide
@@ -349,6 +349,9 @@ public:
     Stage &parallel(const VarOrRVar &var, const Expr &task_size, TailStrategy tail = TailStrategy::Auto);
     Stage &vectorize(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
     Stage &unroll(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
+    Stage &unroll_and_jam(const VarOrRVar &var);
+    Stage &unroll_and_jam(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
+    Stage &software_pipeline(const VarOrRVar &var);
     Stage &tile(const VarOrRVar &x, const VarOrRVar &y,
                 const VarOrRVar &xo, const VarOrRVar &yo,
                 const VarOrRVar &xi, const VarOrRVar &yi, const Expr &xfactor, const Expr &yfactor,
@@ -963,6 +966,17 @@ public:
      */
     void compile_jit(const Target &target = get_jit_target_from_environment());
 
+    /** Eagerly jit compile the function, first quickly and then fully
+     * optimized on a background thread. See
+     * Pipeline::compile_jit_tiered. */
+    void compile_jit_tiered(const Target &target = get_jit_target_from_environment());
+
+    /** Compile the function for the given arguments and return an
+     * object that calls it directly, bypassing the per-call overhead
+     * of realize. See Pipeline::compile_to_callable. */
+    Callable compile_to_callable(const std::vector<Argument> &args,
+                                 const Target &target = get_jit_target_from_environment());
+
     /** Set the error handler function that be called in the case of
      * runtime errors during halide pipelines. If you are compiling
      * statically, you can also just define your own function with
@@ -1464,6 +1478,44 @@ public:
      * dimension of the split. 'factor' must be an integer. */
     Func &unroll(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
 
+    /** Mark a dimension to be completely unrolled, and jam the copies
+     * of the loop directly inside it together. Instead of running the
+     * inner loop once per value of this dimension, it runs once, and
+     * does all the unrolled iterations of this dimension in its
+     * body. This is the transformation that blocks a matrix multiply
+     * or convolution into registers: e.g. for an update over an RDom
+     * r that is the loop directly inside a dimension y, jamming y
+     * into r lets each value loaded at a given r be reused by several
+     * rows of the output, while the loop over x inside remains
+     * vectorized. Iterations of this dimension end up interleaved
+     * with those of the inner one, so jamming an RVar into another
+     * RVar is only allowed if the update is associative and
+     * commutative. If the loop directly inside can't be jammed
+     * (e.g. because its bounds depend on this dimension, or because
+     * something else is computed at this level), this is the same
+     * as unroll. */
+    Func &unroll_and_jam(const VarOrRVar &var);
+
+    /** Split a dimension by the given factor, then unroll and jam the
+     * inner dimension. After this call, var refers to the outer
+     * dimension of the split. 'factor' must be an integer. */
+    Func &unroll_and_jam(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
+
+    /** Mark a dimension to be software pipelined. The loop still runs
+     * in order, but the loads that each iteration does are issued
+     * during the iteration before it, so that their latency overlaps
+     * with useful work. The loop is split into a prologue that loads
+     * the values for the first iteration, a steady state that loads
+     * the values for the next iteration while computing the current
+     * one, and an epilogue that computes the last iteration. This
+     * helps gather-heavy loops whose loads miss in cache. Only loads
+     * from buffers that the loop doesn't write to are pipelined, and
+     * only once the loop body has been reduced to a sequence of
+     * stores, so this should be applied to the innermost loop that
+     * remains after vectorization and unrolling. Otherwise it is the
+     * same as a serial loop. */
+    Func &software_pipeline(const VarOrRVar &var);
+
     /** Statically declare that the range over which a function should
      * be evaluated is given by the second and third arguments. This
      * can let Halide perform some optimizations. E.g. if you know
@@ -2315,6 +2367,19 @@ public:
      * on MemoryType for more detail. */
     Func &store_in(MemoryType memory_type);
 
+    /** Write this Func with non-temporal (streaming) stores, which
+     * bypass the cache. This is useful for large outputs and
+     * compute_root intermediates that won't be read again soon, as it
+     * stops them from evicting more useful data from the last level
+     * cache. Only dense, unpredicated vector stores done on the CPU
+     * are affected, so the innermost dimension should be vectorized,
+     * and the stores are only streaming when they turn out to be
+     * aligned to the native vector width. A fence is issued at the
+     * end of the production of this Func, and at the end of each
+     * task of a parallel loop within it, so that the values written
+     * are visible to other threads before they are read. */
+    Func &store_nontemporal();
+
     /** Trace all loads from this Func by emitting calls to
      * halide_trace. If the Func is inlined, this has no
      * effect. */
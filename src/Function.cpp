@@ -749,6 +749,46 @@ void Function::define_extern(const std::string &function_name,
         Dim{Var::outermost().name(), ForType::Serial, DeviceAPI::None, Dim::Type::PureVar});
 }
 
+void Function::update_with_deserialization(const std::string &name,
+                                           const std::string &origin_name,
+                                           const std::vector<Type> &output_types,
+                                           const std::vector<std::string> &args,
+                                           const FuncSchedule &func_schedule,
+                                           const Definition &init_def,
+                                           const std::vector<Definition> &updates,
+                                           const std::string &debug_file,
+                                           const std::vector<Parameter> &output_buffers,
+                                           const std::vector<ExternFuncArgument> &extern_arguments,
+                                           const std::string &extern_function_name,
+                                           NameMangling extern_mangling,
+                                           DeviceAPI extern_function_device_api,
+                                           const Expr &extern_proxy_expr,
+                                           bool trace_loads,
+                                           bool trace_stores,
+                                           bool trace_realizations,
+                                           const std::vector<std::string> &trace_tags,
+                                           bool frozen) {
+    contents->name = name;
+    contents->origin_name = origin_name;
+    contents->output_types = output_types;
+    contents->args = args;
+    contents->func_schedule = func_schedule;
+    contents->init_def = init_def;
+    contents->updates = updates;
+    contents->debug_file = debug_file;
+    contents->output_buffers = output_buffers;
+    contents->extern_arguments = extern_arguments;
+    contents->extern_function_name = extern_function_name;
+    contents->extern_mangling = extern_mangling;
+    contents->extern_function_device_api = extern_function_device_api;
+    contents->extern_proxy_expr = extern_proxy_expr;
+    contents->trace_loads = trace_loads;
+    contents->trace_stores = trace_stores;
+    contents->trace_realizations = trace_realizations;
+    contents->trace_tags = trace_tags;
+    contents->frozen = frozen;
+}
+
 void Function::accept(IRVisitor *visitor) const {
     contents->accept(visitor);
 }
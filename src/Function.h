@@ -96,6 +96,30 @@ public:
      * definition's argument in the same index. */
     void define_update(const std::vector<Expr> &args, std::vector<Expr> values);
 
+    /** Replace all of the state of this Function at once. Used by the
+     * deserializer, which has to create every Function in a pipeline
+     * before it can fill any of them in, as they may refer to each
+     * other. */
+    void update_with_deserialization(const std::string &name,
+                                     const std::string &origin_name,
+                                     const std::vector<Type> &output_types,
+                                     const std::vector<std::string> &args,
+                                     const FuncSchedule &func_schedule,
+                                     const Definition &init_def,
+                                     const std::vector<Definition> &updates,
+                                     const std::string &debug_file,
+                                     const std::vector<Parameter> &output_buffers,
+                                     const std::vector<ExternFuncArgument> &extern_arguments,
+                                     const std::string &extern_function_name,
+                                     NameMangling extern_mangling,
+                                     DeviceAPI extern_function_device_api,
+                                     const Expr &extern_proxy_expr,
+                                     bool trace_loads,
+                                     bool trace_stores,
+                                     bool trace_realizations,
+                                     const std::vector<std::string> &trace_tags,
+                                     bool frozen);
+
     /** Accept a visitor to visit all of the definitions and arguments
      * of this function. */
     void accept(IRVisitor *visitor) const;
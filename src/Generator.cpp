@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "BoundaryConditions.h"
+#include "CompileProfiler.h"
 #include "Derivative.h"
 #include "Generator.h"
 #include "IRPrinter.h"
@@ -754,8 +755,11 @@ int generate_filter_main_inner(int argc, char **argv, std::ostream &cerr) {
         "\n"
         " -e  A comma separated list of files to emit. Accepted values are:\n"
         "     [assembly, bitcode, cpp, h, html, o, static_library,\n"
-        "      stmt, cpp_stub, schedule, registration, featurization, python_extension, pytorch_wrapper].\n"
+        "      stmt, cpp_stub, schedule, registration, featurization, python_extension, pytorch_wrapper,\n"
+        "      compile_profile].\n"
         "     If omitted, default value is [static_library, h, registration].\n"
+        "     compile_profile is a Chrome trace of the time taken by each lowering pass\n"
+        "     and LLVM phase while compiling the Generator.\n"
         "\n"
         " -p  A comma-separated list of shared libraries that will be loaded before the\n"
         "     generator is run. Useful for custom auto-schedulers. The generator must\n"
@@ -961,6 +965,7 @@ int generate_filter_main_inner(int argc, char **argv, std::ostream &cerr) {
 
         // Don't bother with this if we're just emitting a cpp_stub.
         if (!stub_only) {
+            CompileProfilingScope profiling(outputs.count(Output::compile_profile) != 0);
             auto output_files = compute_output_files(targets[0], base_path, outputs);
             auto module_producer = [&generator_name, &generator_args, build_gradient_module](const std::string &name, const Target &target) -> Module {
                 auto sub_generator_args = generator_args;
@@ -2246,6 +2246,7 @@ public:
     HALIDE_FORWARD_METHOD(Func, specialize_fail)
     HALIDE_FORWARD_METHOD(Func, split)
     HALIDE_FORWARD_METHOD(Func, store_at)
+    HALIDE_FORWARD_METHOD(Func, store_nontemporal)
     HALIDE_FORWARD_METHOD(Func, store_root)
     HALIDE_FORWARD_METHOD(Func, tile)
     HALIDE_FORWARD_METHOD(Func, trace_stores)
@@ -602,6 +602,8 @@ const char *const intrinsic_op_names[] = {
     "glsl_texture_store",
     "glsl_varying",
     "gpu_thread_barrier",
+    "halving_add",
+    "halving_sub",
     "if_then_else",
     "if_then_else_mask",
     "image_load",
@@ -612,7 +614,9 @@ const char *const intrinsic_op_names[] = {
     "make_struct",
     "memoize_expr",
     "mod_round_to_zero",
+    "mul_shift_right",
     "mulhi_shr",
+    "nontemporal_store",
     "popcount",
     "prefetch",
     "promise_clamped",
@@ -623,6 +627,12 @@ const char *const intrinsic_op_names[] = {
     "require_mask",
     "return_second",
     "rewrite_buffer",
+    "rounding_halving_add",
+    "rounding_mul_shift_right",
+    "rounding_shift_right",
+    "saturating_add",
+    "saturating_narrow",
+    "saturating_sub",
     "scatter",
     "scatter_acc",
     "scatter_release",
@@ -632,10 +642,14 @@ const char *const intrinsic_op_names[] = {
     "signed_integer_overflow",
     "size_of_halide_buffer_t",
     "sorted_avg",
+    "store_fence",
     "strict_float",
     "stringify",
     "undef",
     "unsafe_promise_clamped",
+    "widening_add",
+    "widening_mul",
+    "widening_sub",
 };
 
 static_assert(sizeof(intrinsic_op_names) / sizeof(intrinsic_op_names[0]) == Call::IntrinsicOpCount,
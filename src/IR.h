@@ -513,6 +513,8 @@ struct Call : public ExprNode<Call> {
         glsl_texture_store,
         glsl_varying,
         gpu_thread_barrier,
+        halving_add,
+        halving_sub,
         if_then_else,
         if_then_else_mask,
         image_load,
@@ -523,7 +525,9 @@ struct Call : public ExprNode<Call> {
         make_struct,
         memoize_expr,
         mod_round_to_zero,
+        mul_shift_right,  // Compute (widen(arg[0]) * widen(arg[1])) >> arg[2], narrowed back to the type of the args.
         mulhi_shr,  // Compute high_half(arg[0] * arg[1]) >> arg[3]. Note that this is a shift in addition to taking the upper half of multiply result. arg[3] must be an unsigned integer immediate.
+        nontemporal_store,  // Wraps the value of a Store to mark it as one to do with a non-temporal store.
         popcount,
         prefetch,
         promise_clamped,
@@ -534,6 +538,12 @@ struct Call : public ExprNode<Call> {
         require_mask,
         return_second,
         rewrite_buffer,
+        rounding_halving_add,
+        rounding_mul_shift_right,  // As mul_shift_right, but rounding to nearest.
+        rounding_shift_right,      // Compute (arg[0] + 2^(arg[1] - 1)) >> arg[1] without overflow.
+        saturating_add,
+        saturating_narrow,
+        saturating_sub,
         scatter,
         scatter_acc,
         scatter_release,
@@ -543,10 +553,14 @@ struct Call : public ExprNode<Call> {
         signed_integer_overflow,
         size_of_halide_buffer_t,
         sorted_avg,  // Compute (arg[0] + arg[1]) / 2, assuming arg[0] < arg[1].
+        store_fence,  // Make preceding non-temporal stores visible to other threads.
         strict_float,
         stringify,
         undef,
         unsafe_promise_clamped,
+        widening_add,
+        widening_mul,
+        widening_sub,
         IntrinsicOpCount  // Sentinel: keep last.
     };
 
@@ -693,7 +707,11 @@ struct Variable : public ExprNode<Variable> {
  * 16). An 'Unrolled' for loop compiles to a completely unrolled
  * version of the loop. Each iteration becomes its own
  * statement. Again in this case, 'extent' should be a small
- * integer constant. */
+ * integer constant. An 'UnrolledAndJammed' for loop is unrolled,
+ * and the copies of the loop directly inside it are jammed together
+ * into a single loop. A 'SoftwarePipelined' for loop runs in order
+ * like a 'Serial' one, but loads for the next iteration are issued
+ * before the current iteration does its work. */
 struct For : public StmtNode<For> {
     std::string name;
     Expr min, extent;
@@ -1,3 +1,5 @@
+#include <unordered_map>
+
 #include "IREquality.h"
 #include "IROperator.h"
 #include "IRVisitor.h"
@@ -589,6 +591,294 @@ void IRComparer::visit(const Atomic *op) {
     compare_stmt(s->body, op->body);
 }
 
+
+/** The class that computes structural hashes. It must distinguish at
+ * most the same things that IRComparer distinguishes. */
+class IRHasher : public IRVisitor {
+public:
+    uint64_t hash_expr(const Expr &e);
+    uint64_t hash_stmt(const Stmt &s);
+
+private:
+    // The hash of the node currently being visited.
+    uint64_t h = 0;
+
+    // Hashes of nodes already visited, so that shared subtrees are
+    // only traversed once.
+    std::unordered_map<const IRNode *, uint64_t> memo;
+
+    uint64_t hash_node(const IRNode *node, const Type *t);
+
+    void mix(uint64_t v) {
+        h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+
+    void mix_name(const std::string &name) {
+        mix(std::hash<std::string>()(name));
+    }
+
+    void mix_type(Type t) {
+        mix(t.code());
+        mix(t.bits());
+        mix(t.lanes());
+        if (t.handle_type) {
+            mix_name(t.handle_type->inner_name.name);
+        }
+    }
+
+    void mix_expr(const Expr &e) {
+        mix(hash_expr(e));
+    }
+
+    void mix_stmt(const Stmt &s) {
+        mix(hash_stmt(s));
+    }
+
+    void mix_expr_vector(const std::vector<Expr> &v) {
+        mix(v.size());
+        for (const Expr &e : v) {
+            mix_expr(e);
+        }
+    }
+
+    template<typename T>
+    void visit_binary_operator(const T *op) {
+        mix_expr(op->a);
+        mix_expr(op->b);
+    }
+
+    void visit(const IntImm *op) override {
+        mix((uint64_t)op->value);
+    }
+    void visit(const UIntImm *op) override {
+        mix(op->value);
+    }
+    void visit(const FloatImm *op) override {
+        mix(std::hash<double>()(op->value));
+    }
+    void visit(const StringImm *op) override {
+        mix_name(op->value);
+    }
+    void visit(const Cast *op) override {
+        mix_expr(op->value);
+    }
+    void visit(const Variable *op) override {
+        mix_name(op->name);
+    }
+    void visit(const Add *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const Sub *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const Mul *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const Div *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const Mod *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const Min *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const Max *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const EQ *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const NE *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const LT *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const LE *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const GT *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const GE *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const And *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const Or *op) override {
+        visit_binary_operator(op);
+    }
+    void visit(const Not *op) override {
+        mix_expr(op->a);
+    }
+    void visit(const Select *op) override {
+        mix_expr(op->condition);
+        mix_expr(op->true_value);
+        mix_expr(op->false_value);
+    }
+    void visit(const Load *op) override {
+        mix_name(op->name);
+        mix_expr(op->predicate);
+        mix_expr(op->index);
+        mix((uint64_t)op->alignment.modulus);
+        mix((uint64_t)op->alignment.remainder);
+    }
+    void visit(const Ramp *op) override {
+        mix_expr(op->base);
+        mix_expr(op->stride);
+    }
+    void visit(const Broadcast *op) override {
+        mix_expr(op->value);
+    }
+    void visit(const Call *op) override {
+        mix_name(op->name);
+        mix(op->call_type);
+        mix(op->value_index);
+        mix_expr_vector(op->args);
+    }
+    void visit(const Let *op) override {
+        mix_name(op->name);
+        mix_expr(op->value);
+        mix_expr(op->body);
+    }
+    void visit(const Shuffle *op) override {
+        mix_expr_vector(op->vectors);
+        mix(op->indices.size());
+        for (int i : op->indices) {
+            mix(i);
+        }
+    }
+    void visit(const LetStmt *op) override {
+        mix_name(op->name);
+        mix_expr(op->value);
+        mix_stmt(op->body);
+    }
+    void visit(const AssertStmt *op) override {
+        mix_expr(op->condition);
+        mix_expr(op->message);
+    }
+    void visit(const ProducerConsumer *op) override {
+        mix_name(op->name);
+        mix(op->is_producer);
+        mix_stmt(op->body);
+    }
+    void visit(const For *op) override {
+        mix_name(op->name);
+        mix((uint64_t)op->for_type);
+        mix_expr(op->min);
+        mix_expr(op->extent);
+        mix_stmt(op->body);
+    }
+    void visit(const Acquire *op) override {
+        mix_expr(op->semaphore);
+        mix_expr(op->count);
+        mix_stmt(op->body);
+    }
+    void visit(const Store *op) override {
+        mix_name(op->name);
+        mix_expr(op->predicate);
+        mix_expr(op->value);
+        mix_expr(op->index);
+        mix((uint64_t)op->alignment.modulus);
+        mix((uint64_t)op->alignment.remainder);
+    }
+    void visit(const Provide *op) override {
+        mix_name(op->name);
+        mix_expr_vector(op->args);
+        mix_expr_vector(op->values);
+    }
+    void visit(const Allocate *op) override {
+        mix_name(op->name);
+        mix_expr_vector(op->extents);
+        mix_stmt(op->body);
+        mix_expr(op->condition);
+        mix_expr(op->new_expr);
+        mix_name(op->free_function);
+    }
+    void visit(const Free *op) override {
+        mix_name(op->name);
+    }
+    void visit(const Realize *op) override {
+        mix_name(op->name);
+        for (Type t : op->types) {
+            mix_type(t);
+        }
+        for (const Range &r : op->bounds) {
+            mix_expr(r.min);
+            mix_expr(r.extent);
+        }
+        mix_stmt(op->body);
+        mix_expr(op->condition);
+    }
+    void visit(const Prefetch *op) override {
+        mix_name(op->name);
+        for (Type t : op->types) {
+            mix_type(t);
+        }
+        for (const Range &r : op->bounds) {
+            mix_expr(r.min);
+            mix_expr(r.extent);
+        }
+        mix_expr(op->condition);
+        mix_stmt(op->body);
+    }
+    void visit(const Block *op) override {
+        mix_stmt(op->first);
+        mix_stmt(op->rest);
+    }
+    void visit(const Fork *op) override {
+        mix_stmt(op->first);
+        mix_stmt(op->rest);
+    }
+    void visit(const IfThenElse *op) override {
+        mix_expr(op->condition);
+        mix_stmt(op->then_case);
+        mix_stmt(op->else_case);
+    }
+    void visit(const Evaluate *op) override {
+        mix_expr(op->value);
+    }
+    void visit(const Atomic *op) override {
+        mix_name(op->producer_name);
+        mix_name(op->mutex_name);
+        mix_stmt(op->body);
+    }
+};
+
+uint64_t IRHasher::hash_node(const IRNode *node, const Type *t) {
+    auto it = memo.find(node);
+    if (it != memo.end()) {
+        return it->second;
+    }
+    uint64_t old_h = h;
+    h = (uint64_t)node->node_type;
+    if (t) {
+        mix_type(*t);
+    }
+    node->accept(this);
+    uint64_t result = h;
+    h = old_h;
+    memo[node] = result;
+    return result;
+}
+
+uint64_t IRHasher::hash_expr(const Expr &e) {
+    if (!e.defined()) {
+        return 0;
+    }
+    Type t = e.type();
+    return hash_node(e.get(), &t);
+}
+
+uint64_t IRHasher::hash_stmt(const Stmt &s) {
+    if (!s.defined()) {
+        return 0;
+    }
+    return hash_node(s.get(), nullptr);
+}
+
 }  // namespace
 
 // Now the methods exposed in the header.
@@ -610,6 +900,14 @@ bool graph_equal(const Stmt &a, const Stmt &b) {
     return IRComparer(&cache).compare_stmt(a, b) == IRComparer::Equal;
 }
 
+uint64_t structural_hash(const Expr &e) {
+    return IRHasher().hash_expr(e);
+}
+
+uint64_t structural_hash(const Stmt &s) {
+    return IRHasher().hash_stmt(s);
+}
+
 bool IRDeepCompare::operator()(const Expr &a, const Expr &b) const {
     IRComparer cmp;
     cmp.compare_expr(a, b);
@@ -694,6 +992,15 @@ void ir_equality_test() {
     e2 = e2 * e2 + e2;
     check_not_equal(e1, e2);
 
+    // Equal things must hash the same, even when they are graphs
+    // that would be exponentially large if traversed as trees.
+    Expr e3 = Variable::make(Int(32), "x");
+    for (int i = 0; i < 100; i++) {
+        e3 = e3 * e3 + e3;
+    }
+    internal_assert(structural_hash(e1) == structural_hash(e3));
+    internal_assert(structural_hash(e1) != structural_hash(e2));
+
     debug(0) << "ir_equality_test passed\n";
 }
 
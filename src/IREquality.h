@@ -118,6 +118,15 @@ bool graph_equal(const Expr &a, const Expr &b);
 bool graph_equal(const Stmt &a, const Stmt &b);
 // @}
 
+/** Compute a hash of an IR node that depends only on its value, so
+ * that any two nodes for which equal() returns true have the same
+ * hash. Shared subexpressions are only hashed once, so this is safe
+ * to use on nasty graphs of IR nodes. */
+// @{
+uint64_t structural_hash(const Expr &e);
+uint64_t structural_hash(const Stmt &s);
+// @}
+
 void ir_equality_test();
 
 }  // namespace Internal
@@ -1004,6 +1004,227 @@ Expr fast_exp(const Expr &x_full) {
     return result;
 }
 
+// The polynomials below were fit with an iteratively reweighted least
+// squares approximation to the minimax polynomial. Each table has one
+// row per ApproximationPrecision, padded with leading zeros.
+namespace {
+
+Expr evaluate_polynomial(const Expr &x, const float (&coeff)[3][10], ApproximationPrecision precision) {
+    const float *c = coeff[(int)precision];
+    int first = 0;
+    while (c[first] == 0.0f) {
+        first++;
+    }
+    std::vector<float> terms(c + first, c + 10);
+    return evaluate_polynomial(x, terms.data(), (int)terms.size());
+}
+
+// exp2(x) ~= 2^floor(x) * p(x - floor(x)). Relative error in p of
+// 7.5e-5, 7.5e-8 and 1.9e-9 on [0, 1).
+const float exp2_coeff[3][10] = {
+    {0, 0, 0, 0, 0, 0,
+     0.07802435711790265f,
+     0.2260677359497355f,
+     0.6958331318226253f,
+     0.9999252795407548f},
+    {0, 0, 0, 0,
+     0.0018775780509576623f,
+     0.008989343716031115f,
+     0.05582630759092719f,
+     0.24015362429183426f,
+     0.6931530715030881f,
+     0.9999999251639302f},
+    {0, 0, 0,
+     0.00021702269664629158f,
+     0.0012439689829477013f,
+     0.009678839969580553f,
+     0.05548334302870963f,
+     0.24022983585803043f,
+     0.6931469839044634f,
+     1.0000000018531816f}};
+
+// log2(1 + x) ~= x * p(x). Relative error in p of 5e-4, 1.6e-6 and
+// 3.8e-8 on [-0.25, 0.5). The trailing zero supplies the multiply by x.
+const float log2_coeff[3][10] = {
+    {0, 0, 0, 0, 0,
+     -0.27799676180223837f,
+     0.4997519653229827f,
+     -0.7264471752281636f,
+     1.4424556780612214f,
+     0.0f},
+    {0, 0,
+     0.12280409460422057f,
+     -0.24488150638876915f,
+     0.2983584322039596f,
+     -0.361360054926097f,
+     0.4806099349222459f,
+     -0.7213319723532696f,
+     1.442696443949469f,
+     0.0f},
+    {0.08021577414540243f,
+     -0.17638104600295862f,
+     0.2166621988255714f,
+     -0.24250542403929623f,
+     0.2881395594433234f,
+     -0.3605825244855598f,
+     0.48090358599628363f,
+     -0.7213484177642575f,
+     1.4426950264408f,
+     0.0f}};
+
+// atan(x) ~= x * p(x^2). Absolute error of 8.1e-5, 1.7e-6 and 3.7e-8
+// on [0, 1].
+const float atan_coeff[3][10] = {
+    {0, 0, 0, 0, 0, 0,
+     -0.03898487523866203f,
+     0.14626207338316685f,
+     -0.3211740111681508f,
+     0.9992137221163413f},
+    {0, 0, 0, 0,
+     -0.01171875936056784f,
+     0.052646426990789266f,
+     -0.11642566752296471f,
+     0.19354006763045914f,
+     -0.3326227812993845f,
+     0.9999772171736602f},
+    {0, 0,
+     -0.00405446605310135f,
+     0.02186260844888405f,
+     -0.055911847346514304f,
+     0.09642164106521214f,
+     -0.1390861734384488f,
+     0.19946563377115845f,
+     -0.3332986060035499f,
+     0.9999993355361323f}};
+
+}  // namespace
+
+Expr fast_exp2(const Expr &x_full, ApproximationPrecision precision) {
+    user_assert(x_full.type() == Float(32)) << "fast_exp2 only works for Float(32)";
+    Type type = x_full.type();
+
+    // Clamp the input first, so that the conversion of the exponent
+    // to an int can't overflow. Anything outside this range is
+    // already zero or inf once the exponent is clamped below.
+    Expr x_clamped = clamp(x_full, -150.0f, 129.0f);
+    Expr k_real = floor(x_clamped);
+    Expr k = cast(Int(32, type.lanes()), k_real);
+    Expr x = x_clamped - k_real;
+
+    Expr result = evaluate_polynomial(x, exp2_coeff, precision);
+
+    // Compute 2^k. Clamping the biased exponent gives zero on
+    // underflow and inf on overflow.
+    Expr biased = clamp(k + 127, 0, 255);
+    result *= reinterpret(type, biased << 23);
+    result = common_subexpression_elimination(result);
+    return result;
+}
+
+Expr fast_log2(const Expr &x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_log2 only works for Float(32)";
+
+    Expr reduced, exponent;
+    range_reduce_log(x, &reduced, &exponent);
+
+    Expr result = evaluate_polynomial(reduced - 1.0f, log2_coeff, precision);
+    result += cast(x.type(), exponent);
+    result = common_subexpression_elimination(result);
+    return result;
+}
+
+Expr fast_tanh(const Expr &x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_tanh only works for Float(32)";
+
+    // tanh(|x|) = (1 - e^-2|x|) / (1 + e^-2|x|)
+    Expr abs_x = abs(x);
+    Expr e = fast_exp2(abs_x * (float)(-2.0 / std::log(2.0)), precision);
+    Expr result = (1.0f - e) / (1.0f + e);
+
+    if (precision == ApproximationPrecision::High) {
+        // The expression above loses relative precision near zero to
+        // cancellation. Use an odd polynomial there instead, which
+        // has a relative error of 1.1e-7 on [0, 0.625).
+        float coeff[] = {
+            0.01505078046551457f,
+            -0.05182175500251361f,
+            0.1330452368979613f,
+            -0.33331954103850936f,
+            0.9999998931195381f};
+        Expr small = abs_x * evaluate_polynomial(abs_x * abs_x, coeff, sizeof(coeff) / sizeof(coeff[0]));
+        result = select(abs_x < 0.625f, small, result);
+    }
+
+    result = select(x < 0.0f, -result, result);
+    result = common_subexpression_elimination(result);
+    return result;
+}
+
+Expr fast_sigmoid(const Expr &x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_sigmoid only works for Float(32)";
+    // The exponential overflows to inf for large negative x, which
+    // correctly gives zero.
+    Expr e = fast_exp2(x * (float)(-1.0 / std::log(2.0)), precision);
+    return common_subexpression_elimination(1.0f / (1.0f + e));
+}
+
+Expr fast_erf(const Expr &x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_erf only works for Float(32)";
+    if (precision == ApproximationPrecision::High) {
+        return Internal::halide_erf(x);
+    }
+
+    Expr abs_x = abs(x);
+    Expr d;
+    if (precision == ApproximationPrecision::Low) {
+        // Abramowitz and Stegun 7.1.27. Absolute error of 5e-4.
+        float coeff[] = {0.078108f, 0.000972f, 0.230389f, 0.278393f, 1.0f};
+        d = evaluate_polynomial(abs_x, coeff, sizeof(coeff) / sizeof(coeff[0]));
+        d *= d;
+        d *= d;
+    } else {
+        // Abramowitz and Stegun 7.1.28. Absolute error of 3e-7, plus
+        // about 2e-6 of rounding error in single precision.
+        float coeff[] = {0.0000430638f, 0.0002765672f, 0.0001520143f,
+                         0.0092705272f, 0.0422820123f, 0.0705230784f, 1.0f};
+        d = evaluate_polynomial(abs_x, coeff, sizeof(coeff) / sizeof(coeff[0]));
+        d *= d;
+        d *= d;
+        d *= d;
+        d *= d;
+    }
+    Expr result = 1.0f - 1.0f / d;
+    result = select(x < 0.0f, -result, result);
+    result = common_subexpression_elimination(result);
+    return result;
+}
+
+Expr fast_atan(const Expr &x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_atan only works for Float(32)";
+    return fast_atan2(x, Internal::make_one(x.type()), precision);
+}
+
+Expr fast_atan2(const Expr &y, const Expr &x, ApproximationPrecision precision) {
+    user_assert(y.type() == Float(32) && x.type() == Float(32))
+        << "fast_atan2 only works for Float(32)";
+
+    const float pi = 3.14159265358979323846f;
+
+    // Reduce to an argument in [0, 1] and use the symmetries of atan
+    // to recover the full range.
+    Expr abs_x = abs(x), abs_y = abs(y);
+    Expr hi = max(abs_x, abs_y);
+    Expr lo = min(abs_x, abs_y);
+    Expr a = select(hi == 0.0f, 0.0f, lo / hi);
+
+    Expr result = a * evaluate_polynomial(a * a, atan_coeff, precision);
+    result = select(abs_y > abs_x, pi / 2 - result, result);
+    result = select(x < 0.0f, pi - result, result);
+    result = select(y < 0.0f, -result, result);
+    result = common_subexpression_elimination(result);
+    return result;
+}
+
 Expr print(const std::vector<Expr> &args) {
     Expr combined_string = combine_strings(args);
 
@@ -942,6 +942,52 @@ Expr fast_exp(const Expr &x);
  * overflow. Vectorizes cleanly. */
 Expr fast_pow(Expr x, Expr y);
 
+/** The accuracy/speed tradeoff to use for the vectorizable
+ * transcendental approximations below (fast_exp2, fast_log2,
+ * fast_tanh, ...). All of them are built from inline Halide
+ * arithmetic (no calls into libm), so they vectorize cleanly at
+ * every precision. */
+enum class ApproximationPrecision {
+    /** A low-degree polynomial. Errors of roughly 1e-4 (relative for
+     * fast_exp2, absolute for the rest). */
+    Low,
+    /** Errors of a few ulp for fast_exp2, and roughly 5e-6 absolute
+     * for the rest. */
+    Medium,
+    /** Within a few ulp of float32 precision for fast_exp2 and
+     * fast_log2, and roughly 3e-7 absolute error for the rest. */
+    High,
+};
+
+/** Fast approximate 2^x for Float(32). Returns zero for inputs that
+ * would underflow to a denormal and inf for inputs that would
+ * overflow. Vectorizes cleanly. */
+Expr fast_exp2(const Expr &x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+
+/** Fast approximate log base 2 for Float(32). Returns nonsense for x
+ * <= 0.0f. Vectorizes cleanly. */
+Expr fast_log2(const Expr &x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+
+/** Fast approximate hyperbolic tangent for Float(32). Vectorizes
+ * cleanly. */
+Expr fast_tanh(const Expr &x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+
+/** Fast approximate logistic function 1 / (1 + e^-x) for
+ * Float(32). Vectorizes cleanly. */
+Expr fast_sigmoid(const Expr &x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+
+/** Fast approximate error function for Float(32). At High precision
+ * this is the same as erf. Vectorizes cleanly. */
+Expr fast_erf(const Expr &x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+
+/** Fast approximate arctangent for Float(32). fast_atan2 returns the
+ * angle of the point (x, y) in the range [-pi, pi], and zero for the
+ * origin. Vectorizes cleanly. */
+// @{
+Expr fast_atan(const Expr &x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+Expr fast_atan2(const Expr &y, const Expr &x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+// @}
+
 /** Fast approximate inverse for Float(32). Corresponds to the rcpps
  * instruction on x86, and the vrecpe instruction on ARM. Vectorizes
  * cleanly. Note that this can produce slightly different results
@@ -273,6 +273,12 @@ ostream &operator<<(ostream &out, const ForType &type) {
     case ForType::GPULane:
         out << "gpu_lane";
         break;
+    case ForType::UnrolledAndJammed:
+        out << "unrolled_and_jammed";
+        break;
+    case ForType::SoftwarePipelined:
+        out << "software_pipelined";
+        break;
     }
     return out;
 }
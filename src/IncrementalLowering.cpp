@@ -0,0 +1,926 @@
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include "IncrementalLowering.h"
+
+#include "Buffer.h"
+#include "Debug.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Parameter.h"
+#include "Scope.h"
+#include "ThreadPool.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// The name of the extern call that marks where a producer was cut
+// out of the main Stmt.
+const char *const placeholder_name = "_halide_lowering_segment";
+
+// Only keep the results for this many producers. Enough for several
+// versions of a large pipeline.
+const size_t max_cached_segments = 1024;
+
+// The images and parameters a Stmt refers to, keyed by canonical name.
+struct ImagesAndParams {
+    map<string, Buffer<>> images;
+    map<string, Parameter> params;
+    // The bounds, constraints and estimates of each parameter when the
+    // Stmt was lowered. Parameters can be changed afterwards, so these
+    // are copied out rather than read from the params.
+    map<string, vector<Expr>> constraints;
+};
+
+// The bounds, constraints and estimates of a parameter, which the
+// passes may use to simplify the IR.
+vector<Expr> param_constraints(const Parameter &p) {
+    if (!p.is_buffer()) {
+        return {p.min_value(), p.max_value(), p.estimate()};
+    }
+    vector<Expr> result = {p.host_alignment()};
+    for (int d = 0; d < p.dimensions(); d++) {
+        result.push_back(p.min_constraint(d));
+        result.push_back(p.extent_constraint(d));
+        result.push_back(p.stride_constraint(d));
+        result.push_back(p.min_constraint_estimate(d));
+        result.push_back(p.extent_constraint_estimate(d));
+    }
+    return result;
+}
+
+struct CachedSegment {
+    // The canonicalized producer given to the passes.
+    Stmt input;
+
+    // The images and parameters the input refers to.
+    ImagesAndParams used;
+
+    // The target and passes used.
+    string key;
+
+    Stmt output;
+
+    uint64_t last_used;
+};
+
+class SegmentCache {
+public:
+    std::mutex mutex;
+    bool enabled;
+    IncrementalLoweringStats stats;
+    map<uint64_t, vector<CachedSegment>> entries;
+    size_t size = 0;
+    uint64_t clock = 0;
+
+    SegmentCache() {
+        enabled = get_env_variable("HL_INCREMENTAL_LOWERING") == "1";
+    }
+
+    void clear() {
+        entries.clear();
+        size = 0;
+        stats = IncrementalLoweringStats();
+    }
+
+    // Drop the least recently used entry.
+    void evict() {
+        auto oldest = entries.end();
+        size_t oldest_idx = 0;
+        for (auto it = entries.begin(); it != entries.end(); it++) {
+            for (size_t i = 0; i < it->second.size(); i++) {
+                if (oldest == entries.end() ||
+                    it->second[i].last_used < oldest->second[oldest_idx].last_used) {
+                    oldest = it;
+                    oldest_idx = i;
+                }
+            }
+        }
+        if (oldest != entries.end()) {
+            oldest->second.erase(oldest->second.begin() + oldest_idx);
+            if (oldest->second.empty()) {
+                entries.erase(oldest);
+            }
+            size--;
+        }
+    }
+};
+
+SegmentCache &segment_cache() {
+    static SegmentCache cache;
+    return cache;
+}
+
+// Names made by unique_name depend on what else has been created in
+// this process. For example, rebuilding a pipeline gives its Funcs
+// new names: "f" the first time, then "f$1", "f$2", and so on, and
+// implicit Vars get new numbers. Producers are cached with their
+// names canonicalized, so that they can be found again regardless,
+// and the renaming is undone on the way out. Names are split into
+// tokens (maximal runs of identifier characters). Tokens like "v12"
+// are numbered in order of first appearance. Other tokens lose any
+// "$n" suffix, unless another token with the same stem was seen
+// first, in which case they are numbered too. Tokens joined by other
+// uses of '$' are canonicalized piece by piece.
+class NameMap {
+    map<string, string> to_canonical, from_canonical;
+
+    // Whole names already mapped, as most names appear many times.
+    map<string, string> names_to_canonical, names_from_canonical;
+
+    int counter = 0;
+
+    static bool is_ident_char(char c) {
+        return isalnum(c) || c == '_' || c == '$';
+    }
+
+    // Is a token something unique_name(char) could have made? Stage
+    // names like s0 are left alone so that names stay readable.
+    static bool looks_numbered(const string &token) {
+        if (token.size() < 2 ||
+            !(isalpha(token[0]) || token[0] == '_') ||
+            token[0] == 's') {
+            return false;
+        }
+        for (size_t i = 1; i < token.size(); i++) {
+            if (!isdigit(token[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Strip the suffix unique_name(string) adds, if any.
+    static string stem(const string &token) {
+        size_t dollar = token.find('$');
+        if (dollar == string::npos || dollar == 0 ||
+            dollar + 1 == token.size() ||
+            token.find('$', dollar + 1) != string::npos) {
+            return token;
+        }
+        for (size_t i = dollar + 1; i < token.size(); i++) {
+            if (!isdigit(token[i])) {
+                return token;
+            }
+        }
+        return token.substr(0, dollar);
+    }
+
+    template<typename Fn>
+    static string map_tokens(const string &name, Fn fn) {
+        string result;
+        size_t i = 0;
+        while (i < name.size()) {
+            if (!is_ident_char(name[i])) {
+                result += name[i++];
+                continue;
+            }
+            size_t j = i;
+            while (j < name.size() && is_ident_char(name[j])) {
+                j++;
+            }
+            result += fn(name.substr(i, j - i));
+            i = j;
+        }
+        return result;
+    }
+
+    string canonical_token(const string &token) {
+        auto it = to_canonical.find(token);
+        if (it != to_canonical.end()) {
+            return it->second;
+        }
+        string c;
+        size_t dollar = token.find('$');
+        if (dollar != string::npos && stem(token) == token) {
+            // Some names are built from others with a '$', e.g. the
+            // RVars of an RDom named r12 are r12$x, r12$y, ...
+            size_t start = 0;
+            while (dollar != string::npos) {
+                c += canonical_token(token.substr(start, dollar - start)) + "$";
+                start = dollar + 1;
+                dollar = token.find('$', start);
+            }
+            c += canonical_token(token.substr(start));
+        } else if (looks_numbered(token)) {
+            // unique_name never returns names with two '$'s.
+            c = "$$" + std::to_string(counter++);
+        } else {
+            c = stem(token);
+            if (from_canonical.count(c)) {
+                c += "$$" + std::to_string(counter++);
+            }
+        }
+        to_canonical[token] = c;
+        from_canonical[c] = token;
+        return c;
+    }
+
+public:
+    string canonical(const string &name) {
+        auto it = names_to_canonical.find(name);
+        if (it != names_to_canonical.end()) {
+            return it->second;
+        }
+        string c = map_tokens(name, [&](const string &token) {
+            return canonical_token(token);
+        });
+        names_to_canonical[name] = c;
+        return c;
+    }
+
+    string original(const string &name) {
+        auto it = names_from_canonical.find(name);
+        if (it != names_from_canonical.end()) {
+            return it->second;
+        }
+        string o = map_tokens(name, [&](const string &token) {
+            auto it = from_canonical.find(token);
+            return it == from_canonical.end() ? fresh_token(token) : it->second;
+        });
+        names_from_canonical[name] = o;
+        return o;
+    }
+
+private:
+    // Tokens the passes made with unique_name get new names too, so
+    // that they don't depend on what other threads were doing at the
+    // time, and so that a cached result used twice doesn't define
+    // the same name twice.
+    map<string, string> fresh;
+
+    string fresh_token(const string &token) {
+        auto it = fresh.find(token);
+        if (it != fresh.end()) {
+            return it->second;
+        }
+        string f = token;
+        auto c = from_canonical.end();
+        if (starts_with(token, "__")) {
+            // unique_name(string) replaces the '$'s in a canonical
+            // token with underscores.
+            c = from_canonical.find("$$" + token.substr(2));
+        }
+        if (c != from_canonical.end()) {
+            f = c->second;
+        } else if (looks_numbered(token)) {
+            f = unique_name(token[0]);
+        } else if (stem(token) != token) {
+            f = unique_name(stem(token));
+        }
+        fresh[token] = f;
+        return f;
+    }
+};
+
+// Rename everything in a Stmt that refers to something by name. On
+// the way in, also record the images and parameters used. Equal
+// Stmts may use different ones with the same names, so on the way
+// out, swap in the ones with the same names from the Stmt that was
+// cached.
+class RenameAll : public IRMutator {
+    using IRMutator::visit;
+
+    NameMap &names;
+    bool to_canonical;
+    ImagesAndParams &used;
+    const ImagesAndParams *cached;
+
+    string rename(const string &name) {
+        return to_canonical ? names.canonical(name) : names.original(name);
+    }
+
+    Buffer<> rebind(const Buffer<> &image) {
+        if (!image.defined()) {
+            return image;
+        }
+        if (to_canonical) {
+            used.images[names.canonical(image.name())] = image;
+        } else if (cached) {
+            for (const auto &it : cached->images) {
+                Buffer<> b = it.second;
+                if (b.same_as(image)) {
+                    return used.images.at(it.first);
+                }
+            }
+        }
+        return image;
+    }
+
+    Parameter rebind(const Parameter &param) {
+        if (!param.defined()) {
+            return param;
+        }
+        if (to_canonical) {
+            string name = names.canonical(param.name());
+            used.params[name] = param;
+            used.constraints[name] = param_constraints(param);
+        } else if (cached) {
+            for (const auto &it : cached->params) {
+                if (it.second.same_as(param)) {
+                    return used.params.at(it.first);
+                }
+            }
+        }
+        return param;
+    }
+
+    Expr visit(const StringImm *op) override {
+        string value = rename(op->value);
+        return value == op->value ? Expr(op) : StringImm::make(value);
+    }
+
+    Expr visit(const Variable *op) override {
+        string name = rename(op->name);
+        Buffer<> image = rebind(op->image);
+        Parameter param = rebind(op->param);
+        if (name == op->name && image.same_as(op->image) && param.same_as(op->param)) {
+            return op;
+        }
+        return Variable::make(op->type, name, image, param, op->reduction_domain);
+    }
+
+    Expr visit(const Load *op) override {
+        Expr e = IRMutator::visit(op);
+        op = e.as<Load>();
+        string name = rename(op->name);
+        Buffer<> image = rebind(op->image);
+        Parameter param = rebind(op->param);
+        if (name == op->name && image.same_as(op->image) && param.same_as(op->param)) {
+            return e;
+        }
+        return Load::make(op->type, name, op->index, image, param, op->predicate, op->alignment);
+    }
+
+    Expr visit(const Call *op) override {
+        Expr e = IRMutator::visit(op);
+        op = e.as<Call>();
+        string name = rename(op->name);
+        Buffer<> image = rebind(op->image);
+        Parameter param = rebind(op->param);
+        if (name == op->name && image.same_as(op->image) && param.same_as(op->param)) {
+            return e;
+        }
+        return Call::make(op->type, name, op->args, op->call_type, op->func, op->value_index, image, param);
+    }
+
+    Expr visit(const Let *op) override {
+        Expr e = IRMutator::visit(op);
+        op = e.as<Let>();
+        string name = rename(op->name);
+        if (name == op->name) {
+            return e;
+        }
+        return Let::make(name, op->value, op->body);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        Stmt s = IRMutator::visit(op);
+        op = s.as<LetStmt>();
+        string name = rename(op->name);
+        if (name == op->name) {
+            return s;
+        }
+        return LetStmt::make(name, op->value, op->body);
+    }
+
+    Stmt visit(const ProducerConsumer *op) override {
+        Stmt s = IRMutator::visit(op);
+        op = s.as<ProducerConsumer>();
+        string name = rename(op->name);
+        if (name == op->name) {
+            return s;
+        }
+        return ProducerConsumer::make(name, op->is_producer, op->body);
+    }
+
+    Stmt visit(const For *op) override {
+        Stmt s = IRMutator::visit(op);
+        op = s.as<For>();
+        string name = rename(op->name);
+        if (name == op->name) {
+            return s;
+        }
+        return For::make(name, op->min, op->extent, op->for_type, op->device_api, op->body);
+    }
+
+    Stmt visit(const Store *op) override {
+        Stmt s = IRMutator::visit(op);
+        op = s.as<Store>();
+        string name = rename(op->name);
+        Parameter param = rebind(op->param);
+        if (name == op->name && param.same_as(op->param)) {
+            return s;
+        }
+        return Store::make(name, op->value, op->index, param, op->predicate, op->alignment);
+    }
+
+    Stmt visit(const Provide *op) override {
+        Stmt s = IRMutator::visit(op);
+        op = s.as<Provide>();
+        string name = rename(op->name);
+        if (name == op->name) {
+            return s;
+        }
+        return Provide::make(name, op->values, op->args);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        Stmt s = IRMutator::visit(op);
+        op = s.as<Allocate>();
+        string name = rename(op->name);
+        if (name == op->name) {
+            return s;
+        }
+        return Allocate::make(name, op->type, op->memory_type, op->extents,
+                              op->condition, op->body, op->new_expr, op->free_function);
+    }
+
+    Stmt visit(const Free *op) override {
+        string name = rename(op->name);
+        return name == op->name ? Stmt(op) : Free::make(name);
+    }
+
+    Stmt visit(const Realize *op) override {
+        Stmt s = IRMutator::visit(op);
+        op = s.as<Realize>();
+        string name = rename(op->name);
+        if (name == op->name) {
+            return s;
+        }
+        return Realize::make(name, op->types, op->memory_type, op->bounds, op->condition, op->body);
+    }
+
+    Stmt visit(const Prefetch *op) override {
+        Stmt s = IRMutator::visit(op);
+        op = s.as<Prefetch>();
+        PrefetchDirective prefetch = op->prefetch;
+        prefetch.name = rename(prefetch.name);
+        prefetch.var = rename(prefetch.var);
+        prefetch.param = rebind(prefetch.param);
+        string name = rename(op->name);
+        if (name == op->name &&
+            prefetch.name == op->prefetch.name &&
+            prefetch.var == op->prefetch.var &&
+            prefetch.param.same_as(op->prefetch.param)) {
+            return s;
+        }
+        return Prefetch::make(name, op->types, op->bounds, prefetch, op->condition, op->body);
+    }
+
+    Stmt visit(const Atomic *op) override {
+        Stmt s = IRMutator::visit(op);
+        op = s.as<Atomic>();
+        string producer_name = rename(op->producer_name);
+        string mutex_name = rename(op->mutex_name);
+        if (producer_name == op->producer_name && mutex_name == op->mutex_name) {
+            return s;
+        }
+        return Atomic::make(producer_name, mutex_name, op->body);
+    }
+
+public:
+    RenameAll(NameMap &n, bool c, ImagesAndParams &u, const ImagesAndParams *cached = nullptr)
+        : names(n), to_canonical(c), used(u), cached(cached) {
+    }
+};
+
+// Collect the names of the variables a Stmt uses, including those
+// holding the host pointers of the buffers it loads from or stores to.
+class CollectVariables : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Variable *op) override {
+        names.insert(op->name);
+    }
+
+    void visit(const Load *op) override {
+        names.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        names.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    set<string> names;
+};
+
+bool same_exprs(const vector<Expr> &a, const vector<Expr> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].defined() != b[i].defined() ||
+            (a[i].defined() && !equal(a[i], b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check that a cached producer used images and parameters with the
+// same names and kinds, and the same constraints, as the one being
+// lowered.
+bool compatible(const ImagesAndParams &a, const ImagesAndParams &b) {
+    if (a.images.size() != b.images.size() ||
+        a.params.size() != b.params.size()) {
+        return false;
+    }
+    for (auto i = a.images.begin(), j = b.images.begin(); i != a.images.end(); i++, j++) {
+        if (i->first != j->first ||
+            i->second.type() != j->second.type() ||
+            i->second.dimensions() != j->second.dimensions()) {
+            return false;
+        }
+    }
+    for (auto i = a.params.begin(), j = b.params.begin(); i != a.params.end(); i++, j++) {
+        if (i->first != j->first ||
+            i->second.type() != j->second.type() ||
+            i->second.is_buffer() != j->second.is_buffer() ||
+            i->second.dimensions() != j->second.dimensions() ||
+            !same_exprs(a.constraints.at(i->first), b.constraints.at(j->first))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Cut the top-level producers out of a Stmt, replacing each with a
+// placeholder. A producer is cut out along with copies of the lets it
+// depends on. Lets with side effects or handle types can't be
+// duplicated, so the producer refers to them instead, and they are
+// passed to the placeholder to keep them alive.
+class CutOutProducers : public IRMutator {
+    using IRMutator::visit;
+
+    vector<const LetStmt *> lets;
+
+    Stmt visit(const LetStmt *op) override {
+        lets.push_back(op);
+        Stmt body = mutate(op->body);
+        lets.pop_back();
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return LetStmt::make(op->name, op->value, body);
+    }
+
+    Stmt visit(const ProducerConsumer *op) override {
+        if (!op->is_producer) {
+            return IRMutator::visit(op);
+        }
+
+        CollectVariables vars;
+        op->accept(&vars);
+        set<string> &needed = vars.names;
+
+        Stmt segment = op;
+        vector<Expr> placeholder_args = {(int)segments.size()};
+        for (size_t i = lets.size(); i > 0; i--) {
+            const LetStmt *let = lets[i - 1];
+            if (!needed.count(let->name)) {
+                continue;
+            }
+            if (let->value.type().is_handle() || !is_pure(let->value)) {
+                placeholder_args.push_back(Variable::make(let->value.type(), let->name));
+                needed.erase(let->name);
+            } else {
+                segment = LetStmt::make(let->name, let->value, segment);
+                let->value.accept(&vars);
+            }
+        }
+
+        segments.push_back(segment);
+        args.push_back(placeholder_args);
+        return Evaluate::make(Call::make(Int(32), placeholder_name, placeholder_args, Call::Extern));
+    }
+
+    // Don't look inside anything that might constrain or repeat the
+    // producers within.
+    Stmt visit(const For *op) override {
+        return op;
+    }
+
+    Stmt visit(const IfThenElse *op) override {
+        // The body of a pipeline is guarded by a check that this
+        // isn't a bounds query. Conditions like that tell the passes
+        // nothing useful about the producers inside, but other
+        // conditions might.
+        if (is_pure(op->condition)) {
+            return op;
+        }
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Fork *op) override {
+        return op;
+    }
+
+    Stmt visit(const Acquire *op) override {
+        return op;
+    }
+
+    Stmt visit(const Atomic *op) override {
+        return op;
+    }
+
+    Stmt visit(const Prefetch *op) override {
+        return op;
+    }
+
+public:
+    vector<Stmt> segments;
+    vector<vector<Expr>> args;
+
+    Expr mutate(const Expr &e) override {
+        return e;
+    }
+
+    Stmt mutate(const Stmt &s) override {
+        return IRMutator::mutate(s);
+    }
+};
+
+// Put the lowered producers back in place of the placeholders.
+class PasteInProducers : public IRMutator {
+    using IRMutator::visit;
+
+    const vector<Stmt> &segments;
+    const vector<vector<Expr>> &original_args;
+
+    // The lets the passes kept around the placeholder.
+    Scope<> bound;
+
+    Stmt visit(const LetStmt *op) override {
+        ScopedBinding<> bind(bound, op->name);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Evaluate *op) override {
+        const Call *c = op->value.as<Call>();
+        if (!c || c->name != placeholder_name) {
+            return op;
+        }
+        const int64_t *idx = as_const_int(c->args[0]);
+        internal_assert(idx && *idx >= 0 && *idx < (int64_t)segments.size());
+
+        // Drop the copies of lets that are still defined outside
+        // the producer, because every name must be unique.
+        Stmt segment = segments[*idx];
+        vector<const LetStmt *> lets;
+        while (const LetStmt *let = segment.as<LetStmt>()) {
+            lets.push_back(let);
+            segment = let->body;
+        }
+        while (!lets.empty()) {
+            const LetStmt *let = lets.back();
+            lets.pop_back();
+            if (!bound.contains(let->name)) {
+                segment = LetStmt::make(let->name, let->value, segment);
+            }
+        }
+
+        // The passes may have substituted away or renamed lets the
+        // producer refers to.
+        const vector<Expr> &args = original_args[*idx];
+        internal_assert(args.size() == c->args.size());
+        for (size_t i = 1; i < args.size(); i++) {
+            const Variable *v = args[i].as<Variable>();
+            internal_assert(v);
+            if (!bound.contains(v->name)) {
+                segment = LetStmt::make(v->name, c->args[i], segment);
+            }
+        }
+
+        pasted++;
+        return segment;
+    }
+
+public:
+    size_t pasted = 0;
+
+    PasteInProducers(const vector<Stmt> &s, const vector<vector<Expr>> &a)
+        : segments(s), original_args(a) {
+    }
+
+    Expr mutate(const Expr &e) override {
+        return e;
+    }
+
+    Stmt mutate(const Stmt &s) override {
+        return IRMutator::mutate(s);
+    }
+};
+
+// A producer (or what remains of the Stmt once they are cut out)
+// given to the passes, with its names canonicalized.
+struct LoweredSegment {
+    NameMap names;
+    ImagesAndParams used, cached_used;
+    bool hit = false;
+    Stmt output;
+};
+
+// Apply the passes to a canonicalized copy of a Stmt, or find the
+// result in the cache. Safe to call from several threads at once.
+void lower_segment(const Stmt &s, const string &key, bool use_cache,
+                   const std::function<Stmt(const Stmt &)> &passes,
+                   LoweredSegment &result) {
+    SegmentCache &cache = segment_cache();
+
+    Stmt input = RenameAll(result.names, true, result.used).mutate(s);
+    if (!use_cache) {
+        result.output = passes(input);
+        return;
+    }
+
+    uint64_t hash = structural_hash(input) ^ std::hash<string>()(key);
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.entries.find(hash);
+        if (it != cache.entries.end()) {
+            for (CachedSegment &entry : it->second) {
+                if (entry.key == key &&
+                    compatible(entry.used, result.used) &&
+                    equal(entry.input, input)) {
+                    entry.last_used = cache.clock++;
+                    cache.stats.hits++;
+                    result.output = entry.output;
+                    result.cached_used = entry.used;
+                    result.hit = true;
+                    return;
+                }
+            }
+        }
+    }
+
+    result.output = passes(input);
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.enabled) {
+        cache.stats.misses++;
+        CachedSegment entry;
+        entry.input = input;
+        entry.used = result.used;
+        entry.key = key;
+        entry.output = result.output;
+        entry.last_used = cache.clock++;
+        cache.entries[hash].push_back(std::move(entry));
+        if (++cache.size > max_cached_segments) {
+            cache.evict();
+        }
+    }
+}
+
+// Undo the renaming done by lower_segment. Not safe to call while
+// other threads may be making names, if the result is to be
+// deterministic.
+Stmt restore_names(LoweredSegment &segment) {
+    return RenameAll(segment.names, false, segment.used,
+                     segment.hit ? &segment.cached_used : nullptr)
+        .mutate(segment.output);
+}
+
+std::atomic<bool> &parallel_lowering_flag() {
+    static std::atomic<bool> enabled(get_env_variable("HL_PARALLEL_LOWERING") == "1");
+    return enabled;
+}
+
+// The number of threads to lower with, or zero for one per core.
+std::atomic<int> &parallel_lowering_threads() {
+    static std::atomic<int> threads(0);
+    return threads;
+}
+
+}  // namespace
+
+Stmt lower_incrementally(const Stmt &s, const Target &t,
+                         const string &passes_name,
+                         const std::function<Stmt(const Stmt &)> &passes) {
+    bool incremental = incremental_lowering_enabled();
+    bool parallel = parallel_lowering_enabled();
+    if (!incremental && !parallel) {
+        return passes(s);
+    }
+
+    CutOutProducers cutter;
+    Stmt skeleton = cutter.mutate(s);
+    size_t num_segments = cutter.segments.size();
+    if (num_segments == 0 || (!incremental && num_segments == 1)) {
+        return passes(s);
+    }
+
+    string key = t.to_string() + "/" + passes_name;
+    vector<LoweredSegment> lowered(num_segments);
+    if (parallel) {
+        // What remains of the Stmt is lowered alongside the
+        // producers, and never cached. Its names are canonicalized
+        // like theirs so that the names the passes make don't depend
+        // on the order in which the threads run.
+        LoweredSegment rest;
+        {
+            size_t max_threads = parallel_lowering_threads();
+            if (max_threads == 0) {
+                max_threads = ThreadPool<void>::num_processors_online();
+            }
+            size_t num_threads = std::min(num_segments + 1, max_threads);
+            ThreadPool<void> pool(num_threads);
+            vector<std::future<void>> done;
+            vector<std::exception_ptr> errors(num_segments + 1);
+            auto run = [&](size_t i) {
+                try {
+                    if (i < num_segments) {
+                        lower_segment(cutter.segments[i], key, incremental, passes, lowered[i]);
+                    } else {
+                        debug(3) << "Lowering what remains after cutting out "
+                                 << num_segments << " producers\n";
+                        lower_segment(skeleton, key, false, passes, rest);
+                    }
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            };
+            // Start with what remains, as it is usually the largest.
+            for (size_t i = num_segments + 1; i > 0; i--) {
+                done.push_back(pool.async(run, i - 1));
+            }
+            for (auto &f : done) {
+                f.wait();
+            }
+            for (auto &e : errors) {
+                if (e) {
+                    std::rethrow_exception(e);
+                }
+            }
+        }
+        skeleton = restore_names(rest);
+    } else {
+        for (size_t i = 0; i < num_segments; i++) {
+            lower_segment(cutter.segments[i], key, true, passes, lowered[i]);
+        }
+        debug(3) << "Lowering what remains after cutting out "
+                 << num_segments << " producers\n";
+        skeleton = passes(skeleton);
+    }
+
+    vector<Stmt> segments(num_segments);
+    for (size_t i = 0; i < num_segments; i++) {
+        segments[i] = restore_names(lowered[i]);
+    }
+
+    PasteInProducers paster(segments, cutter.args);
+    Stmt result = paster.mutate(skeleton);
+    internal_assert(paster.pasted == num_segments)
+        << "Lost track of a producer during incremental lowering\n";
+    return result;
+}
+
+void set_incremental_lowering(bool enabled) {
+    SegmentCache &cache = segment_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (!enabled) {
+        cache.clear();
+    }
+    cache.enabled = enabled;
+}
+
+bool incremental_lowering_enabled() {
+    SegmentCache &cache = segment_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.enabled;
+}
+
+void set_parallel_lowering(bool enabled, int num_threads) {
+    user_assert(num_threads >= 0) << "Can't lower with " << num_threads << " threads\n";
+    parallel_lowering_threads() = num_threads;
+    parallel_lowering_flag() = enabled;
+}
+
+bool parallel_lowering_enabled() {
+    return parallel_lowering_flag();
+}
+
+IncrementalLoweringStats incremental_lowering_stats() {
+    SegmentCache &cache = segment_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.stats;
+}
+
+}  // namespace Internal
+}  // namespace Halide
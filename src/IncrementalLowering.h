@@ -0,0 +1,67 @@
+#ifndef HALIDE_INCREMENTAL_LOWERING_H
+#define HALIDE_INCREMENTAL_LOWERING_H
+
+/** \file
+ * Defines a cache that lets lowering reuse the optimized loop nests of
+ * producers that have not changed since a previous lowering, and a
+ * way to optimize the loop nests of several producers at once.
+ */
+
+#include <functional>
+#include <string>
+
+#include "Expr.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Apply a sequence of lowering passes to a Stmt. If incremental
+ * lowering is enabled, each top-level producer (i.e. each
+ * compute_root group not inside a condition) is split out, wrapped
+ * in the lets it depends on, and given to the passes separately. The
+ * rest of the Stmt is given to the passes with placeholders for the
+ * producers, and the results are then stitched back together. The
+ * result for each producer is cached, keyed on its structure, the
+ * target, and the name of the passes, so that lowering a pipeline in
+ * which only some Funcs have changed reuses the work these passes did
+ * for the others. Passes run before this is called are not cached. If
+ * parallel lowering is enabled, the producers are split out in the
+ * same way, and each one (and what remains of the Stmt) is given to
+ * the passes on a thread of its own. The passes must not
+ * depend on anything outside of the Stmt they are given, and must be
+ * safe to run on several Stmts at once. */
+Stmt lower_incrementally(const Stmt &s, const Target &t,
+                         const std::string &passes_name,
+                         const std::function<Stmt(const Stmt &)> &passes);
+
+/** Turn incremental lowering on or off. It is off by default, unless
+ * the environment variable HL_INCREMENTAL_LOWERING is set to 1.
+ * Turning it off discards all cached results. */
+void set_incremental_lowering(bool enabled);
+
+/** Check whether incremental lowering is on. */
+bool incremental_lowering_enabled();
+
+/** Turn parallel lowering on or off. It is off by default, unless the
+ * environment variable HL_PARALLEL_LOWERING is set to 1. It uses up
+ * to num_threads threads, or one per core if num_threads is zero. The
+ * result of lowering does not depend on the number of threads used,
+ * or on the order in which they run. */
+void set_parallel_lowering(bool enabled, int num_threads = 0);
+
+/** Check whether parallel lowering is on. */
+bool parallel_lowering_enabled();
+
+/** Counts of producers whose lowering was found in, or added to, the
+ * cache since incremental lowering was last turned on. */
+struct IncrementalLoweringStats {
+    int hits = 0, misses = 0;
+};
+
+IncrementalLoweringStats incremental_lowering_stats();
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -44,7 +44,8 @@ void validate_schedule_inlined_function(Function f) {
             user_error << "Cannot parallelize dimension "
                        << d.var << " of function "
                        << f.name() << " because the function is scheduled inline.\n";
-        } else if (d.for_type == ForType::Unrolled) {
+        } else if (d.for_type == ForType::Unrolled ||
+                   d.for_type == ForType::UnrolledAndJammed) {
             user_error << "Cannot unroll dimension "
                        << d.var << " of function "
                        << f.name() << " because the function is scheduled inline.\n";
@@ -52,6 +53,10 @@ void validate_schedule_inlined_function(Function f) {
             user_error << "Cannot vectorize dimension "
                        << d.var << " of function "
                        << f.name() << " because the function is scheduled inline.\n";
+        } else if (d.for_type == ForType::SoftwarePipelined) {
+            user_error << "Cannot software pipeline dimension "
+                       << d.var << " of function "
+                       << f.name() << " because the function is scheduled inline.\n";
         }
     }
 
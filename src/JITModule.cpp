@@ -15,6 +15,7 @@
 
 #include "CodeGen_Internal.h"
 #include "CodeGen_LLVM.h"
+#include "CompileProfiler.h"
 #include "Debug.h"
 #include "JITModule.h"
 #include "LLVM_Headers.h"
@@ -260,6 +261,7 @@ JITModule::JITModule(const Module &m, const LoweredFunc &fn,
 void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &function_name, const Target &target,
                                const std::vector<JITModule> &dependencies,
                                const std::vector<std::string> &requested_exports) {
+    CompilePhase phase("jit_compile", "llvm");
 
     // Ensure that LLVM is initialized
     CodeGen_LLVM::initialize_llvm();
@@ -276,6 +278,7 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
 
     DataLayout initial_module_data_layout = m->getDataLayout();
     string module_name = m->getModuleIdentifier();
+    bool fast_compile = use_fast_compile(*m);
 
     llvm::EngineBuilder engine_builder((std::move(m)));
     engine_builder.setTargetOptions(options);
@@ -284,7 +287,7 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     HalideJITMemoryManager *memory_manager = new HalideJITMemoryManager(dependencies);
     engine_builder.setMCJITMemoryManager(std::unique_ptr<RTDyldMemoryManager>(memory_manager));
 
-    engine_builder.setOptLevel(CodeGenOpt::Aggressive);
+    engine_builder.setOptLevel(fast_compile ? CodeGenOpt::None : CodeGenOpt::Aggressive);
     if (!mcpu.empty()) {
         engine_builder.setMCPU(mcpu);
     }
@@ -2,6 +2,7 @@
 #include "CodeGen_C.h"
 #include "CodeGen_Internal.h"
 #include "CodeGen_LLVM.h"
+#include "CompileProfiler.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Runtime_Linker.h"
 
@@ -334,6 +335,7 @@ void emit_file(const llvm::Module &module_in, Internal::LLVMOStream &out,
                llvm::TargetMachine::CodeGenFileType file_type
 #endif
 ) {
+    Internal::CompilePhase phase("llvm_emit_file", "llvm");
     Internal::debug(1) << "emit_file.Compiling to native code...\n";
     Internal::debug(2) << "Target triple: " << module_in.getTargetTriple() << "\n";
 
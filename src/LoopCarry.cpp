@@ -8,6 +8,7 @@
 #include "Substitute.h"
 
 #include <algorithm>
+#include <map>
 
 namespace Halide {
 namespace Internal {
@@ -548,6 +549,244 @@ public:
     }
 };
 
+/** Check if a Stmt is a straight-line sequence of stores, and
+ * collect the names of the buffers it stores to. */
+bool is_straight_line(const Stmt &s, set<string> &stored) {
+    if (const LetStmt *let = s.as<LetStmt>()) {
+        return is_straight_line(let->body, stored);
+    } else if (const Block *block = s.as<Block>()) {
+        return (is_straight_line(block->first, stored) &&
+                is_straight_line(block->rest, stored));
+    } else if (const Store *store = s.as<Store>()) {
+        stored.insert(store->name);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+/** Check if an Expr can be evaluated one loop iteration early:
+ * it may not read from the buffers the loop writes to, or call
+ * anything with side effects. */
+class CanEvaluateEarly : public IRGraphVisitor {
+    const set<string> &stored;
+
+    using IRGraphVisitor::visit;
+
+    void visit(const Load *op) override {
+        if (stored.count(op->name)) {
+            result = false;
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Call *op) override {
+        if (!op->is_pure()) {
+            result = false;
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    bool result = true;
+    CanEvaluateEarly(const set<string> &s)
+        : stored(s) {
+    }
+};
+
+/** Find the outermost loads in a loop body that can be issued one
+ * iteration early, along with an equivalent of each one that
+ * doesn't depend on any lets inside the loop body. */
+class FindPipelinableLoads : public IRVisitor {
+    const string &loop_var;
+    const set<string> &stored;
+    vector<pair<string, Expr>> containing_lets;
+
+    using IRVisitor::visit;
+
+    void visit(const LetStmt *op) override {
+        op->value.accept(this);
+        containing_lets.emplace_back(op->name, op->value);
+        op->body.accept(this);
+        containing_lets.pop_back();
+    }
+
+    void visit(const Let *op) override {
+        op->value.accept(this);
+        containing_lets.emplace_back(op->name, op->value);
+        op->body.accept(this);
+        containing_lets.pop_back();
+    }
+
+    void visit(const Call *op) override {
+        // Loads that are only conditionally executed may not be
+        // safe to do early.
+        if (!op->is_intrinsic(Call::if_then_else)) {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Load *op) override {
+        // Rewrap the load in the lets it depends on, and substitute
+        // them in, so that it can be evaluated outside of the body.
+        Expr load = op;
+        for (size_t i = containing_lets.size(); i > 0; i--) {
+            const auto &l = containing_lets[i - 1];
+            if (expr_uses_var(load, l.first)) {
+                load = Let::make(l.first, l.second, load);
+            }
+        }
+        load = substitute_in_all_lets(load);
+
+        CanEvaluateEarly check(stored);
+        load.accept(&check);
+        if (!check.result || !expr_uses_var(load, loop_var)) {
+            // Try the loads inside its index instead.
+            IRVisitor::visit(op);
+            return;
+        }
+
+        for (size_t i = 0; i < loads.size(); i++) {
+            if (graph_equal(load, loads[i])) {
+                instances[i].push_back(op);
+                return;
+            }
+        }
+        loads.push_back(load);
+        instances.push_back({op});
+    }
+
+public:
+    // The distinct loads found, and the places in the body where
+    // each one occurs.
+    vector<Expr> loads;
+    vector<vector<const Load *>> instances;
+
+    FindPipelinableLoads(const string &v, const set<string> &s)
+        : loop_var(v), stored(s) {
+    }
+};
+
+/** Replace specific Load nodes with other Exprs. */
+class ReplaceLoads : public IRMutator {
+    const std::map<const Load *, Expr> &replacements;
+
+    using IRMutator::visit;
+
+    Expr visit(const Load *op) override {
+        auto it = replacements.find(op);
+        if (it != replacements.end()) {
+            return it->second;
+        } else {
+            return IRMutator::visit(op);
+        }
+    }
+
+public:
+    ReplaceLoads(const std::map<const Load *, Expr> &r)
+        : replacements(r) {
+    }
+};
+
+class SoftwarePipelineLoops : public IRMutator {
+    using IRMutator::visit;
+
+    int max_pipelined_values;
+
+    // Returns an undefined Stmt if the loop can't be pipelined.
+    Stmt pipeline(const For *op, const Stmt &body) {
+        set<string> stored;
+        if (!is_straight_line(body, stored)) {
+            return Stmt();
+        }
+
+        FindPipelinableLoads find(op->name, stored);
+        body.accept(&find);
+        if (find.loads.empty()) {
+            return Stmt();
+        }
+        if ((int)find.loads.size() > max_pipelined_values) {
+            find.loads.resize(max_pipelined_values);
+            find.instances.resize(max_pipelined_values);
+        }
+
+        // Each load gets a scratch buffer. The prologue fills them in
+        // for the first iteration. Each iteration of the steady state
+        // then loads the values for the next iteration, does its
+        // work using the values in the scratch buffers, and finally
+        // moves the next values into the scratch buffers. The
+        // epilogue does the work of the last iteration.
+        Expr loop_var = Variable::make(Int(32), op->name);
+        std::map<const Load *, Expr> replacements;
+        vector<Stmt> initial_stores, next_stores;
+        vector<pair<string, Expr>> next_values;
+        vector<pair<string, Type>> scratch_buffers;
+        for (size_t i = 0; i < find.loads.size(); i++) {
+            const Expr &load = find.loads[i];
+            Type t = load.type();
+            string scratch = unique_name('p');
+            scratch_buffers.emplace_back(scratch, t);
+
+            Expr idx = scratch_index(0, t);
+            Expr load_from_scratch = Load::make(t, scratch, idx, Buffer<>(), Parameter(),
+                                                const_true(t.lanes()), ModulusRemainder());
+            for (const Load *l : find.instances[i]) {
+                replacements[l] = load_from_scratch;
+            }
+
+            initial_stores.push_back(Store::make(scratch, load, idx, Parameter(),
+                                                 const_true(t.lanes()), ModulusRemainder()));
+
+            string next_name = scratch + ".next";
+            Expr next = graph_substitute(op->name, loop_var + 1, load);
+            next_values.emplace_back(next_name, common_subexpression_elimination(next));
+            next_stores.push_back(Store::make(scratch, Variable::make(t, next_name), idx, Parameter(),
+                                              const_true(t.lanes()), ModulusRemainder()));
+        }
+
+        Stmt core = ReplaceLoads(replacements).mutate(body);
+
+        Stmt prologue = common_subexpression_elimination(Block::make(initial_stores));
+        prologue = LetStmt::make(op->name, op->min, prologue);
+
+        Stmt steady = Block::make(core, Block::make(next_stores));
+        for (size_t i = next_values.size(); i > 0; i--) {
+            const auto &n = next_values[i - 1];
+            steady = LetStmt::make(n.first, n.second, steady);
+        }
+        steady = For::make(op->name, op->min, op->extent - 1, ForType::Serial, op->device_api, steady);
+
+        Stmt epilogue = LetStmt::make(op->name, op->min + op->extent - 1, core);
+
+        Stmt stmt = Block::make({prologue, steady, epilogue});
+        for (const auto &b : scratch_buffers) {
+            stmt = Allocate::make(b.first, b.second.element_of(), MemoryType::Stack,
+                                  {b.second.lanes()}, const_true(), stmt);
+        }
+        return IfThenElse::make(op->extent > 0, stmt);
+    }
+
+    Stmt visit(const For *op) override {
+        if (op->for_type != ForType::SoftwarePipelined) {
+            return IRMutator::visit(op);
+        }
+        Stmt body = mutate(op->body);
+        Stmt stmt = pipeline(op, body);
+        if (!stmt.defined()) {
+            debug(1) << "Not software pipelining loop over " << op->name
+                     << " because its body isn't a sequence of stores"
+                     << " containing any loads that can be done early.\n";
+            stmt = For::make(op->name, op->min, op->extent, ForType::Serial, op->device_api, body);
+        }
+        return stmt;
+    }
+
+public:
+    SoftwarePipelineLoops(int max_pipelined_values)
+        : max_pipelined_values(max_pipelined_values) {
+    }
+};
+
 }  // namespace
 
 Stmt loop_carry(Stmt s, int max_carried_values) {
@@ -555,5 +794,9 @@ Stmt loop_carry(Stmt s, int max_carried_values) {
     return s;
 }
 
+Stmt software_pipeline_loops(const Stmt &s, int max_pipelined_values) {
+    return SoftwarePipelineLoops(max_pipelined_values).mutate(s);
+}
+
 }  // namespace Internal
 }  // namespace Halide
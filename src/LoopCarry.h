@@ -14,6 +14,16 @@ namespace Internal {
  * for Hexagon. */
 Stmt loop_carry(Stmt, int max_carried_values = 8);
 
+/** Software pipeline the loops marked as SoftwarePipelined, and
+ * turn them into serial loops. Loads from buffers the loop doesn't
+ * write to are issued one iteration early and stashed in scratch
+ * buffers until the iteration that uses them, so that their latency
+ * overlaps with the work of the previous iteration. This only
+ * applies to loops whose body is a sequence of stores, so it must
+ * run after unrolling and vectorization. At most
+ * max_pipelined_values distinct loads are pipelined per loop. */
+Stmt software_pipeline_loops(const Stmt &s, int max_pipelined_values = 8);
+
 }  // namespace Internal
 }  // namespace Halide
 
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <set>
 #include <sstream>
 
@@ -15,12 +16,14 @@
 #include "BoundsInference.h"
 #include "CSE.h"
 #include "CanonicalizeGPUVars.h"
+#include "CompileProfiler.h"
 #include "Debug.h"
 #include "DebugArguments.h"
 #include "DebugToFile.h"
 #include "Deinterleave.h"
 #include "EarlyFree.h"
 #include "FindCalls.h"
+#include "FindIntrinsics.h"
 #include "Func.h"
 #include "Function.h"
 #include "FuseGPUThreadLoops.h"
@@ -32,11 +35,13 @@
 #include "InferArguments.h"
 #include "InjectHostDevBufferCopies.h"
 #include "InjectOpenGLIntrinsics.h"
+#include "IncrementalLowering.h"
 #include "Inline.h"
 #include "LICM.h"
 #include "LoopCarry.h"
 #include "LowerWarpShuffles.h"
 #include "Memoization.h"
+#include "NontemporalStores.h"
 #include "PartitionLoops.h"
 #include "Prefetch.h"
 #include "Profiling.h"
@@ -77,6 +82,110 @@ using std::ostringstream;
 using std::string;
 using std::vector;
 
+namespace {
+
+/** Records each of a sequence of lowering passes as a phase of
+ * compilation, if compile-time profiling is on. Starting a pass ends
+ * the one before it, and records the size of the Stmt it produced. */
+class LoweringProfile {
+    std::unique_ptr<CompilePhase> current;
+
+public:
+    void next(const char *pass, const Stmt &s) {
+        done(s);
+        if (compile_profiling_enabled()) {
+            current.reset(new CompilePhase(pass, "lowering"));
+        }
+    }
+
+    void done(const Stmt &s) {
+        if (current) {
+            current->record_ir_size(s);
+            current.reset();
+        }
+    }
+};
+
+// The passes that optimize the loop nests once they are in their
+// final form: unrolling, vectorization, loop partitioning, and the
+// simplifications in between.
+Stmt optimize_loop_nests(Stmt s, const Target &t) {
+    LoweringProfile profile;
+
+    profile.next("simplify", s);
+    debug(1) << "Simplifying...\n";
+    s = simplify(s);
+    s = unify_duplicate_lets(s);
+    debug(2) << "Lowering after second simplifcation:\n"
+             << s << "\n\n";
+
+    profile.next("reduce_prefetch_dimension", s);
+    debug(1) << "Reduce prefetch dimension...\n";
+    s = reduce_prefetch_dimension(s, t);
+    debug(2) << "Lowering after reduce prefetch dimension:\n"
+             << s << "\n";
+
+    profile.next("simplify_correlated_differences", s);
+    debug(1) << "Simplifying correlated differences...\n";
+    s = simplify_correlated_differences(s);
+    debug(2) << "Lowering after simplifying correlated differences:\n"
+             << s << "\n";
+
+    profile.next("unroll_loops", s);
+    debug(1) << "Unrolling...\n";
+    s = unroll_loops(s);
+    s = simplify(s);
+    debug(2) << "Lowering after unrolling:\n"
+             << s << "\n\n";
+
+    profile.next("vectorize_loops", s);
+    debug(1) << "Vectorizing...\n";
+    s = vectorize_loops(s, t);
+    s = simplify(s);
+    debug(2) << "Lowering after vectorizing:\n"
+             << s << "\n\n";
+
+    if (t.has_gpu_feature() ||
+        t.has_feature(Target::OpenGLCompute)) {
+        profile.next("fuse_gpu_thread_loops", s);
+        debug(1) << "Injecting per-block gpu synchronization...\n";
+        s = fuse_gpu_thread_loops(s);
+        debug(2) << "Lowering after injecting per-block gpu synchronization:\n"
+                 << s << "\n\n";
+    }
+
+    profile.next("rewrite_interleavings", s);
+    debug(1) << "Detecting vector interleavings...\n";
+    s = rewrite_interleavings(s);
+    s = simplify(s);
+    debug(2) << "Lowering after rewriting vector interleavings:\n"
+             << s << "\n\n";
+
+    profile.next("partition_loops", s);
+    debug(1) << "Partitioning loops to simplify boundary conditions...\n";
+    s = partition_loops(s);
+    s = simplify(s);
+    debug(2) << "Lowering after partitioning loops:\n"
+             << s << "\n\n";
+
+    profile.next("trim_no_ops", s);
+    debug(1) << "Trimming loops to the region over which they do something...\n";
+    s = trim_no_ops(s);
+    debug(2) << "Lowering after loop trimming:\n"
+             << s << "\n\n";
+
+    profile.next("software_pipeline_loops", s);
+    debug(1) << "Software pipelining loops...\n";
+    s = software_pipeline_loops(s);
+    debug(2) << "Lowering after software pipelining:\n"
+             << s << "\n\n";
+
+    profile.done(s);
+    return s;
+}
+
+}  // namespace
+
 Module lower(const vector<Function> &output_funcs,
              const string &pipeline_name,
              const Target &t,
@@ -85,6 +194,20 @@ Module lower(const vector<Function> &output_funcs,
              const vector<Stmt> &requirements,
              bool trace_pipeline,
              const vector<IRMutator *> &custom_passes) {
+    CompilePhase lowering("lower " + pipeline_name, "lowering");
+    LoweringProfile profile;
+
+    // The simplifier's cache refers to the images, parameters and
+    // Functions of this pipeline, so empty it once lowering is done.
+    struct ClearSimplifyCache {
+        ~ClearSimplifyCache() {
+            clear_simplify_cache();
+        }
+    } clear_simplify_cache_when_done;
+    profile.next("prepare_functions", Stmt());
+
+    static const bool hash_cons_ir = get_env_variable("HL_HASH_CONS_IR") == "1";
+
     std::vector<std::string> namespaces;
     std::string simple_pipeline_name = extract_namespaces(pipeline_name, namespaces);
 
@@ -126,6 +249,7 @@ Module lower(const vector<Function> &output_funcs,
     // specializations' conditions
     simplify_specializations(env);
 
+    profile.next("schedule_functions", Stmt());
     debug(1) << "Creating initial loop nests...\n";
     bool any_memoized = false;
     Stmt s = schedule_functions(outputs, fused_groups, env, t, any_memoized);
@@ -133,6 +257,7 @@ Module lower(const vector<Function> &output_funcs,
              << s << "\n";
 
     if (any_memoized) {
+        profile.next("inject_memoization", s);
         debug(1) << "Injecting memoization...\n";
         s = inject_memoization(s, env, pipeline_name, outputs);
         debug(2) << "Lowering after injecting memoization:\n"
@@ -141,11 +266,13 @@ Module lower(const vector<Function> &output_funcs,
         debug(1) << "Skipping injecting memoization...\n";
     }
 
+    profile.next("inject_tracing", s);
     debug(1) << "Injecting tracing...\n";
     s = inject_tracing(s, pipeline_name, trace_pipeline, env, outputs, t);
     debug(2) << "Lowering after injecting tracing:\n"
              << s << "\n";
 
+    profile.next("add_parameter_checks", s);
     debug(1) << "Adding checks for parameters\n";
     s = add_parameter_checks(requirements, s, t);
     debug(2) << "Lowering after injecting parameter checks:\n"
@@ -153,6 +280,7 @@ Module lower(const vector<Function> &output_funcs,
 
     // Compute the maximum and minimum possible value of each
     // function. Used in later bounds inference passes.
+    profile.next("compute_function_value_bounds", s);
     debug(1) << "Computing bounds of each function's value\n";
     FuncValueBounds func_bounds = compute_function_value_bounds(order, env);
 
@@ -165,6 +293,7 @@ Module lower(const vector<Function> &output_funcs,
 
     // The checks will be in terms of the symbols defined by bounds
     // inference.
+    profile.next("add_image_checks", s);
     debug(1) << "Adding checks for images\n";
     s = add_image_checks(s, outputs, t, order, env, func_bounds, will_inject_host_copies);
     debug(2) << "Lowering after injecting image checks:\n"
@@ -173,31 +302,37 @@ Module lower(const vector<Function> &output_funcs,
     // This pass injects nested definitions of variable names, so we
     // can't simplify statements from here until we fix them up. (We
     // can still simplify Exprs).
+    profile.next("bounds_inference", s);
     debug(1) << "Performing computation bounds inference...\n";
     s = bounds_inference(s, outputs, order, fused_groups, env, func_bounds, t);
     debug(2) << "Lowering after computation bounds inference:\n"
              << s << "\n";
 
+    profile.next("remove_extern_loops", s);
     debug(1) << "Removing extern loops...\n";
     s = remove_extern_loops(s);
     debug(2) << "Lowering after removing extern loops:\n"
              << s << "\n";
 
+    profile.next("sliding_window", s);
     debug(1) << "Performing sliding window optimization...\n";
     s = sliding_window(s, env);
     debug(2) << "Lowering after sliding window:\n"
              << s << "\n";
 
+    profile.next("simplify_correlated_differences", s);
     debug(1) << "Simplifying correlated differences...\n";
     s = simplify_correlated_differences(s);
     debug(2) << "Lowering after simplifying correlated differences:\n"
              << s << "\n";
 
+    profile.next("allocation_bounds_inference", s);
     debug(1) << "Performing allocation bounds inference...\n";
     s = allocation_bounds_inference(s, env, func_bounds);
     debug(2) << "Lowering after allocation bounds inference:\n"
              << s << "\n";
 
+    profile.next("remove_undef", s);
     debug(1) << "Removing code that depends on undef values...\n";
     s = remove_undef(s);
     debug(2) << "Lowering after removing code that depends on undef values:\n"
@@ -206,46 +341,55 @@ Module lower(const vector<Function> &output_funcs,
     // This uniquifies the variable names, so we're good to simplify
     // after this point. This lets later passes assume syntactic
     // equivalence means semantic equivalence.
+    profile.next("uniquify_variable_names", s);
     debug(1) << "Uniquifying variable names...\n";
     s = uniquify_variable_names(s);
     debug(2) << "Lowering after uniquifying variable names:\n"
              << s << "\n\n";
 
+    profile.next("simplify", s);
     debug(1) << "Simplifying...\n";
     s = simplify(s, false);  // Storage folding needs .loop_max symbols
     debug(2) << "Lowering after first simplification:\n"
              << s << "\n\n";
 
+    profile.next("storage_folding", s);
     debug(1) << "Performing storage folding optimization...\n";
     s = storage_folding(s, env);
     debug(2) << "Lowering after storage folding:\n"
              << s << "\n";
 
+    profile.next("debug_to_file", s);
     debug(1) << "Injecting debug_to_file calls...\n";
     s = debug_to_file(s, outputs, env);
     debug(2) << "Lowering after injecting debug_to_file calls:\n"
              << s << "\n";
 
+    profile.next("inject_prefetch", s);
     debug(1) << "Injecting prefetches...\n";
     s = inject_prefetch(s, env);
     debug(2) << "Lowering after injecting prefetches:\n"
              << s << "\n\n";
 
+    profile.next("lower_safe_promises", s);
     debug(1) << "Discarding safe promises...\n";
     s = lower_safe_promises(s);
     debug(2) << "Lowering after discarding safe promises:\n"
              << s << "\n\n";
 
+    profile.next("skip_stages", s);
     debug(1) << "Dynamically skipping stages...\n";
     s = skip_stages(s, order);
     debug(2) << "Lowering after dynamically skipping stages:\n"
              << s << "\n\n";
 
+    profile.next("fork_async_producers", s);
     debug(1) << "Forking asynchronous producers...\n";
     s = fork_async_producers(s, env);
     debug(2) << "Lowering after forking asynchronous producers:\n"
              << s << "\n";
 
+    profile.next("split_tuples", s);
     debug(1) << "Destructuring tuple-valued realizations...\n";
     s = split_tuples(s, env);
     debug(2) << "Lowering after destructuring tuple-valued realizations:\n"
@@ -256,28 +400,33 @@ Module lower(const vector<Function> &output_funcs,
     if (t.has_gpu_feature() ||
         t.has_feature(Target::OpenGLCompute) ||
         t.has_feature(Target::OpenGL)) {
+        profile.next("canonicalize_gpu_vars", s);
         debug(1) << "Canonicalizing GPU var names...\n";
         s = canonicalize_gpu_vars(s);
         debug(2) << "Lowering after canonicalizing GPU var names:\n"
                  << s << "\n";
     }
 
+    profile.next("storage_flattening", s);
     debug(1) << "Performing storage flattening...\n";
     s = storage_flattening(s, outputs, env, t);
     debug(2) << "Lowering after storage flattening:\n"
              << s << "\n\n";
 
+    profile.next("add_atomic_mutex", s);
     debug(1) << "Adding atomic mutex allocation...\n";
     s = add_atomic_mutex(s, env);
     debug(2) << "Lowering after adding atomic mutex allocation:\n"
              << s << "\n\n";
 
+    profile.next("unpack_buffers", s);
     debug(1) << "Unpacking buffer arguments...\n";
     s = unpack_buffers(s);
     debug(2) << "Lowering after unpacking buffer arguments...\n"
              << s << "\n\n";
 
     if (any_memoized) {
+        profile.next("rewrite_memoized_allocations", s);
         debug(1) << "Rewriting memoized allocations...\n";
         s = rewrite_memoized_allocations(s, env);
         debug(2) << "Lowering after rewriting memoized allocations:\n"
@@ -287,16 +436,19 @@ Module lower(const vector<Function> &output_funcs,
     }
 
     if (will_inject_host_copies) {
+        profile.next("select_gpu_api", s);
         debug(1) << "Selecting a GPU API for GPU loops...\n";
         s = select_gpu_api(s, t);
         debug(2) << "Lowering after selecting a GPU API:\n"
                  << s << "\n\n";
 
+        profile.next("inject_host_dev_buffer_copies", s);
         debug(1) << "Injecting host <-> dev buffer copies...\n";
         s = inject_host_dev_buffer_copies(s, t);
         debug(2) << "Lowering after injecting host <-> dev buffer copies:\n"
                  << s << "\n\n";
 
+        profile.next("select_gpu_api", s);
         debug(1) << "Selecting a GPU API for extern stages...\n";
         s = select_gpu_api(s, t);
         debug(2) << "Lowering after selecting a GPU API for extern stages:\n"
@@ -304,88 +456,49 @@ Module lower(const vector<Function> &output_funcs,
     }
 
     if (t.has_feature(Target::OpenGL)) {
+        profile.next("inject_opengl_intrinsics", s);
         debug(1) << "Injecting OpenGL texture intrinsics...\n";
         s = inject_opengl_intrinsics(s);
         debug(2) << "Lowering after OpenGL intrinsics:\n"
                  << s << "\n\n";
     }
 
-    debug(1) << "Simplifying...\n";
-    s = simplify(s);
-    s = unify_duplicate_lets(s);
-    debug(2) << "Lowering after second simplifcation:\n"
-             << s << "\n\n";
-
-    debug(1) << "Reduce prefetch dimension...\n";
-    s = reduce_prefetch_dimension(s, t);
-    debug(2) << "Lowering after reduce prefetch dimension:\n"
-             << s << "\n";
-
-    debug(1) << "Simplifying correlated differences...\n";
-    s = simplify_correlated_differences(s);
-    debug(2) << "Lowering after simplifying correlated differences:\n"
-             << s << "\n";
-
-    debug(1) << "Unrolling...\n";
-    s = unroll_loops(s);
-    s = simplify(s);
-    debug(2) << "Lowering after unrolling:\n"
-             << s << "\n\n";
-
-    debug(1) << "Vectorizing...\n";
-    s = vectorize_loops(s, t);
-    s = simplify(s);
-    debug(2) << "Lowering after vectorizing:\n"
-             << s << "\n\n";
-
-    if (t.has_gpu_feature() ||
-        t.has_feature(Target::OpenGLCompute)) {
-        debug(1) << "Injecting per-block gpu synchronization...\n";
-        s = fuse_gpu_thread_loops(s);
-        debug(2) << "Lowering after injecting per-block gpu synchronization:\n"
-                 << s << "\n\n";
-    }
-
-    debug(1) << "Detecting vector interleavings...\n";
-    s = rewrite_interleavings(s);
-    s = simplify(s);
-    debug(2) << "Lowering after rewriting vector interleavings:\n"
-             << s << "\n\n";
-
-    debug(1) << "Partitioning loops to simplify boundary conditions...\n";
-    s = partition_loops(s);
-    s = simplify(s);
-    debug(2) << "Lowering after partitioning loops:\n"
-             << s << "\n\n";
-
-    debug(1) << "Trimming loops to the region over which they do something...\n";
-    s = trim_no_ops(s);
-    debug(2) << "Lowering after loop trimming:\n"
-             << s << "\n\n";
+    profile.next("optimize_loop_nests", s);
+    // Producers that haven't changed since a previous lowering can
+    // skip these passes if incremental lowering is on, and the
+    // producers are optimized concurrently if parallel lowering is on.
+    s = lower_incrementally(s, t, "optimize_loop_nests", [&](const Stmt &s) {
+        return optimize_loop_nests(s, t);
+    });
 
+    profile.next("inject_early_frees", s);
     debug(1) << "Injecting early frees...\n";
     s = inject_early_frees(s);
     debug(2) << "Lowering after injecting early frees:\n"
              << s << "\n\n";
 
     if (t.has_feature(Target::FuzzFloatStores)) {
+        profile.next("fuzz_float_stores", s);
         debug(1) << "Fuzzing floating point stores...\n";
         s = fuzz_float_stores(s);
         debug(2) << "Lowering after fuzzing floating point stores:\n"
                  << s << "\n\n";
     }
 
+    profile.next("simplify_correlated_differences", s);
     debug(1) << "Simplifying correlated differences...\n";
     s = simplify_correlated_differences(s);
     debug(2) << "Lowering after simplifying correlated differences:\n"
              << s << "\n";
 
+    profile.next("bound_small_allocations", s);
     debug(1) << "Bounding small allocations...\n";
     s = bound_small_allocations(s);
     debug(2) << "Lowering after bounding small allocations:\n"
              << s << "\n\n";
 
     if (t.has_feature(Target::Profile)) {
+        profile.next("inject_profiling", s);
         debug(1) << "Injecting profiling...\n";
         s = inject_profiling(s, pipeline_name);
         debug(2) << "Lowering after injecting profiling:\n"
@@ -393,39 +506,65 @@ Module lower(const vector<Function> &output_funcs,
     }
 
     if (t.has_feature(Target::CUDA)) {
+        profile.next("lower_warp_shuffles", s);
         debug(1) << "Injecting warp shuffles...\n";
         s = lower_warp_shuffles(s);
         debug(2) << "Lowering after injecting warp shuffles:\n"
                  << s << "\n\n";
     }
 
+    profile.next("cse_across_statements", s);
+    debug(1) << "Lifting common subexpressions out of blocks...\n";
+    s = cse_across_statements(s);
+    debug(2) << "Lowering after lifting common subexpressions out of blocks:\n"
+             << s << "\n\n";
+
+    profile.next("common_subexpression_elimination", s);
     debug(1) << "Simplifying...\n";
     s = common_subexpression_elimination(s);
 
     if (t.has_feature(Target::OpenGL)) {
+        profile.next("find_linear_expressions", s);
         debug(1) << "Detecting varying attributes...\n";
         s = find_linear_expressions(s);
         debug(2) << "Lowering after detecting varying attributes:\n"
                  << s << "\n\n";
 
+        profile.next("setup_gpu_vertex_buffer", s);
         debug(1) << "Moving varying attribute expressions out of the shader...\n";
         s = setup_gpu_vertex_buffer(s);
         debug(2) << "Lowering after removing varying attributes:\n"
                  << s << "\n\n";
     }
 
+    profile.next("lower_unsafe_promises", s);
     debug(1) << "Lowering unsafe promises...\n";
     s = lower_unsafe_promises(s, t);
     debug(2) << "Lowering after lowering unsafe promises:\n"
              << s << "\n\n";
 
+    profile.next("final_simplification", s);
     s = remove_dead_allocations(s);
     s = simplify(s);
     s = loop_invariant_code_motion(s);
     debug(1) << "Lowering after final simplification:\n"
              << s << "\n\n";
 
+    profile.next("inject_nontemporal_stores", s);
+    debug(1) << "Injecting non-temporal stores...\n";
+    s = inject_nontemporal_stores(s, env);
+    debug(2) << "Lowering after injecting non-temporal stores:\n"
+             << s << "\n\n";
+
+    if (hash_cons_ir) {
+        // The final Stmt outlives lowering in the Module, so share
+        // the nodes of equal Exprs before handing it over.
+        profile.next("hash_cons", s);
+        s = hash_cons(s);
+    }
+
     if (t.arch != Target::Hexagon && (t.features_any_of({Target::HVX_64, Target::HVX_128}))) {
+        profile.next("inject_hexagon_rpc", s);
         debug(1) << "Splitting off Hexagon offload...\n";
         s = inject_hexagon_rpc(s, t, result_module);
         debug(2) << "Lowering after splitting off Hexagon offload:\n"
@@ -436,6 +575,7 @@ Module lower(const vector<Function> &output_funcs,
 
     if (!custom_passes.empty()) {
         for (size_t i = 0; i < custom_passes.size(); i++) {
+            profile.next("custom_pass", s);
             debug(1) << "Running custom lowering pass " << i << "...\n";
             s = custom_passes[i]->mutate(s);
             debug(1) << "Lowering after custom pass " << i << ":\n"
@@ -443,6 +583,16 @@ Module lower(const vector<Function> &output_funcs,
         }
     }
 
+    if (t.arch != Target::Hexagon) {
+        profile.next("find_intrinsics", s);
+        debug(1) << "Finding fixed-point intrinsics...\n";
+        s = find_intrinsics(s);
+        debug(2) << "Lowering after finding fixed-point intrinsics:\n"
+                 << s << "\n\n";
+    }
+
+    profile.done(s);
+
     vector<Argument> public_args = args;
     for (const auto &out : outputs) {
         for (Parameter buf : out.output_buffers()) {
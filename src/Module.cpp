@@ -8,6 +8,7 @@
 #include "CodeGen_C.h"
 #include "CodeGen_Internal.h"
 #include "CodeGen_PyTorch.h"
+#include "CompileProfiler.h"
 #include "Debug.h"
 #include "HexagonOffload.h"
 #include "IROperator.h"
@@ -42,6 +43,7 @@ std::map<Output, OutputInfo> get_output_info(const Target &target) {
         {Output::bitcode, {"bitcode", ".bc"}},
         {Output::c_header, {"c_header", ".h"}},
         {Output::c_source, {"c_source", ".halide_generated.cpp"}},
+        {Output::compile_profile, {"compile_profile", ".compile_profile.json"}},
         {Output::cpp_stub, {"cpp_stub", ".stub.h"}},
         {Output::featurization, {"featurization", ".featurization"}},
         {Output::llvm_assembly, {"llvm_assembly", ".ll"}},
@@ -548,6 +550,8 @@ std::map<std::string, std::string> Module::get_metadata_name_map() const {
 void Module::compile(const std::map<Output, std::string> &output_files) const {
     validate_outputs(output_files);
 
+    Internal::CompileProfilingScope profiling(contains(output_files, Output::compile_profile));
+
     // output stmt and html prior to resolving submodules. We need to
     // clear the output after writing it, otherwise the output will
     // be overwritten by recursive calls after submodules are resolved.
@@ -675,6 +679,13 @@ void Module::compile(const std::map<Output, std::string> &output_files) const {
         Internal::CodeGen_PyTorch cg(file);
         cg.compile(*this);
     }
+    // This goes last, so that it includes the time spent producing
+    // all the other outputs.
+    if (contains(output_files, Output::compile_profile)) {
+        debug(1) << "Module.compile(): compile_profile " << output_files.at(Output::compile_profile) << "\n";
+        std::ofstream file(output_files.at(Output::compile_profile));
+        Internal::write_compile_profile(file);
+    }
 }
 
 std::map<Output, std::string> compile_standalone_runtime(const std::map<Output, std::string> &output_files, Target t) {
@@ -713,6 +724,8 @@ void compile_multitarget(const std::string &fn_name,
     // it up front.
     user_assert(!contains(output_files, Output::object)) << "Cannot request object for compile_multitarget.\n";
 
+    Internal::CompileProfilingScope profiling(contains(output_files, Output::compile_profile));
+
     // The final target in the list is considered "baseline", and is used
     // for (e.g.) the runtime and shared code. It is often just os-arch-bits
     // with no other features (though this is *not* a requirement).
@@ -798,6 +811,7 @@ void compile_multitarget(const std::string &fn_name,
         ;
         sub_out.erase(Output::schedule);
         ;
+        sub_out.erase(Output::compile_profile);
         debug(1) << "compile_multitarget: compile_sub_target " << sub_out[Output::object] << "\n";
         sub_module.compile(sub_out);
         auto *r = sub_module.get_auto_scheduler_results();
@@ -960,6 +974,12 @@ void compile_multitarget(const std::string &fn_name,
         debug(1) << "compile_multitarget: static_library " << output_files.at(Output::static_library) << "\n";
         create_static_library(temp_dir.files(), base_target, output_files.at(Output::static_library));
     }
+
+    if (contains(output_files, Output::compile_profile)) {
+        debug(1) << "compile_multitarget: compile_profile " << output_files.at(Output::compile_profile) << "\n";
+        std::ofstream file(output_files.at(Output::compile_profile));
+        Internal::write_compile_profile(file);
+    }
 }
 
 }  // namespace Halide
@@ -29,6 +29,7 @@ enum class Output {
     bitcode,
     c_header,
     c_source,
+    compile_profile,
     cpp_stub,
     featurization,
     llvm_assembly,
@@ -0,0 +1,150 @@
+#include "NontemporalStores.h"
+#include "Function.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+
+#include <set>
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+bool is_semaphore_release(const Stmt &s) {
+    const Evaluate *e = s.as<Evaluate>();
+    const Call *c = e ? e->value.as<Call>() : nullptr;
+    return c && c->name == "halide_semaphore_release";
+}
+
+void flatten_blocks(const Stmt &s, vector<Stmt> &stmts) {
+    if (const Block *b = s.as<Block>()) {
+        flatten_blocks(b->first, stmts);
+        flatten_blocks(b->rest, stmts);
+    } else {
+        stmts.push_back(s);
+    }
+}
+
+class InjectNontemporalStores : public IRMutator {
+    using IRMutator::visit;
+
+    // The names of the buffers to write with non-temporal stores.
+    const set<string> &buffers;
+
+    // Whether we're inside a loop that runs on a device.
+    bool on_device = false;
+
+    // Whether any stores have been marked in the Stmt being mutated.
+    bool marked = false;
+
+    Stmt fence() const {
+        return Evaluate::make(Call::make(Int(32), Call::store_fence, {}, Call::Intrinsic));
+    }
+
+    Stmt visit(const Store *op) override {
+        const Ramp *ramp = op->index.as<Ramp>();
+        if (on_device ||
+            !buffers.count(op->name) ||
+            !ramp || !is_one(ramp->stride) ||
+            !is_one(op->predicate)) {
+            return IRMutator::visit(op);
+        }
+        marked = true;
+        Expr value = Call::make(op->value.type(), Call::nontemporal_store, {op->value}, Call::Intrinsic);
+        return Store::make(op->name, value, op->index, op->param, op->predicate, op->alignment);
+    }
+
+    Stmt visit(const For *op) override {
+        bool old_on_device = on_device;
+        bool old_marked = marked;
+        on_device = on_device || (op->device_api != DeviceAPI::None &&
+                                  op->device_api != DeviceAPI::Host);
+        marked = false;
+
+        Stmt body = mutate(op->body);
+
+        // The tasks of a parallel loop may run on other threads, so
+        // each one must fence its own stores.
+        if (marked && op->for_type == ForType::Parallel) {
+            body = Block::make(body, fence());
+        }
+
+        on_device = old_on_device;
+        marked = marked || old_marked;
+
+        if (body.same_as(op->body)) {
+            return op;
+        } else {
+            return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        }
+    }
+
+    Stmt visit(const ProducerConsumer *op) override {
+        if (!op->is_producer) {
+            return IRMutator::visit(op);
+        }
+
+        bool old_marked = marked;
+        marked = false;
+
+        Stmt body = mutate(op->body);
+        if (marked) {
+            // The produce body of an async Func ends by releasing the
+            // semaphores that tell its consumer the data is ready, so
+            // the stores must be fenced before those.
+            vector<Stmt> stmts;
+            flatten_blocks(body, stmts);
+            auto it = stmts.end();
+            while (it != stmts.begin() && is_semaphore_release(*(it - 1))) {
+                it--;
+            }
+            stmts.insert(it, fence());
+            body = Block::make(stmts);
+        }
+
+        marked = marked || old_marked;
+
+        if (body.same_as(op->body)) {
+            return op;
+        } else {
+            return ProducerConsumer::make(op->name, op->is_producer, body);
+        }
+    }
+
+public:
+    InjectNontemporalStores(const set<string> &b)
+        : buffers(b) {
+    }
+};
+
+}  // namespace
+
+Stmt inject_nontemporal_stores(const Stmt &s, const map<string, Function> &env) {
+    set<string> buffers;
+    for (const auto &p : env) {
+        const Function &f = p.second;
+        if (!f.schedule().nontemporal_stores()) {
+            continue;
+        }
+        if (f.outputs() == 1) {
+            buffers.insert(f.name());
+        } else {
+            for (int i = 0; i < f.outputs(); i++) {
+                buffers.insert(f.name() + "." + std::to_string(i));
+            }
+        }
+    }
+
+    if (buffers.empty()) {
+        return s;
+    }
+    return InjectNontemporalStores(buffers).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,30 @@
+#ifndef HALIDE_NONTEMPORAL_STORES_H
+#define HALIDE_NONTEMPORAL_STORES_H
+
+/** \file
+ * Defines the lowering pass that marks the stores to Funcs scheduled
+ * with Func::store_nontemporal, and injects the fences they need.
+ */
+
+#include <map>
+#include <string>
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** Mark the dense, unpredicated vector stores done on the host to
+ * Funcs scheduled with store_nontemporal, by wrapping their values in
+ * the nontemporal_store intrinsic. Non-temporal stores are weakly
+ * ordered, so a store_fence is added at the end of the production of
+ * each such Func, and at the end of the body of each parallel loop
+ * that contains any of its stores. Must run after vectorization. */
+Stmt inject_nontemporal_stores(const Stmt &s, const std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -676,7 +676,9 @@ class PartitionLoops : public IRMutator {
 
         Stmt stmt;
         // Bust simple serial for loops up into three.
-        if (op->for_type == ForType::Serial && !op->body.as<Acquire>()) {
+        if ((op->for_type == ForType::Serial ||
+             op->for_type == ForType::SoftwarePipelined) &&
+            !op->body.as<Acquire>()) {
             stmt = For::make(op->name, min_steady, max_steady - min_steady,
                              op->for_type, op->device_api, simpler_body);
 
@@ -1,8 +1,13 @@
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <mutex>
 #include <utility>
 
 #include "Argument.h"
 #include "AutoSchedule.h"
+#include "CompileProfiler.h"
 #include "FindCalls.h"
 #include "Func.h"
 #include "IRVisitor.h"
@@ -49,6 +54,24 @@ std::map<Output, std::string> static_library_outputs(const string &filename_pref
     return outputs;
 }
 
+// Copy a module that has had its submodules resolved, but for a
+// target that compiles quickly rather than well.
+Module with_fast_compile(const Module &m) {
+    internal_assert(m.submodules().empty());
+    Module result(m.name(), m.target().with_feature(Target::LLVMFastCompile));
+    for (const auto &f : m.functions()) {
+        result.append(f);
+    }
+    for (const auto &buf : m.buffers()) {
+        result.append(buf);
+    }
+    for (const auto &ec : m.external_code()) {
+        result.append(ec);
+    }
+    result.set_any_strict_float(m.any_strict_float());
+    return result;
+}
+
 }  // namespace
 
 struct PipelineContents {
@@ -67,10 +90,52 @@ struct PipelineContents {
     // Cached compiled JavaScript and/or wasm if defined */
     WasmModule wasm_module;
 
+    // When jit compiling in tiers, the optimized code still being
+    // compiled on a background thread, and the quickly compiled code
+    // it replaced. The latter is kept alive in case another thread is
+    // still running it.
+    std::future<JITModule> optimized_jit_module;
+    JITModule fast_jit_module;
+    std::mutex jit_tier_mutex;
+
+    // Held while compiling this pipeline, so that threads realizing
+    // it at the same time (e.g. from Python, as the bindings release
+    // the GIL) don't race to compile it, or to update the cached
+    // state above. Different pipelines may compile at the same time.
+    std::recursive_mutex compile_mutex;
+
+    /** The compiled code to use for a call. A call must use a single
+     * snapshot of it throughout, as another thread may switch to the
+     * optimized tier at any time. */
+    JITModule current_jit_module() {
+        std::lock_guard<std::mutex> lock(jit_tier_mutex);
+        return jit_module;
+    }
+
+    /** If optimized code is being compiled in the background, switch
+     * to it, waiting for it to finish only if wait is true. */
+    void use_optimized_jit_module(bool wait) {
+        std::lock_guard<std::mutex> lock(jit_tier_mutex);
+        if (!optimized_jit_module.valid() ||
+            (!wait &&
+             optimized_jit_module.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+            return;
+        }
+        fast_jit_module = jit_module;
+        jit_module = optimized_jit_module.get();
+        debug(2) << "Switched to optimized jit module for " << jit_target << "\n";
+    }
+
     /** Clear all cached state */
     void invalidate_cache() {
+        {
+            // Blocks until any background compilation is done.
+            std::lock_guard<std::mutex> lock(jit_tier_mutex);
+            optimized_jit_module = std::future<JITModule>();
+            fast_jit_module = JITModule();
+            jit_module = JITModule();
+        }
         module = Module("", Target());
-        jit_module = JITModule();
         jit_target = Target();
         inferred_args.clear();
         wasm_module = WasmModule();
@@ -160,6 +225,11 @@ Pipeline::Pipeline(const vector<Func> &outputs)
     }
 }
 
+Pipeline::Pipeline(const vector<Func> &outputs, const vector<Stmt> &requirements)
+    : Pipeline(outputs) {
+    contents->requirements = requirements;
+}
+
 vector<Func> Pipeline::outputs() const {
     vector<Func> funcs;
     for (const Function &f : contents->outputs) {
@@ -262,6 +332,8 @@ void Pipeline::compile_to(const std::map<Output, std::string> &output_files,
                           const vector<Argument> &args,
                           const string &fn_name,
                           const Target &target) {
+    // Profile lowering too, not just the outputs.
+    CompileProfilingScope profiling(output_files.count(Output::compile_profile) != 0);
     compile_to_module(args, fn_name, target).compile(output_files);
 }
 
@@ -444,6 +516,8 @@ Module Pipeline::compile_to_module(const vector<Argument> &args,
                                    const LinkageType linkage_type) {
     user_assert(defined()) << "Can't compile undefined Pipeline.\n";
 
+    std::lock_guard<std::recursive_mutex> lock(contents->compile_mutex);
+
     for (Function f : contents->outputs) {
         user_assert(f.has_pure_definition() || f.has_extern_definition())
             << "Can't compile Pipeline with undefined output Func: " << f.name() << ".\n";
@@ -523,7 +597,28 @@ std::string Pipeline::generate_function_name() const {
 }
 
 void Pipeline::compile_jit(const Target &target_arg) {
+    compile_jit(target_arg, false);
+}
+
+void Pipeline::compile_jit_tiered(const Target &target_arg) {
+    compile_jit(target_arg, true);
+}
+
+void Pipeline::wait_for_optimized_jit() {
     user_assert(defined()) << "Pipeline is undefined\n";
+    contents->use_optimized_jit_module(true);
+}
+
+bool Pipeline::optimized_jit_pending() const {
+    user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_tier_mutex);
+    return contents->optimized_jit_module.valid();
+}
+
+void Pipeline::compile_jit(const Target &target_arg, bool tiered) {
+    user_assert(defined()) << "Pipeline is undefined\n";
+
+    std::lock_guard<std::recursive_mutex> compile_lock(contents->compile_mutex);
 
     Target target(target_arg);
     target.set_feature(Target::JIT);
@@ -541,9 +636,10 @@ void Pipeline::compile_jit(const Target &target_arg) {
                 return;
             }
         }
-        if (contents->jit_module.compiled()) {
+        if (contents->current_jit_module().compiled()) {
             debug(2) << "Reusing old jit module compiled for :\n"
                      << contents->jit_target << "\n";
+            contents->use_optimized_jit_module(false);
             return;
         }
     }
@@ -601,9 +697,25 @@ void Pipeline::compile_jit(const Target &target_arg) {
     }
 
     auto f = module.get_function_by_name(name);
+    std::vector<JITModule> externs_jit_module = make_externs_jit_module(target_arg, lowered_externs);
+
+    if (tiered) {
+        // Compile quickly now, and compile the same lowered module
+        // again with full optimization in the background. Nothing
+        // here refers back to the contents, which wait for the
+        // background compilation before they are cleared, so the
+        // background compilation needs no lock.
+        JITModule fast(with_fast_compile(module), f, externs_jit_module);
+        std::lock_guard<std::mutex> tier_lock(contents->jit_tier_mutex);
+        contents->jit_module = fast;
+        contents->optimized_jit_module = std::async(std::launch::async, [=]() {
+            return JITModule(module, f, externs_jit_module);
+        });
+        return;
+    }
 
     // Compile to jit module
-    JITModule jit_module(module, f, make_externs_jit_module(target_arg, lowered_externs));
+    JITModule jit_module(module, f, externs_jit_module);
 
     // Dump bitcode to a file if the environment variable
     // HL_GENBITCODE is defined to a nonzero value.
@@ -617,6 +729,7 @@ void Pipeline::compile_jit(const Target &target_arg) {
         module.compile({{Output::bitcode, file_name}});
     }
 
+    std::lock_guard<std::mutex> lock(contents->jit_tier_mutex);
     contents->jit_module = jit_module;
 }
 
@@ -789,6 +902,11 @@ void Pipeline::add_requirement(const Expr &condition, std::vector<Expr> &error_a
     contents->requirements.emplace_back(Internal::AssertStmt::make(condition, error));
 }
 
+const vector<Stmt> &Pipeline::requirements() const {
+    user_assert(defined()) << "Pipeline is undefined\n";
+    return contents->requirements;
+}
+
 void Pipeline::trace_pipeline() {
     user_assert(defined()) << "Pipeline is undefined\n";
     contents->trace_pipeline = true;
@@ -891,6 +1009,23 @@ struct JITFuncCallContext {
     }
 };
 
+// If we're profiling, report runtimes and reset profiler stats.
+void report_jit_profile(const JITModule &module, const Target &target, JITUserContext *uc) {
+    if (target.has_feature(Target::Profile)) {
+        JITModule::Symbol report_sym =
+            module.find_symbol_by_name("halide_profiler_report");
+        JITModule::Symbol reset_sym =
+            module.find_symbol_by_name("halide_profiler_reset");
+        if (report_sym.address && reset_sym.address) {
+            void (*report_fn_ptr)(void *) = (void (*)(void *))(report_sym.address);
+            report_fn_ptr(uc);
+
+            void (*reset_fn_ptr)() = (void (*)())(reset_sym.address);
+            reset_fn_ptr();
+        }
+    }
+}
+
 }  // namespace
 
 struct Pipeline::JITCallArgs {
@@ -930,10 +1065,6 @@ void Pipeline::prepare_jit_call_arguments(RealizationArg &outputs, const Target
                                           bool is_bounds_inference, JITCallArgs &args_result) {
     user_assert(defined()) << "Can't realize an undefined Pipeline\n";
 
-    JITModule &compiled_module = contents->jit_module;
-    internal_assert(compiled_module.argv_function() ||
-                    contents->wasm_module.contents.defined());
-
     const bool no_param_map = &param_map == &ParamMap::empty_map();
 
     // Come up with the void * arguments to pass to the argv function
@@ -1009,9 +1140,10 @@ Pipeline::make_externs_jit_module(const Target &target,
             // Ensure that the pipeline is compiled.
             pipeline.compile_jit(target);
 
-            free_standing_jit_externs.add_dependency(pipeline_contents.jit_module);
-            free_standing_jit_externs.add_symbol_for_export(iter->first, pipeline_contents.jit_module.entrypoint_symbol());
-            void *address = pipeline_contents.jit_module.entrypoint_symbol().address;
+            JITModule pipeline_jit_module = pipeline_contents.current_jit_module();
+            free_standing_jit_externs.add_dependency(pipeline_jit_module);
+            free_standing_jit_externs.add_symbol_for_export(iter->first, pipeline_jit_module.entrypoint_symbol());
+            void *address = pipeline_jit_module.entrypoint_symbol().address;
             std::vector<Type> arg_types;
             // Add the arguments to the compiled pipeline
             for (const InferredArgument &arg : pipeline_contents.inferred_args) {
@@ -1038,7 +1170,7 @@ Pipeline::make_externs_jit_module(const Target &target,
     return result;
 }
 
-int Pipeline::call_jit_code(const Target &target, const JITCallArgs &args) {
+int Pipeline::call_jit_code(const Target &target, const JITModule &jit_module, const JITCallArgs &args) {
 #if defined(__has_feature)
 #if __has_feature(memory_sanitizer)
     user_warning << "MSAN does not support JIT compilers of any sort, and will report "
@@ -1051,7 +1183,8 @@ int Pipeline::call_jit_code(const Target &target, const JITCallArgs &args) {
         internal_assert(contents->wasm_module.contents.defined());
         return contents->wasm_module.run(args.store);
     }
-    return contents->jit_module.argv_function()(args.store);
+    internal_assert(jit_module.argv_function());
+    return jit_module.argv_function()(args.store);
 }
 
 void Pipeline::realize(RealizationArg outputs, const Target &t,
@@ -1064,7 +1197,7 @@ void Pipeline::realize(RealizationArg outputs, const Target &t,
     // If target is unspecified...
     if (target.os == Target::OSUnknown) {
         // If we've already jit-compiled for a specific target, use that.
-        if (contents->jit_module.compiled()) {
+        if (contents->current_jit_module().compiled()) {
             target = contents->jit_target;
         } else {
             // Otherwise get the target from the environment
@@ -1096,6 +1229,7 @@ void Pipeline::realize(RealizationArg outputs, const Target &t,
 
     // Ensure the module is compiled.
     compile_jit(target);
+    JITModule jit_module = contents->current_jit_module();
 
     // This has to happen after a runtime has been compiled in compile_jit.
     JITFuncCallContext jit_context(jit_handlers());
@@ -1143,35 +1277,295 @@ void Pipeline::realize(RealizationArg outputs, const Target &t,
     // exception.
 
     debug(2) << "Calling jitted function\n";
-    int exit_status = call_jit_code(target, args);
+    int exit_status = call_jit_code(target, jit_module, args);
     debug(2) << "Back from jitted function. Exit status was " << exit_status << "\n";
 
-    // If we're profiling, report runtimes and reset profiler stats.
-    if (target.has_feature(Target::Profile)) {
-        JITModule::Symbol report_sym =
-            contents->jit_module.find_symbol_by_name("halide_profiler_report");
-        JITModule::Symbol reset_sym =
-            contents->jit_module.find_symbol_by_name("halide_profiler_reset");
-        if (report_sym.address && reset_sym.address) {
-            void *uc = &jit_context.jit_context;
-            void (*report_fn_ptr)(void *) = (void (*)(void *))(report_sym.address);
-            report_fn_ptr(uc);
+    report_jit_profile(jit_module, target, &jit_context.jit_context);
 
-            void (*reset_fn_ptr)() = (void (*)())(reset_sym.address);
-            reset_fn_ptr();
+    jit_context.finalize(exit_status);
+}
+
+struct PendingRealization::Contents {
+    // Keeps the compiled code alive.
+    JITModule jit_module;
+    Target target;
+    JITFuncCallContext jit_context;
+    void *user_context_storage;
+    std::unique_ptr<Pipeline::JITCallArgs> args;
+    // Keeps the outputs and input buffers alive.
+    std::vector<Buffer<>> outputs, inputs;
+    // Copies of the scalar arguments, which the args point to instead
+    // of the Params or the ParamMap.
+    std::vector<halide_scalar_value_t> scalars;
+    std::function<void(int)> on_complete;
+    int (*argv_function)(const void **);
+    int exit_status{0};
+
+    // The runtime functions that manage the handle.
+    halide_async_pipeline_t *handle{nullptr};
+    int (*wait_fn)(halide_async_pipeline_t *){nullptr};
+    bool (*poll_fn)(halide_async_pipeline_t *, int *){nullptr};
+    void (*release_fn)(halide_async_pipeline_t *){nullptr};
+
+    Contents(const JITModule &m, const Target &t, const JITHandlers &handlers)
+        : jit_module(m), target(t), jit_context(handlers) {
+        user_context_storage = &jit_context.jit_context;
+    }
+
+    // Runs on a thread pool thread. The runtime passes through the
+    // args pointer without looking at it, so we use it for the
+    // Contents.
+    static int run(void **args) {
+        Contents *c = (Contents *)args;
+        c->exit_status = c->argv_function(c->args->store);
+        if (c->on_complete) {
+            c->on_complete(c->exit_status);
         }
+        return c->exit_status;
+    }
+
+    ~Contents() {
+        if (handle) {
+            release_fn(handle);
+        }
+    }
+};
+
+bool PendingRealization::ready() const {
+    user_assert(defined()) << "PendingRealization is undefined\n";
+    return !contents->handle || contents->poll_fn(contents->handle, nullptr);
+}
+
+void PendingRealization::wait() {
+    user_assert(defined()) << "PendingRealization is undefined\n";
+    if (!contents->handle) {
+        return;
     }
+    int exit_status = contents->wait_fn(contents->handle);
+    contents->release_fn(contents->handle);
+    contents->handle = nullptr;
+    debug(2) << "Asynchronous realization finished. Exit status was " << exit_status << "\n";
+
+    report_jit_profile(contents->jit_module, contents->target,
+                       &contents->jit_context.jit_context);
+
+    contents->jit_context.finalize(exit_status);
+}
+
+PendingRealization Pipeline::realize_async(RealizationArg outputs, const Target &t,
+                                           const ParamMap &param_map,
+                                           std::function<void(int)> on_complete) {
+    Target target = t;
+    user_assert(defined()) << "Can't realize an undefined Pipeline\n";
+
+    debug(2) << "Realizing Pipeline asynchronously for " << target << "\n";
+
+    // Pick the target the same way realize does.
+    if (target.os == Target::OSUnknown) {
+        if (contents->current_jit_module().compiled()) {
+            target = contents->jit_target;
+        } else {
+            target = get_jit_target_from_environment();
+        }
+    }
+    user_assert(target.arch != Target::WebAssembly)
+        << "realize_async is not supported for WebAssembly targets\n";
+
+    compile_jit(target);
+
+    PendingRealization result;
+    result.contents = std::make_shared<PendingRealization::Contents>(contents->current_jit_module(), target, jit_handlers());
+    PendingRealization::Contents &c = *result.contents;
+
+    const JITModule &module = c.jit_module;
+    JITModule::Symbol start_sym = module.find_symbol_by_name("halide_start_pipeline_async");
+    JITModule::Symbol wait_sym = module.find_symbol_by_name("halide_async_pipeline_wait");
+    JITModule::Symbol poll_sym = module.find_symbol_by_name("halide_async_pipeline_poll");
+    JITModule::Symbol release_sym = module.find_symbol_by_name("halide_async_pipeline_release");
+    internal_assert(start_sym.address && wait_sym.address && poll_sym.address && release_sym.address)
+        << "JIT runtime is missing the asynchronous pipeline functions\n";
+    c.wait_fn = (int (*)(halide_async_pipeline_t *))wait_sym.address;
+    c.poll_fn = (bool (*)(halide_async_pipeline_t *, int *))poll_sym.address;
+    c.release_fn = (void (*)(halide_async_pipeline_t *))release_sym.address;
+
+    if (outputs.r) {
+        for (size_t i = 0; i < outputs.r->size(); i++) {
+            c.outputs.push_back((*outputs.r)[i]);
+        }
+    } else if (outputs.buffer_list) {
+        c.outputs = *outputs.buffer_list;
+    }
+
+    c.args.reset(new JITCallArgs(contents->inferred_args.size() + outputs.size()));
+    prepare_jit_call_arguments(outputs, target, param_map,
+                               &c.user_context_storage, false, *c.args);
+
+    // The scalar args point at values owned by the Params or the
+    // ParamMap, which may change or go away before the pipeline
+    // runs, so point them at copies instead. Input buffers passed in
+    // the ParamMap are kept alive the same way as the outputs.
+    c.scalars.resize(contents->inferred_args.size());
+    for (size_t i = 0; i < contents->inferred_args.size(); i++) {
+        const InferredArgument &arg = contents->inferred_args[i];
+        if (!arg.param.defined() || arg.param.same_as(contents->user_context_arg.param)) {
+            continue;
+        }
+        Buffer<> *buf_out_param = nullptr;
+        const Parameter &p = param_map.map(arg.param, buf_out_param);
+        if (p.is_buffer()) {
+            if (p.buffer().defined()) {
+                c.inputs.push_back(p.buffer());
+            }
+        } else {
+            memcpy(&c.scalars[i], c.args->store[i], p.type().bytes());
+            c.args->store[i] = &c.scalars[i];
+        }
+    }
+    c.argv_function = module.argv_function();
+    c.on_complete = std::move(on_complete);
+
+    typedef halide_async_pipeline_t *(*start_fn_t)(void *, int (*)(void **), void **, void (*)(void *, int));
+    start_fn_t start_fn = (start_fn_t)start_sym.address;
+    c.handle = start_fn(&c.jit_context.jit_context, PendingRealization::Contents::run, (void **)&c, nullptr);
+    user_assert(c.handle) << "Failed to start asynchronous realization\n";
+
+    return result;
+}
+
+struct Callable::Contents {
+    Target target;
+    // The arguments, then one per output buffer. Excludes the user context.
+    std::vector<Argument> args;
+    JITHandlers handlers;
+    JITModule jit_module;
+    int (*argv_function)(const void **){nullptr};
+};
+
+const std::vector<Argument> &Callable::arguments() const {
+    user_assert(defined()) << "Callable is undefined\n";
+    return contents->args;
+}
+
+void Callable::check_arg_count(size_t argc) const {
+    user_assert(defined()) << "Can't call an undefined Callable\n";
+    user_assert(argc == contents->args.size())
+        << "Callable expects " << contents->args.size()
+        << " arguments (including outputs) but was called with " << argc << "\n";
+}
+
+void Callable::check_arg_is_buffer(size_t i) const {
+    const Argument &a = contents->args[i];
+    user_assert(a.is_buffer())
+        << "Argument " << i << " of Callable (" << a.name << ") is a scalar of type "
+        << a.type << " but was passed a buffer\n";
+}
+
+void Callable::check_arg_type(size_t i, const Type &t) const {
+    const Argument &a = contents->args[i];
+    user_assert(a.is_scalar() && a.type == t)
+        << "Argument " << i << " of Callable (" << a.name << ") "
+        << (a.is_scalar() ? "has type " : "is a buffer of type ") << a.type
+        << " but was passed a scalar of type " << t << "\n";
+}
+
+int Callable::call_argv(size_t argc, const void *const *argv) const {
+    check_arg_count(argc);
+    const size_t kFixedArgs = 16;
+    const void *fixed_store[kFixedArgs];
+    std::vector<const void *> dynamic_store;
+    const void **store = fixed_store;
+    if (argc + 1 > kFixedArgs) {
+        dynamic_store.resize(argc + 1);
+        store = dynamic_store.data();
+    }
+    for (size_t i = 0; i < argc; i++) {
+        store[i + 1] = argv[i];
+    }
+    return call_argv_with_user_context(argc, store);
+}
+
+int Callable::call_argv_with_user_context(size_t argc, const void **argv) const {
+    // All per-call state lives on the stack, so concurrent calls
+    // don't interfere with each other.
+    JITFuncCallContext jit_context(contents->handlers);
+    void *user_context_storage = &jit_context.jit_context;
+    argv[0] = &user_context_storage;
+
+    int exit_status = contents->argv_function(argv);
+
+    report_jit_profile(contents->jit_module, contents->target, &jit_context.jit_context);
 
     jit_context.finalize(exit_status);
+    return exit_status;
+}
+
+Callable::Callable(const Module &module_arg, const std::string &fn_name) {
+    const Target &target = module_arg.target();
+    user_assert(target.has_feature(Target::JIT) && target.has_feature(Target::UserContext))
+        << "A Callable can only be made from a Module compiled for a target with the jit and user_context features\n";
+    user_assert(target.arch != Target::WebAssembly)
+        << "Callables are not supported for WebAssembly targets\n";
+
+    Module module = module_arg.resolve_submodules();
+    auto f = module.get_function_by_name(fn_name);
+    user_assert(!f.args.empty() && f.args[0].name == "__user_context")
+        << "The function " << fn_name << " does not take a user context as its first argument\n";
+
+    contents = std::make_shared<Contents>();
+    contents->target = target;
+    contents->jit_module = JITModule(module, f, {});
+    contents->argv_function = contents->jit_module.argv_function();
+    contents->args.assign(f.args.begin() + 1, f.args.end());
+}
+
+Callable Pipeline::compile_to_callable(const std::vector<Argument> &args, const Target &target_arg) {
+    user_assert(defined()) << "Pipeline is undefined\n";
+
+    Target target(target_arg);
+    target.set_feature(Target::JIT);
+    target.set_feature(Target::UserContext);
+    user_assert(target.arch != Target::WebAssembly)
+        << "compile_to_callable is not supported for WebAssembly targets\n";
+
+    debug(2) << "Compiling callable for: " << target << "\n";
+
+    for (const Argument &arg : args) {
+        user_assert(arg.name != contents->user_context_arg.arg.name)
+            << "The user context is supplied by the Callable, and may not be one of its arguments\n";
+    }
+
+    string name = generate_function_name();
+    Module module = compile_to_module(args, name, target).resolve_submodules();
+
+    std::map<std::string, JITExtern> lowered_externs = contents->jit_externs;
+    auto f = module.get_function_by_name(name);
+
+    Callable result;
+    result.contents = std::make_shared<Callable::Contents>();
+    Callable::Contents &c = *result.contents;
+    c.target = target;
+    c.handlers = contents->jit_handlers;
+    std::vector<JITModule> externs_jit_module = make_externs_jit_module(target_arg, lowered_externs);
+    c.jit_module = JITModule(module, f, externs_jit_module);
+    c.argv_function = c.jit_module.argv_function();
+
+    // The compiled function takes the user context first, then the
+    // arguments, then the outputs.
+    internal_assert(f.args.size() > args.size() &&
+                    f.args[0].name == contents->user_context_arg.arg.name);
+    c.args.assign(f.args.begin() + 1, f.args.end());
+
+    return result;
 }
 
 void Pipeline::infer_input_bounds(RealizationArg outputs, const ParamMap &param_map) {
-    if (!contents->jit_module.compiled() ||
+    if (!contents->current_jit_module().compiled() ||
         contents->jit_target.has_feature(Target::NoBoundsQuery)) {
         Target target = get_jit_target_from_environment();
         target.set_feature(Target::NoBoundsQuery, false);
         compile_jit(target);
     }
+    JITModule jit_module = contents->current_jit_module();
 
     // This has to happen after a runtime has been compiled in compile_jit.
     JITFuncCallContext jit_context(jit_handlers());
@@ -1221,7 +1615,7 @@ void Pipeline::infer_input_bounds(RealizationArg outputs, const ParamMap &param_
         }
 
         Internal::debug(2) << "Calling jitted function\n";
-        int exit_status = call_jit_code(contents->jit_target, args);
+        int exit_status = call_jit_code(contents->jit_target, jit_module, args);
         jit_context.report_if_error(exit_status);
         Internal::debug(2) << "Back from jitted function\n";
         bool changed = false;
@@ -10,6 +10,7 @@
 #include <map>
 #include <vector>
 
+#include "Argument.h"
 #include "ExternalCode.h"
 #include "IROperator.h"
 #include "IntrusivePtr.h"
@@ -22,7 +23,6 @@
 
 namespace Halide {
 
-struct Argument;
 class Func;
 struct PipelineContents;
 
@@ -90,6 +90,114 @@ struct AutoSchedulerResults {
 
 class Pipeline;
 
+/** A handle to a realization started with Pipeline::realize_async,
+ * which runs on the thread pool of the JIT runtime. Destroying the
+ * last copy of a handle waits for the realization to finish, but
+ * does not report errors. */
+class PendingRealization {
+    struct Contents;
+    std::shared_ptr<Contents> contents;
+
+    friend class Pipeline;
+
+public:
+    PendingRealization() = default;
+
+    /** Check if this handle refers to a realization. */
+    bool defined() const {
+        return contents != nullptr;
+    }
+
+    /** Check whether the realization has finished, without blocking. */
+    bool ready() const;
+
+    /** Wait for the realization to finish. The calling thread helps
+     * out with the thread pool while it waits. Errors are reported as
+     * they would have been by Pipeline::realize. Does nothing if the
+     * realization has already been waited on. */
+    void wait();
+};
+
+/** A Pipeline compiled once for a fixed argument list, which can be
+ * called directly with the values of those arguments followed by the
+ * output buffers. Calls skip the Param, ParamMap, and compilation
+ * bookkeeping that Pipeline::realize does on every call, and the
+ * object is immutable, so it may be called from many threads at once
+ * without locking. Copies share the same compiled code. Made with
+ * Pipeline::compile_to_callable. Not supported for WebAssembly. */
+class Callable {
+    struct Contents;
+    std::shared_ptr<Contents> contents;
+
+    friend class Pipeline;
+
+    // Call with argv[0] reserved for the user context.
+    int call_argv_with_user_context(size_t argc, const void **argv) const;
+
+    void check_arg_is_buffer(size_t i) const;
+    void check_arg_type(size_t i, const Type &t) const;
+
+    const void *make_arg(size_t i, halide_buffer_t *buf) const {
+        check_arg_is_buffer(i);
+        return buf;
+    }
+    template<typename T, int D>
+    const void *make_arg(size_t i, const Runtime::Buffer<T, D> &buf) const {
+        check_arg_is_buffer(i);
+        return buf.raw_buffer();
+    }
+    template<typename T>
+    const void *make_arg(size_t i, const Buffer<T> &buf) const {
+        check_arg_is_buffer(i);
+        return buf.raw_buffer();
+    }
+    template<typename T,
+             typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    const void *make_arg(size_t i, const T &value) const {
+        check_arg_type(i, type_of<T>());
+        return &value;
+    }
+
+    void check_arg_count(size_t argc) const;
+
+public:
+    Callable() = default;
+
+    /** Compile a Callable directly from a lowered Module, such as one
+     * returned by deserialize_module, skipping lowering. The Module's
+     * target must have the JIT and UserContext features, and fn_name
+     * must name one of its functions. */
+    Callable(const Module &module, const std::string &fn_name);
+
+    /** Check if this object has been compiled. */
+    bool defined() const {
+        return contents != nullptr;
+    }
+
+    /** The arguments this was compiled for, in order, followed by one
+     * OutputBuffer argument per output buffer. */
+    const std::vector<Argument> &arguments() const;
+
+    /** Run the pipeline. Takes one value per argument, in order:
+     * scalars by value (which must match the type of the argument
+     * exactly), and buffers as Buffer, Runtime::Buffer, or
+     * halide_buffer_t *. Returns the exit status of the pipeline;
+     * errors are reported as they would have been by
+     * Pipeline::realize. */
+    template<typename... Args>
+    HALIDE_NO_USER_CODE_INLINE int operator()(Args &&... args) const {
+        check_arg_count(sizeof...(Args));
+        size_t i = 0;
+        const void *argv[sizeof...(Args) + 1] = {nullptr, make_arg(i++, args)...};
+        return call_argv_with_user_context(sizeof...(Args), argv);
+    }
+
+    /** Run the pipeline with an argv-style list of arguments in the
+     * same order as operator(): pointers to scalar values, and
+     * halide_buffer_t pointers for buffers. Types are not checked. */
+    int call_argv(size_t argc, const void *const *argv) const;
+};
+
 using AutoSchedulerFn = std::function<void(const Pipeline &, const Target &, const MachineParams &, AutoSchedulerResults *outputs)>;
 
 /** A class representing a Halide pipeline. Constructed from the Func
@@ -157,7 +265,9 @@ private:
 
     static AutoSchedulerFn find_autoscheduler(const std::string &autoscheduler_name);
 
-    int call_jit_code(const Target &target, const JITCallArgs &args);
+    int call_jit_code(const Target &target, const Internal::JITModule &jit_module, const JITCallArgs &args);
+
+    friend class PendingRealization;
 
 public:
     /** Make an undefined Pipeline object. */
@@ -171,6 +281,11 @@ public:
      * outputs. Schedules the Funcs compute_root(). */
     Pipeline(const std::vector<Func> &outputs);
 
+    /** Make a pipeline that computes the given Funcs as outputs, and
+     * checks the given requirements (as made by add_requirement)
+     * before computing them. */
+    Pipeline(const std::vector<Func> &outputs, const std::vector<Internal::Stmt> &requirements);
+
     std::vector<Argument> infer_arguments(const Internal::Stmt &body);
 
     /** Get the Funcs this pipeline outputs. */
@@ -328,6 +443,36 @@ public:
      */
     void compile_jit(const Target &target = get_jit_target_from_environment());
 
+    /** Eagerly jit compile the function in two tiers. Code compiled
+     * with minimal LLVM optimization (see Target::LLVMFastCompile) is
+     * ready when this returns, and fully optimized code is compiled
+     * on a background thread. Calls to realize use the quickly
+     * compiled code until the optimized code is ready, and then
+     * switch to it. Anything that would make compile_jit recompile
+     * the pipeline (e.g. a different target or changed jit externs)
+     * discards both tiers. Not supported for WebAssembly, where this
+     * is the same as compile_jit. */
+    void compile_jit_tiered(const Target &target = get_jit_target_from_environment());
+
+    /** If the optimized tier of a compile_jit_tiered call is still
+     * compiling, block until it is done and switch to it. Otherwise
+     * does nothing. */
+    void wait_for_optimized_jit();
+
+    /** Check whether the optimized tier of a compile_jit_tiered call
+     * has yet to be switched to, either because it is still
+     * compiling, or because nothing has used the compiled code since
+     * it finished. */
+    bool optimized_jit_pending() const;
+
+    /** Compile the pipeline for the given arguments, in order, and
+     * return an object that calls it directly. Constant images not in
+     * the list are embedded in the compiled code. Unlike compile_jit,
+     * the result is independent of later changes to this Pipeline's
+     * schedule or handlers. */
+    Callable compile_to_callable(const std::vector<Argument> &args,
+                                 const Target &target = get_jit_target_from_environment());
+
     /** Set the error handler function that be called in the case of
      * runtime errors during halide pipelines. If you are compiling
      * statically, you can also just define your own function with
@@ -492,6 +637,19 @@ public:
     void realize(RealizationArg output, const Target &target = Target(),
                  const ParamMap &param_map = ParamMap::empty_map());
 
+    /** Start evaluating this Pipeline into an existing allocated
+     * buffer or buffers on the thread pool, and return without
+     * waiting for it to finish. The values of scalar params are
+     * captured when it starts, and the input and output buffers are
+     * kept alive until it finishes, but the contents of the input
+     * buffers must not be changed until then. If
+     * on_complete is set, it is called on a thread pool thread with
+     * the exit status of the pipeline once it finishes, and must not
+     * throw. Not supported for WebAssembly. */
+    PendingRealization realize_async(RealizationArg output, const Target &target = Target(),
+                                     const ParamMap &param_map = ParamMap::empty_map(),
+                                     std::function<void(int)> on_complete = nullptr);
+
     /** For a given size of output, or a given set of output buffers,
      * determine the bounds required of all unbound ImageParams
      * referenced. Communicates the result by allocating new buffers
@@ -541,8 +699,14 @@ public:
         add_requirement(condition, collected_args);
     }
 
+    /** Get the requirements added with add_requirement, as assert
+     * statements, in the order they were added. */
+    const std::vector<Internal::Stmt> &requirements() const;
+
 private:
     std::string generate_function_name() const;
+
+    void compile_jit(const Target &target, bool tiered);
 };
 
 struct ExternSignature {
@@ -95,19 +95,19 @@ std::pair<string, string> print_type(const LoweredArgument *arg) {
     }
 }
 
-void PythonExtensionGen::convert_buffer(const string &name, const LoweredArgument *arg) {
+void PythonExtensionGen::convert_buffer(const string &name, const LoweredArgument *arg, const string &cleanup) {
     internal_assert(arg->is_buffer());
     internal_assert(arg->dimensions);
-    dest << "    halide_buffer_t buffer_" << name << ";\n";
-    dest << "    halide_dimension_t dimensions_" << name << "[" << (int)arg->dimensions << "];\n";
     dest << "    if (_convert_py_buffer_to_halide(";
     dest << /*pyobj*/ "py_" << name << ", ";
     dest << /*dimensions*/ (int)arg->dimensions << ", ";
     dest << /*flags*/ (arg->is_output() ? "PyBUF_WRITABLE" : "0") << ", ";
     dest << /*dim*/ "dimensions_" << name << ", ";
     dest << /*out*/ "&buffer_" << name << ", ";
-    dest << /*name*/ "\"" << name << "\"";
+    dest << /*name*/ "\"" << name << "\", ";
+    dest << /*owner*/ "&owner_" << name;
     dest << ") < 0) {\n";
+    dest << cleanup;
     dest << "        return NULL;\n";
     dest << "    }\n";
 }
@@ -145,6 +145,246 @@ void PythonExtensionGen::compile(const Module &module) {
 extern "C" {
 #endif
 
+/* The subset of DLPack (https://github.com/dmlc/dlpack) needed to
+ * import tensors that live in host memory. */
+typedef struct {
+    int32_t device_type;
+    int32_t device_id;
+} _halide_dl_device_t;
+
+typedef struct {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+} _halide_dl_data_type_t;
+
+typedef struct {
+    void* data;
+    _halide_dl_device_t device;
+    int32_t ndim;
+    _halide_dl_data_type_t dtype;
+    int64_t* shape;
+    int64_t* strides;
+    uint64_t byte_offset;
+} _halide_dl_tensor_t;
+
+typedef struct _halide_dl_managed_tensor_t {
+    _halide_dl_tensor_t dl_tensor;
+    void* manager_ctx;
+    void (*deleter)(struct _halide_dl_managed_tensor_t*);
+} _halide_dl_managed_tensor_t;
+
+/* Whatever must stay alive while Halide uses a converted buffer. */
+typedef struct {
+    Py_buffer view;
+    int has_view;
+    _halide_dl_managed_tensor_t* dlpack;
+} _halide_py_buffer_owner_t;
+
+static
+#if !defined(_MSC_VER)
+__attribute__((unused))
+#endif
+void _release_py_buffer(_halide_py_buffer_owner_t* owner) {
+    if (owner->has_view) {
+        PyBuffer_Release(&owner->view);
+        owner->has_view = 0;
+    }
+    if (owner->dlpack) {
+        if (owner->dlpack->deleter) {
+            owner->dlpack->deleter(owner->dlpack);
+        }
+        owner->dlpack = NULL;
+    }
+}
+
+/* Fill in Halide dimensions from a shape and strides (in elements),
+ * given outermost-first as Python does. Unless the array is Fortran
+ * ordered (first dimension varies the fastest), the dimensions are
+ * reversed, so that the innermost one becomes dimension 0 and we can
+ * process it without having to reallocate. Strides may be negative. */
+static int _fill_halide_dimensions(
+        int ndim, const int64_t* shape, const int64_t* strides,
+        halide_dimension_t* dim, const char* name) {
+    int fortran_order = 1;
+    int64_t expected_stride = 1;
+    int i;
+    for (i = 0; i < ndim; i++) {
+        if (shape[i] > 1 && strides[i] != expected_stride) {
+            fortran_order = 0;
+        }
+        expected_stride *= shape[i];
+    }
+    for (i = 0; i < ndim; i++) {
+        int j = fortran_order ? i : ndim - 1 - i;
+        if (shape[j] > INT_MAX || strides[j] > INT_MAX || strides[j] < -INT_MAX) {
+            PyErr_Format(PyExc_ValueError, "Invalid argument %s: dimension %d is too large", name, j);
+            return -1;
+        }
+        dim[i].min = 0;
+        dim[i].extent = (int)shape[j];
+        dim[i].stride = (int)strides[j];
+        dim[i].flags = 0;
+    }
+    return 0;
+}
+
+static int _set_halide_type(halide_buffer_t* out, char kind, int bytes, const char* name) {
+    if (kind == 'f') {
+        out->type.code = halide_type_float;
+    } else if (kind == 'i') {
+        out->type.code = halide_type_int;
+    } else if (kind == 'u' || kind == 'b') {
+        out->type.code = halide_type_uint;
+    } else {
+        PyErr_Format(PyExc_ValueError, "Invalid data type for %s", name);
+        return -1;
+    }
+    out->type.bits = (kind == 'b') ? 1 : (uint8_t)(bytes * 8);
+    out->type.lanes = 1;
+    return 0;
+}
+
+/* Import a tensor through the DLPack protocol (e.g. from PyTorch). */
+static int _convert_dlpack_to_halide(
+        PyObject* pyobj, int dimensions,
+        halide_dimension_t* dim, halide_buffer_t* out, const char* name,
+        _halide_py_buffer_owner_t* owner) {
+    PyObject* capsule = PyObject_CallMethod(pyobj, "__dlpack__", NULL);
+    if (!capsule) {
+        return -1;
+    }
+    _halide_dl_managed_tensor_t* managed =
+        (_halide_dl_managed_tensor_t*)PyCapsule_GetPointer(capsule, "dltensor");
+    if (!managed) {
+        Py_DECREF(capsule);
+        return -1;
+    }
+    /* We now own the tensor, and must call its deleter when done. */
+    PyCapsule_SetName(capsule, "used_dltensor");
+    Py_DECREF(capsule);
+    owner->dlpack = managed;
+
+    const _halide_dl_tensor_t* t = &managed->dl_tensor;
+    /* kDLCPU and kDLCPUPinned */
+    if (t->device.device_type != 1 && t->device.device_type != 3) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: only tensors in host memory are supported", name);
+        return -1;
+    }
+    if (t->ndim != dimensions) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: Expected %d dimensions, got %d",
+                     name, dimensions, (int)t->ndim);
+        return -1;
+    }
+    /* kDLInt, kDLUInt, kDLFloat */
+    static const char kinds[] = {'i', 'u', 'f'};
+    if (t->dtype.code > 2 || t->dtype.lanes != 1 || t->dtype.bits % 8) {
+        PyErr_Format(PyExc_ValueError, "Invalid data type for %s", name);
+        return -1;
+    }
+    int64_t strides[16];
+    int i;
+    if (t->ndim > 16) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: too many dimensions", name);
+        return -1;
+    }
+    if (t->strides) {
+        for (i = 0; i < t->ndim; i++) {
+            strides[i] = t->strides[i];
+        }
+    } else {
+        /* Compact and row-major. */
+        int64_t stride = 1;
+        for (i = t->ndim - 1; i >= 0; i--) {
+            strides[i] = stride;
+            stride *= t->shape[i];
+        }
+    }
+    *out = halide_buffer_t();
+    if (_set_halide_type(out, kinds[t->dtype.code], t->dtype.bits / 8, name) < 0 ||
+        _fill_halide_dimensions(t->ndim, t->shape, strides, dim, name) < 0) {
+        return -1;
+    }
+    out->dimensions = t->ndim;
+    out->dim = dim;
+    out->host = (uint8_t*)t->data + t->byte_offset;
+    return 0;
+}
+
+/* Import an array through the NumPy array interface, for objects that
+ * don't implement the buffer protocol. */
+static int _convert_array_interface_to_halide(
+        PyObject* pyobj, int dimensions, int flags,
+        halide_dimension_t* dim, halide_buffer_t* out, const char* name) {
+    PyObject* iface = PyObject_GetAttrString(pyobj, "__array_interface__");
+    if (!iface) {
+        return -1;
+    }
+    int ret = -1;
+    PyObject* shape = PyDict_GetItemString(iface, "shape");
+    PyObject* typestr = PyDict_GetItemString(iface, "typestr");
+    PyObject* data = PyDict_GetItemString(iface, "data");
+    PyObject* strides = PyDict_GetItemString(iface, "strides");
+    const char* ts = typestr && PyUnicode_Check(typestr) ? PyUnicode_AsUTF8(typestr) : NULL;
+    int64_t shape_v[16], strides_v[16];
+    int ndim = shape && PyTuple_Check(shape) ? (int)PyTuple_Size(shape) : -1;
+    int bytes, i;
+    void* host;
+    if (!ts || strlen(ts) < 3 || ts[0] == '>' || ndim < 0 || ndim > 16 ||
+        !data || !PyTuple_Check(data) || PyTuple_Size(data) != 2) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: unsupported __array_interface__", name);
+        goto done;
+    }
+    if (ndim != dimensions) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: Expected %d dimensions, got %d",
+                     name, dimensions, ndim);
+        goto done;
+    }
+    if ((flags & PyBUF_WRITABLE) && PyObject_IsTrue(PyTuple_GetItem(data, 1))) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: array is read-only", name);
+        goto done;
+    }
+    bytes = atoi(ts + 2);
+    *out = halide_buffer_t();
+    if (bytes <= 0 || _set_halide_type(out, ts[1], bytes, name) < 0) {
+        if (!PyErr_Occurred()) {
+            PyErr_Format(PyExc_ValueError, "Invalid data type for %s: %s", name, ts);
+        }
+        goto done;
+    }
+    for (i = 0; i < ndim; i++) {
+        shape_v[i] = PyLong_AsLongLong(PyTuple_GetItem(shape, i));
+    }
+    if (strides && strides != Py_None) {
+        for (i = 0; i < ndim; i++) {
+            int64_t s = PyLong_AsLongLong(PyTuple_GetItem(strides, i));
+            if (s % bytes) {
+                PyErr_Format(PyExc_ValueError, "Invalid argument %s: misaligned strides", name);
+                goto done;
+            }
+            strides_v[i] = s / bytes;
+        }
+    } else {
+        int64_t stride = 1;
+        for (i = ndim - 1; i >= 0; i--) {
+            strides_v[i] = stride;
+            stride *= shape_v[i];
+        }
+    }
+    host = PyLong_AsVoidPtr(PyTuple_GetItem(data, 0));
+    if (PyErr_Occurred() ||
+        _fill_halide_dimensions(ndim, shape_v, strides_v, dim, name) < 0) {
+        goto done;
+    }
+    out->dimensions = ndim;
+    out->dim = dim;
+    out->host = (uint8_t*)host;
+    ret = 0;
+done:
+    Py_DECREF(iface);
+    return ret;
+}
+
 static
 #if !defined(_MSC_VER)
 __attribute__((unused))
@@ -152,90 +392,76 @@ __attribute__((unused))
 int _convert_py_buffer_to_halide(
         PyObject* pyobj, int dimensions, int flags,
         halide_dimension_t* dim,  // array of size `dimensions`
-        halide_buffer_t* out, const char* name) {
-    Py_buffer buf;
-    int ret = PyObject_GetBuffer(
-      pyobj, &buf, PyBUF_FORMAT | PyBUF_STRIDED_RO | PyBUF_ANY_CONTIGUOUS | flags);
+        halide_buffer_t* out, const char* name,
+        _halide_py_buffer_owner_t* owner) {
+    if (!PyObject_CheckBuffer(pyobj)) {
+        if (PyObject_HasAttrString(pyobj, "__dlpack__")) {
+            return _convert_dlpack_to_halide(pyobj, dimensions, dim, out, name, owner);
+        }
+        if (PyObject_HasAttrString(pyobj, "__array_interface__")) {
+            return _convert_array_interface_to_halide(pyobj, dimensions, flags, dim, out, name);
+        }
+    }
+    Py_buffer* buf = &owner->view;
+    int ret = PyObject_GetBuffer(pyobj, buf, PyBUF_FORMAT | PyBUF_STRIDES | flags);
     if (ret < 0) {
       return ret;
     }
-    if (dimensions && buf.ndim != dimensions) {
+    owner->has_view = 1;
+    if (dimensions && buf->ndim != dimensions) {
       PyErr_Format(PyExc_ValueError, "Invalid argument %s: Expected %d dimensions, got %d",
-                   name, dimensions, buf.ndim);
+                   name, dimensions, buf->ndim);
       return -1;
     }
-    /* We'll get a buffer that's either:
-     * C_CONTIGUOUS (last dimension varies the fastest, i.e., has stride=1) or
-     * F_CONTIGUOUS (first dimension varies the fastest, i.e., has stride=1).
-     * The latter is preferred, since it's already in the format that Halide
-     * needs. It can can be achieved in numpy by passing order='F' during array
-     * creation. However, if we do get a C_CONTIGUOUS buffer, flip the dimensions
-     * (transpose) so we can process it without having to reallocate.
-     */
-    int i, j, j_step;
-    if (PyBuffer_IsContiguous(&buf, 'F')) {
-      j = 0;
-      j_step = 1;
-    } else if (PyBuffer_IsContiguous(&buf, 'C')) {
-      j = buf.ndim - 1;
-      j_step = -1;
-    } else {
-      /* Python checks all dimensions and strides, so this typically indicates
-       * a bug in the array's buffer protocol. */
-      PyErr_Format(PyExc_ValueError, "Invalid buffer: neither C nor Fortran contiguous");
-      return -1;
+    if (buf->suboffsets) {
+        // Halide doesn't support arrays of pointers. But we should never see this
+        // anyway, since we didn't ask for PyBUF_INDIRECT.
+        PyErr_Format(PyExc_ValueError, "Invalid buffer: suboffsets not supported");
+        return -1;
     }
-    for (i = 0; i < buf.ndim; ++i, j += j_step) {
-        dim[i].min = 0;
-        dim[i].stride = (int)(buf.strides[j] / buf.itemsize); // strides is in bytes
-        dim[i].extent = (int)buf.shape[j];
-        dim[i].flags = 0;
-        if (buf.suboffsets && buf.suboffsets[i] >= 0) {
-            // Halide doesn't support arrays of pointers. But we should never see this
-            // anyway, since we specified PyBUF_STRIDED.
-            PyErr_Format(PyExc_ValueError, "Invalid buffer: suboffsets not supported");
+    if (buf->ndim > 16) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: too many dimensions", name);
+        return -1;
+    }
+    int64_t shape[16], strides[16];
+    int i;
+    for (i = 0; i < buf->ndim; ++i) {
+        if (buf->strides[i] % buf->itemsize) {
+            PyErr_Format(PyExc_ValueError, "Invalid argument %s: misaligned strides", name);
             return -1;
         }
-    }
-    if (dim[buf.ndim - 1].extent * dim[buf.ndim - 1].stride * buf.itemsize != buf.len) {
-        PyErr_Format(PyExc_ValueError, "Invalid buffer: length %ld, but computed length %ld",
-                     buf.len, buf.shape[0] * buf.strides[0]);
-        return -1;
+        shape[i] = buf->shape[i];
+        strides[i] = buf->strides[i] / buf->itemsize;  // strides is in bytes
     }
     *out = halide_buffer_t();
-    if (!buf.format) {
+    if (!buf->format) {
         out->type.code = halide_type_uint;
         out->type.bits = 8;
+        out->type.lanes = 1;
     } else {
         /* Convert struct type code. See
          * https://docs.python.org/2/library/struct.html#module-struct */
-        char* p = buf.format;
+        char* p = buf->format;
         while (strchr("@<>!=", *p)) {
             p++;  // ignore little/bit endian (and alignment)
         }
-        if (*p == 'f' || *p == 'd') {
-            // 'f' and 'd' are float and double, respectively.
-            out->type.code = halide_type_float;
-        } else if (*p >= 'a' && *p <= 'z') {
-            // lowercase is signed int.
-            out->type.code = halide_type_int;
-        } else {
-            // uppercase is unsigned int.
-            out->type.code = halide_type_uint;
-        }
         const char* type_codes = "bB?hHiIlLqQfd";  // integers and floats
-        if (strchr(type_codes, *p)) {
-            out->type.bits = (uint8_t)buf.itemsize * 8;
-        } else {
+        if (!strchr(type_codes, *p)) {
             // We don't handle 's' and 'p' (char[]) and 'P' (void*)
-            PyErr_Format(PyExc_ValueError, "Invalid data type for %s: %s", name, buf.format);
+            PyErr_Format(PyExc_ValueError, "Invalid data type for %s: %s", name, buf->format);
             return -1;
         }
+        // 'f' and 'd' are float and double, respectively; lowercase is
+        // signed int, and uppercase is unsigned int.
+        char kind = (*p == 'f' || *p == 'd') ? 'f' : (*p >= 'a' && *p <= 'z') ? 'i' : 'u';
+        _set_halide_type(out, kind, (int)buf->itemsize, name);
     }
-    out->type.lanes = 1;
-    out->dimensions = buf.ndim;
+    if (_fill_halide_dimensions(buf->ndim, shape, strides, dim, name) < 0) {
+        return -1;
+    }
+    out->dimensions = buf->ndim;
     out->dim = dim;
-    out->host = (uint8_t*)buf.buf;
+    out->host = (uint8_t*)buf->buf;
     return 0;
 }
 
@@ -322,14 +548,31 @@ void PythonExtensionGen::compile(const LoweredFunc &f) {
     dest << ")) {\n";
     dest << "        return NULL;\n";
     dest << "    }\n";
+    // Declare all the buffers up front, so that on failure we can
+    // release the ones converted so far by releasing all of them.
+    string cleanup;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i].is_buffer()) {
+            const string &name = arg_names[i];
+            dest << "    halide_buffer_t buffer_" << name << ";\n";
+            dest << "    halide_dimension_t dimensions_" << name << "[" << (int)args[i].dimensions << "];\n";
+            dest << "    _halide_py_buffer_owner_t owner_" << name << " = {};\n";
+            cleanup += "        _release_py_buffer(&owner_" + name + ");\n";
+        }
+    }
     for (size_t i = 0; i < args.size(); i++) {
         if (args[i].is_buffer()) {
-            convert_buffer(arg_names[i], &args[i]);
+            convert_buffer(arg_names[i], &args[i], cleanup);
         } else {
             // Python already converted this.
         }
     }
-    dest << "    int result = " << f.name << "(";
+    // Release the GIL while the pipeline runs, so that other Python
+    // threads can make progress. Runtime overrides that call back into
+    // Python must reacquire it themselves (e.g. with PyGILState_Ensure).
+    dest << "    int result;\n";
+    dest << "    Py_BEGIN_ALLOW_THREADS\n";
+    dest << "    result = " << f.name << "(";
     for (size_t i = 0; i < args.size(); i++) {
         if (i > 0) {
             dest << ", ";
@@ -340,7 +583,10 @@ void PythonExtensionGen::compile(const LoweredFunc &f) {
             dest << "py_" << arg_names[i];
         }
     }
-    dest << ");";
+    dest << ");\n";
+    dest << "    Py_END_ALLOW_THREADS\n";
+    // The cleanup is indented for an error branch.
+    dest << replace_all(cleanup, "        ", "    ");
     dest << R"INLINE_CODE(
     if (result != 0) {
         /* In the optimal case, we'd be generating an exception declared
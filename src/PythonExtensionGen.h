@@ -18,7 +18,7 @@ private:
     std::ostream &dest;
 
     void compile(const LoweredFunc &f);
-    void convert_buffer(const std::string &name, const LoweredArgument *arg);
+    void convert_buffer(const std::string &name, const LoweredArgument *arg, const std::string &cleanup);
 };
 
 }  // namespace Internal
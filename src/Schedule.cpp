@@ -126,6 +126,15 @@ bool LoopLevel::defined() const {
     return contents->var_name != undefined_looplevel_name;
 }
 
+void LoopLevel::get_raw(std::string &func_name, std::string &var_name,
+                        bool &is_rvar, int &stage_index, bool &locked) const {
+    func_name = contents->func_name;
+    var_name = contents->var_name;
+    is_rvar = contents->is_rvar;
+    stage_index = contents->stage_index;
+    locked = contents->locked;
+}
+
 std::string LoopLevel::func() const {
     check_defined_and_locked();
     return contents->func_name;
@@ -219,11 +228,11 @@ struct FuncScheduleContents {
     std::vector<Bound> estimates;
     std::map<std::string, Internal::FunctionPtr> wrappers;
     MemoryType memory_type;
-    bool memoized, async;
+    bool memoized, async, nontemporal_stores;
 
     FuncScheduleContents()
         : store_level(LoopLevel::inlined()), compute_level(LoopLevel::inlined()),
-          memory_type(MemoryType::Auto), memoized(false), async(false){};
+          memory_type(MemoryType::Auto), memoized(false), async(false), nontemporal_stores(false){};
 
     // Pass an IRMutator through to all Exprs referenced in the FuncScheduleContents
     void mutate(IRMutator *mutator) {
@@ -340,6 +349,7 @@ FuncSchedule FuncSchedule::deep_copy(
     copy.contents->memory_type = contents->memory_type;
     copy.contents->memoized = contents->memoized;
     copy.contents->async = contents->async;
+    copy.contents->nontemporal_stores = contents->nontemporal_stores;
 
     // Deep-copy wrapper functions.
     for (const auto &iter : contents->wrappers) {
@@ -375,6 +385,14 @@ bool FuncSchedule::async() const {
     return contents->async;
 }
 
+bool &FuncSchedule::nontemporal_stores() {
+    return contents->nontemporal_stores;
+}
+
+bool FuncSchedule::nontemporal_stores() const {
+    return contents->nontemporal_stores;
+}
+
 std::vector<StorageDim> &FuncSchedule::storage_dims() {
     return contents->storage_dims;
 }
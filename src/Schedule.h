@@ -22,9 +22,11 @@ class Func;
 struct VarOrRVar;
 
 namespace Internal {
+class Deserializer;
 class Function;
 struct FunctionContents;
 struct LoopLevelContents;
+class Serializer;
 }  // namespace Internal
 
 /** Different ways to handle a tail case in a split when the
@@ -222,6 +224,13 @@ private:
     void check_defined() const;
     void check_locked() const;
     void check_defined_and_locked() const;
+
+    // Read all fields without checking that this LoopLevel is defined or locked.
+    void get_raw(std::string &func_name, std::string &var_name,
+                 bool &is_rvar, int &stage_index, bool &locked) const;
+
+    friend class Internal::Serializer;
+    friend class Internal::Deserializer;
 };
 
 struct FuseLoopLevel {
@@ -402,6 +411,13 @@ public:
     bool &async();
     bool async() const;
 
+    /** Are dense vector stores to this Function written with
+     * non-temporal (streaming) stores. */
+    // @{
+    bool &nontemporal_stores();
+    bool nontemporal_stores() const;
+    // @}
+
     /** The list and order of dimensions used to store this
      * function. The first dimension in the vector corresponds to the
      * innermost dimension for storage (i.e. which dimension is
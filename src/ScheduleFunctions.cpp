@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "ApplySplit.h"
+#include "Associativity.h"
 #include "CodeGen_GPU_Dev.h"
 #include "ExprUsesVar.h"
 #include "Func.h"
@@ -1891,6 +1892,8 @@ bool validate_schedule(Function f, const Stmt &s, const Target &target, bool is_
             case ForType::Serial:
             case ForType::Parallel:
             case ForType::Unrolled:
+            case ForType::UnrolledAndJammed:
+            case ForType::SoftwarePipelined:
                 is_extern = false;
                 break;
             default:
@@ -1959,6 +1962,22 @@ bool validate_schedule(Function f, const Stmt &s, const Target &target, bool is_
             allow_race_conditions_count++;
         }
 
+        // Jamming a loop over an RVar into the loop over another RVar
+        // directly inside it reorders the updates, just like
+        // reordering those RVars would.
+        for (size_t i = 1; i < s.dims().size(); i++) {
+            const Dim &outer = s.dims()[i], &inner = s.dims()[i - 1];
+            if (outer.for_type == ForType::UnrolledAndJammed &&
+                !outer.is_pure() && !inner.is_pure()) {
+                const auto &prover_result = prove_associativity(f.name(), def.args(), def.values());
+                user_assert(prover_result.associative() && prover_result.commutative())
+                    << "In schedule for " << f.name()
+                    << ", can't unroll and jam RVar " << outer.var
+                    << " into RVar " << inner.var
+                    << " because it may change the meaning of the algorithm.\n";
+            }
+        }
+
         // For purposes of race-detection-warning, any split that
         // is the child of a parallel var is also 'parallel'.
         //
@@ -0,0 +1,1923 @@
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "Definition.h"
+#include "ExternalCode.h"
+#include "Func.h"
+#include "IR.h"
+#include "IREquality.h"
+#include "IROperator.h"
+#include "Reduction.h"
+#include "Schedule.h"
+#include "Serialization.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+// The serialized format is a header (magic, version and payload kind),
+// a table describing how the Functions referenced are grouped for
+// memory management, the payload itself, and then the definitions of
+// every Function referenced. Integers are LEB128 varints (zigzag
+// encoded when signed), and strings, IR nodes, Parameters, Buffers,
+// RDoms and LoopLevels are written in full the first time they are
+// seen, and by index after that, so that sharing survives a round
+// trip.
+
+const char serialization_magic[4] = {'H', 'L', 'I', 'R'};
+const uint32_t serialization_version = 1;
+
+enum class Payload : uint8_t {
+    Expr,
+    Stmt,
+    Functions,
+    Pipeline,
+    Module,
+};
+
+// Types point to handle type descriptions which are usually static
+// objects. Deserialized ones are interned here, and live forever.
+const halide_handle_cplusplus_type *intern_handle_type(const halide_handle_cplusplus_type &h) {
+    static std::mutex mutex;
+    static vector<std::unique_ptr<halide_handle_cplusplus_type>> interned;
+    std::lock_guard<std::mutex> lock(mutex);
+    Type t(Type::Handle, 64, 1, &h);
+    for (const auto &i : interned) {
+        if (t.same_handle_type(Type(Type::Handle, 64, 1, i.get()))) {
+            return i.get();
+        }
+    }
+    interned.emplace_back(new halide_handle_cplusplus_type(h));
+    return interned.back().get();
+}
+
+}  // namespace
+
+class Serializer {
+    vector<uint8_t> body;
+
+    map<string, uint64_t> strings;
+    map<const IRNode *, uint64_t> exprs, stmts;
+    map<Parameter, uint64_t> parameters;
+    map<const halide_buffer_t *, uint64_t> buffers;
+    map<ReductionDomain, uint64_t, ReductionDomain::Compare> rdoms;
+    map<const LoopLevelContents *, uint64_t> loop_levels;
+
+    // Every Function referenced, in the order first seen, along with
+    // the group each one belongs to.
+    vector<Function> functions;
+    map<const FunctionContents *, uint64_t> function_ids;
+    map<const FunctionGroup *, uint64_t> group_ids;
+    vector<std::pair<uint64_t, uint64_t>> function_groups;
+
+    void write_byte(vector<uint8_t> &out, uint8_t b) {
+        out.push_back(b);
+    }
+
+    void write_varint(vector<uint8_t> &out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((uint8_t)v);
+    }
+
+public:
+    void write_byte(uint8_t b) {
+        write_byte(body, b);
+    }
+
+    void write_varint(uint64_t v) {
+        write_varint(body, v);
+    }
+
+    void write_signed(int64_t v) {
+        write_varint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+    }
+
+    void write_bool(bool b) {
+        write_byte(b ? 1 : 0);
+    }
+
+    void write_fixed64(uint64_t v) {
+        for (int i = 0; i < 8; i++) {
+            write_byte((uint8_t)(v >> (i * 8)));
+        }
+    }
+
+    void write_double(double d) {
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        write_fixed64(bits);
+    }
+
+    void write_bytes(const uint8_t *data, size_t size) {
+        write_varint(size);
+        body.insert(body.end(), data, data + size);
+    }
+
+    void write(const string &s) {
+        auto it = strings.find(s);
+        if (it != strings.end()) {
+            write_varint(it->second + 1);
+            return;
+        }
+        write_varint(0);
+        write_bytes((const uint8_t *)s.data(), s.size());
+        strings.emplace(s, strings.size());
+    }
+
+    template<typename T>
+    void write(const vector<T> &v) {
+        write_varint(v.size());
+        for (const T &x : v) {
+            write(x);
+        }
+    }
+
+    void write(const halide_cplusplus_type_name &n) {
+        write_varint(n.cpp_type_type);
+        write(n.name);
+    }
+
+    void write(const Type &t) {
+        write_byte(t.code());
+        write_byte(t.bits());
+        write_varint(t.lanes());
+        write_bool(t.handle_type != nullptr);
+        if (t.handle_type) {
+            const halide_handle_cplusplus_type &h = *t.handle_type;
+            write(h.inner_name);
+            write(h.namespaces);
+            write(h.enclosing_types);
+            write_bytes(h.cpp_type_modifiers.data(), h.cpp_type_modifiers.size());
+            write_varint(h.reference_type);
+        }
+    }
+
+    void write(const ModulusRemainder &m) {
+        write_signed(m.modulus);
+        write_signed(m.remainder);
+    }
+
+    void write(const Range &r) {
+        write(r.min);
+        write(r.extent);
+    }
+
+    void write(const FunctionPtr &f) {
+        if (!f.defined()) {
+            write_varint(0);
+            return;
+        }
+        auto it = function_ids.find(f.get());
+        uint64_t id;
+        if (it != function_ids.end()) {
+            id = it->second;
+        } else {
+            id = functions.size();
+            function_ids.emplace(f.get(), id);
+            auto g = group_ids.emplace(f.group(), group_ids.size()).first;
+            function_groups.emplace_back(g->second, f.idx);
+            functions.emplace_back(f);
+        }
+        write_varint(id + 1);
+        write_bool(f.weak != nullptr);
+    }
+
+    void write(const Parameter &p) {
+        if (!p.defined()) {
+            write_varint(0);
+            return;
+        }
+        auto it = parameters.find(p);
+        if (it != parameters.end()) {
+            write_varint(it->second + 2);
+            return;
+        }
+        write_varint(1);
+        write(p.type());
+        write_varint(p.dimensions());
+        write(p.name());
+        write_bool(p.is_buffer());
+        // Register before writing the constraints, which may refer
+        // back to this Parameter.
+        parameters.emplace(p, parameters.size());
+        if (p.is_buffer()) {
+            for (int i = 0; i < p.dimensions(); i++) {
+                write(p.min_constraint(i));
+                write(p.extent_constraint(i));
+                write(p.stride_constraint(i));
+                write(p.min_constraint_estimate(i));
+                write(p.extent_constraint_estimate(i));
+            }
+            write_signed(p.host_alignment());
+            write(p.buffer());
+        } else {
+            uint64_t bits;
+            memcpy(&bits, p.scalar_address(), sizeof(bits));
+            write_fixed64(bits);
+            write(p.min_value());
+            write(p.max_value());
+            write(p.estimate());
+        }
+    }
+
+    void write(const Buffer<> &b) {
+        if (!b.defined()) {
+            write_varint(0);
+            return;
+        }
+        auto it = buffers.find(b.raw_buffer());
+        if (it != buffers.end()) {
+            write_varint(it->second + 2);
+            return;
+        }
+        user_assert(b.data() != nullptr)
+            << "Can't serialize Buffer " << b.name() << " because it has no host allocation\n";
+        user_assert(!b.device_dirty())
+            << "Can't serialize Buffer " << b.name() << " because it is dirty on the device\n";
+        write_varint(1);
+        write(b.name());
+        write(b.type());
+        vector<int> mins, extents;
+        for (int i = 0; i < b.dimensions(); i++) {
+            mins.push_back(b.dim(i).min());
+            extents.push_back(b.dim(i).extent());
+        }
+        write_varint(b.dimensions());
+        for (int i = 0; i < b.dimensions(); i++) {
+            write_signed(mins[i]);
+            write_signed(extents[i]);
+        }
+        // Write the contents densely, whatever the strides.
+        Buffer<> dense(b.type(), extents);
+        dense.set_min(mins);
+        dense.copy_from(b);
+        write_bytes((const uint8_t *)dense.data(), dense.size_in_bytes());
+        buffers.emplace(b.raw_buffer(), buffers.size());
+    }
+
+    void write(const ReductionVariable &r) {
+        write(r.var);
+        write(r.min);
+        write(r.extent);
+    }
+
+    void write(const ReductionDomain &r) {
+        if (!r.defined()) {
+            write_varint(0);
+            return;
+        }
+        auto it = rdoms.find(r);
+        if (it != rdoms.end()) {
+            write_varint(it->second + 2);
+            return;
+        }
+        write_varint(1);
+        write(r.domain());
+        // The predicate usually refers back to this RDom.
+        rdoms.emplace(r, rdoms.size());
+        write(r.predicate());
+        write_bool(r.frozen());
+    }
+
+    void write(const Expr &e) {
+        if (!e.defined()) {
+            write_varint(0);
+            return;
+        }
+        auto it = exprs.find(e.get());
+        if (it != exprs.end()) {
+            write_varint(1);
+            write_varint(it->second);
+            return;
+        }
+        write_varint((uint64_t)e->node_type + 2);
+        switch (e->node_type) {
+        case IRNodeType::IntImm: {
+            const IntImm *op = e.as<IntImm>();
+            write(op->type);
+            write_signed(op->value);
+            break;
+        }
+        case IRNodeType::UIntImm: {
+            const UIntImm *op = e.as<UIntImm>();
+            write(op->type);
+            write_varint(op->value);
+            break;
+        }
+        case IRNodeType::FloatImm: {
+            const FloatImm *op = e.as<FloatImm>();
+            write(op->type);
+            write_double(op->value);
+            break;
+        }
+        case IRNodeType::StringImm:
+            write(e.as<StringImm>()->value);
+            break;
+        case IRNodeType::Broadcast: {
+            const Broadcast *op = e.as<Broadcast>();
+            write(op->value);
+            write_varint(op->lanes);
+            break;
+        }
+        case IRNodeType::Cast: {
+            const Cast *op = e.as<Cast>();
+            write(op->type);
+            write(op->value);
+            break;
+        }
+        case IRNodeType::Variable: {
+            const Variable *op = e.as<Variable>();
+            write(op->type);
+            write(op->name);
+            write(op->param);
+            write(op->image);
+            write(op->reduction_domain);
+            break;
+        }
+        case IRNodeType::Add:
+            write_binary(e.as<Add>());
+            break;
+        case IRNodeType::Sub:
+            write_binary(e.as<Sub>());
+            break;
+        case IRNodeType::Mod:
+            write_binary(e.as<Mod>());
+            break;
+        case IRNodeType::Mul:
+            write_binary(e.as<Mul>());
+            break;
+        case IRNodeType::Div:
+            write_binary(e.as<Div>());
+            break;
+        case IRNodeType::Min:
+            write_binary(e.as<Min>());
+            break;
+        case IRNodeType::Max:
+            write_binary(e.as<Max>());
+            break;
+        case IRNodeType::EQ:
+            write_binary(e.as<EQ>());
+            break;
+        case IRNodeType::NE:
+            write_binary(e.as<NE>());
+            break;
+        case IRNodeType::LT:
+            write_binary(e.as<LT>());
+            break;
+        case IRNodeType::LE:
+            write_binary(e.as<LE>());
+            break;
+        case IRNodeType::GT:
+            write_binary(e.as<GT>());
+            break;
+        case IRNodeType::GE:
+            write_binary(e.as<GE>());
+            break;
+        case IRNodeType::And:
+            write_binary(e.as<And>());
+            break;
+        case IRNodeType::Or:
+            write_binary(e.as<Or>());
+            break;
+        case IRNodeType::Not:
+            write(e.as<Not>()->a);
+            break;
+        case IRNodeType::Select: {
+            const Select *op = e.as<Select>();
+            write(op->condition);
+            write(op->true_value);
+            write(op->false_value);
+            break;
+        }
+        case IRNodeType::Load: {
+            const Load *op = e.as<Load>();
+            write(op->type);
+            write(op->name);
+            write(op->index);
+            write(op->image);
+            write(op->param);
+            write(op->predicate);
+            write(op->alignment);
+            break;
+        }
+        case IRNodeType::Ramp: {
+            const Ramp *op = e.as<Ramp>();
+            write(op->base);
+            write(op->stride);
+            write_varint(op->lanes);
+            break;
+        }
+        case IRNodeType::Call: {
+            const Call *op = e.as<Call>();
+            write(op->type);
+            write(op->name);
+            write(op->args);
+            write_varint(op->call_type);
+            write(op->func);
+            write_varint(op->value_index);
+            write(op->image);
+            write(op->param);
+            break;
+        }
+        case IRNodeType::Let: {
+            const Let *op = e.as<Let>();
+            write(op->name);
+            write(op->value);
+            write(op->body);
+            break;
+        }
+        case IRNodeType::Shuffle: {
+            const Shuffle *op = e.as<Shuffle>();
+            write(op->vectors);
+            write_varint(op->indices.size());
+            for (int i : op->indices) {
+                write_signed(i);
+            }
+            break;
+        }
+        default:
+            internal_error << "Can't serialize Expr with node type " << (int)e->node_type << "\n";
+        }
+        exprs.emplace(e.get(), exprs.size());
+    }
+
+    template<typename T>
+    void write_binary(const T *op) {
+        write(op->a);
+        write(op->b);
+    }
+
+    void write(const PrefetchDirective &p) {
+        write(p.name);
+        write(p.var);
+        write(p.offset);
+        write_varint((int)p.strategy);
+        write(p.param);
+    }
+
+    void write(const Stmt &s) {
+        if (!s.defined()) {
+            write_varint(0);
+            return;
+        }
+        auto it = stmts.find(s.get());
+        if (it != stmts.end()) {
+            write_varint(1);
+            write_varint(it->second);
+            return;
+        }
+        write_varint((uint64_t)s->node_type + 2);
+        switch (s->node_type) {
+        case IRNodeType::LetStmt: {
+            const LetStmt *op = s.as<LetStmt>();
+            write(op->name);
+            write(op->value);
+            write(op->body);
+            break;
+        }
+        case IRNodeType::AssertStmt: {
+            const AssertStmt *op = s.as<AssertStmt>();
+            write(op->condition);
+            write(op->message);
+            break;
+        }
+        case IRNodeType::ProducerConsumer: {
+            const ProducerConsumer *op = s.as<ProducerConsumer>();
+            write(op->name);
+            write_bool(op->is_producer);
+            write(op->body);
+            break;
+        }
+        case IRNodeType::For: {
+            const For *op = s.as<For>();
+            write(op->name);
+            write(op->min);
+            write(op->extent);
+            write_varint((int)op->for_type);
+            write_varint((int)op->device_api);
+            write(op->body);
+            break;
+        }
+        case IRNodeType::Acquire: {
+            const Acquire *op = s.as<Acquire>();
+            write(op->semaphore);
+            write(op->count);
+            write(op->body);
+            break;
+        }
+        case IRNodeType::Store: {
+            const Store *op = s.as<Store>();
+            write(op->name);
+            write(op->value);
+            write(op->index);
+            write(op->param);
+            write(op->predicate);
+            write(op->alignment);
+            break;
+        }
+        case IRNodeType::Provide: {
+            const Provide *op = s.as<Provide>();
+            write(op->name);
+            write(op->values);
+            write(op->args);
+            break;
+        }
+        case IRNodeType::Allocate: {
+            const Allocate *op = s.as<Allocate>();
+            write(op->name);
+            write(op->type);
+            write_varint((int)op->memory_type);
+            write(op->extents);
+            write(op->condition);
+            write(op->body);
+            write(op->new_expr);
+            write(op->free_function);
+            break;
+        }
+        case IRNodeType::Free:
+            write(s.as<Free>()->name);
+            break;
+        case IRNodeType::Realize: {
+            const Realize *op = s.as<Realize>();
+            write(op->name);
+            write(op->types);
+            write_varint((int)op->memory_type);
+            write(op->bounds);
+            write(op->condition);
+            write(op->body);
+            break;
+        }
+        case IRNodeType::Block: {
+            const Block *op = s.as<Block>();
+            write(op->first);
+            write(op->rest);
+            break;
+        }
+        case IRNodeType::Fork: {
+            const Fork *op = s.as<Fork>();
+            write(op->first);
+            write(op->rest);
+            break;
+        }
+        case IRNodeType::IfThenElse: {
+            const IfThenElse *op = s.as<IfThenElse>();
+            write(op->condition);
+            write(op->then_case);
+            write(op->else_case);
+            break;
+        }
+        case IRNodeType::Evaluate:
+            write(s.as<Evaluate>()->value);
+            break;
+        case IRNodeType::Prefetch: {
+            const Prefetch *op = s.as<Prefetch>();
+            write(op->name);
+            write(op->types);
+            write(op->bounds);
+            write(op->prefetch);
+            write(op->condition);
+            write(op->body);
+            break;
+        }
+        case IRNodeType::Atomic: {
+            const Atomic *op = s.as<Atomic>();
+            write(op->producer_name);
+            write(op->mutex_name);
+            write(op->body);
+            break;
+        }
+        default:
+            internal_error << "Can't serialize Stmt with node type " << (int)s->node_type << "\n";
+        }
+        stmts.emplace(s.get(), stmts.size());
+    }
+
+    void write(const LoopLevel &l) {
+        auto it = loop_levels.find(l.contents.get());
+        if (it != loop_levels.end()) {
+            write_varint(it->second + 1);
+            return;
+        }
+        write_varint(0);
+        string func_name, var_name;
+        bool is_rvar, locked;
+        int stage_index;
+        l.get_raw(func_name, var_name, is_rvar, stage_index, locked);
+        write(func_name);
+        write(var_name);
+        write_bool(is_rvar);
+        write_signed(stage_index);
+        write_bool(locked);
+        loop_levels.emplace(l.contents.get(), loop_levels.size());
+    }
+
+    void write(const Split &s) {
+        write(s.old_var);
+        write(s.outer);
+        write(s.inner);
+        write(s.factor);
+        write_bool(s.exact);
+        write_varint((int)s.tail);
+        write_varint((int)s.split_type);
+    }
+
+    void write(const Dim &d) {
+        write(d.var);
+        write_varint((int)d.for_type);
+        write_varint((int)d.device_api);
+        write_varint((int)d.dim_type);
+    }
+
+    void write(const Bound &b) {
+        write(b.var);
+        write(b.min);
+        write(b.extent);
+        write(b.modulus);
+        write(b.remainder);
+    }
+
+    void write(const StorageDim &d) {
+        write(d.var);
+        write(d.alignment);
+        write(d.fold_factor);
+        write_bool(d.fold_forward);
+    }
+
+    void write(const FusedPair &p) {
+        write(p.func_1);
+        write(p.func_2);
+        write_varint(p.stage_1);
+        write_varint(p.stage_2);
+        write(p.var_name);
+    }
+
+    void write(const StageSchedule &s) {
+        write(s.rvars());
+        write(s.splits());
+        write(s.dims());
+        write(s.prefetches());
+        write(s.fuse_level().level);
+        write_varint(s.fuse_level().align.size());
+        for (const auto &a : s.fuse_level().align) {
+            write(a.first);
+            write_varint((int)a.second);
+        }
+        write(s.fused_pairs());
+        write_bool(s.touched());
+        write_bool(s.allow_race_conditions());
+        write_bool(s.atomic());
+        write_bool(s.override_atomic_associativity_test());
+    }
+
+    void write(const FuncSchedule &s) {
+        write(s.store_level());
+        write(s.compute_level());
+        write(s.storage_dims());
+        write(s.bounds());
+        write(s.estimates());
+        write_varint(s.wrappers().size());
+        for (const auto &w : s.wrappers()) {
+            write(w.first);
+            write(w.second);
+        }
+        write_varint((int)s.memory_type());
+        write_bool(s.memoized());
+        write_bool(s.async());
+        write_bool(s.nontemporal_stores());
+    }
+
+    void write(const Specialization &s) {
+        write(s.condition);
+        write(s.definition);
+        write(s.failure_message);
+    }
+
+    void write(const Definition &d) {
+        write_bool(d.defined());
+        if (!d.defined()) {
+            return;
+        }
+        write_bool(d.is_init());
+        write(d.args());
+        write(d.values());
+        write(d.predicate());
+        write(d.schedule());
+        write(d.specializations());
+    }
+
+    void write(const ExternFuncArgument &a) {
+        write_varint(a.arg_type);
+        write(a.func);
+        write(a.buffer);
+        write(a.expr);
+        write(a.image_param);
+    }
+
+    void write_function_definition(const Function &f) {
+        write(f.name());
+        write(f.origin_name());
+        write(f.output_types());
+        write(f.args());
+        write(f.schedule());
+        write(f.has_pure_definition() ? f.definition() : Definition());
+        write(f.updates());
+        write(f.debug_file());
+        write(f.output_buffers());
+        write(f.extern_arguments());
+        write(f.extern_function_name());
+        write_varint((int)f.extern_definition_name_mangling());
+        write_varint((int)f.extern_function_device_api());
+        write(f.extern_definition_proxy_expr());
+        write_bool(f.is_tracing_loads());
+        write_bool(f.is_tracing_stores());
+        write_bool(f.is_tracing_realizations());
+        write(f.get_trace_tags());
+        write_bool(f.frozen());
+    }
+
+    void write(const Target &t) {
+        write(t.to_string());
+    }
+
+    void write(const LoweredArgument &a) {
+        write(a.name);
+        write_varint(a.kind);
+        write_varint(a.dimensions);
+        write(a.type);
+        write(a.argument_estimates.scalar_def);
+        write(a.argument_estimates.scalar_min);
+        write(a.argument_estimates.scalar_max);
+        write(a.argument_estimates.scalar_estimate);
+        write(a.argument_estimates.buffer_estimates);
+        write(a.alignment);
+    }
+
+    void write(const LoweredFunc &f) {
+        write(f.name);
+        write(f.args);
+        write(f.body);
+        write_varint((int)f.linkage);
+        write_varint((int)f.name_mangling);
+    }
+
+    void write(const ExternalCode &c) {
+        write_varint(c.kind);
+        write(c.llvm_target);
+        write_varint((int)c.device_code_kind);
+        write_bytes(c.code.data(), c.code.size());
+        write(c.nametag);
+    }
+
+    void write(const Module &m) {
+        write(m.name());
+        write(m.target());
+        write(m.functions());
+        write(m.buffers());
+        write(m.submodules());
+        write(m.external_code());
+        map<string, string> metadata_names = m.get_metadata_name_map();
+        write_varint(metadata_names.size());
+        for (const auto &n : metadata_names) {
+            write(n.first);
+            write(n.second);
+        }
+        write_bool(m.any_strict_float());
+        const AutoSchedulerResults *results = m.get_auto_scheduler_results();
+        write_bool(results != nullptr);
+        if (results) {
+            write(results->scheduler_name);
+            write(results->target);
+            write(results->machine_params_string);
+            write(results->schedule_source);
+            write_bytes(results->featurization.data(), results->featurization.size());
+        }
+    }
+
+    void write(const Pipeline &p) {
+        vector<Func> outputs = p.outputs();
+        write_varint(outputs.size());
+        for (const Func &f : outputs) {
+            write(f.function().get_contents());
+        }
+        write(p.requirements());
+    }
+
+    // Write the definitions of every Function referenced so far, and
+    // return the complete serialized data.
+    vector<uint8_t> finish(Payload payload) {
+        // Writing a definition may add more Functions to the list.
+        for (size_t i = 0; i < functions.size(); i++) {
+            Function f = functions[i];
+            write_function_definition(f);
+        }
+
+        vector<uint8_t> result(serialization_magic, serialization_magic + sizeof(serialization_magic));
+        for (int i = 0; i < 4; i++) {
+            write_byte(result, (uint8_t)(serialization_version >> (i * 8)));
+        }
+        write_byte(result, (uint8_t)payload);
+        write_varint(result, function_groups.size());
+        for (const auto &g : function_groups) {
+            write_varint(result, g.first);
+            write_varint(result, g.second);
+        }
+        result.insert(result.end(), body.begin(), body.end());
+        return result;
+    }
+};
+
+class Deserializer {
+    const vector<uint8_t> &data;
+    size_t pos = 0;
+
+    const map<string, Parameter> &user_params;
+
+    vector<string> strings;
+    vector<Expr> exprs;
+    vector<Stmt> stmts;
+    vector<Parameter> parameters;
+    vector<Buffer<>> buffers;
+    vector<ReductionDomain> rdoms;
+    vector<LoopLevel> loop_levels;
+
+    // Every Function referenced, created as empty shells in the
+    // right groups before anything else is read.
+    vector<Function> functions;
+
+    void check_available(size_t bytes) {
+        user_assert(bytes <= data.size() - pos)
+            << "Unexpected end of serialized Halide data\n";
+    }
+
+    template<typename T>
+    const T &lookup(const vector<T> &table, uint64_t idx, const char *what) {
+        user_assert(idx < table.size())
+            << "Invalid " << what << " index " << idx << " in serialized Halide data\n";
+        return table[idx];
+    }
+
+public:
+    Deserializer(const vector<uint8_t> &data, Payload expected,
+                 const map<string, Parameter> &user_params)
+        : data(data), user_params(user_params) {
+        check_available(sizeof(serialization_magic) + 5);
+        user_assert(memcmp(data.data(), serialization_magic, sizeof(serialization_magic)) == 0)
+            << "Data is not serialized Halide IR\n";
+        pos += sizeof(serialization_magic);
+        uint32_t version = 0;
+        for (int i = 0; i < 4; i++) {
+            version |= (uint32_t)read_byte() << (i * 8);
+        }
+        user_assert(version == serialization_version)
+            << "Serialized Halide data has version " << version
+            << ", but this version of Halide reads version " << serialization_version << "\n";
+        uint8_t payload = read_byte();
+        user_assert(payload == (uint8_t)expected)
+            << "Serialized Halide data holds a different kind of object than the one requested\n";
+
+        // Make the shells of all the Functions, in their groups.
+        size_t num_functions = read_varint();
+        vector<std::pair<uint64_t, uint64_t>> function_groups;
+        vector<uint64_t> group_sizes;
+        for (size_t i = 0; i < num_functions; i++) {
+            uint64_t group = read_varint();
+            uint64_t idx = read_varint();
+            user_assert(group <= group_sizes.size() && idx < num_functions)
+                << "Invalid Function group in serialized Halide data\n";
+            if (group == group_sizes.size()) {
+                group_sizes.push_back(0);
+            }
+            group_sizes[group] = std::max(group_sizes[group], idx + 1);
+            function_groups.emplace_back(group, idx);
+        }
+        vector<vector<Function>> groups(group_sizes.size());
+        for (size_t g = 0; g < groups.size(); g++) {
+            groups[g].emplace_back("deserialized");
+            while (groups[g].size() < group_sizes[g]) {
+                groups[g].push_back(groups[g][0].new_function_in_same_group("deserialized"));
+            }
+        }
+        for (const auto &g : function_groups) {
+            functions.push_back(groups[g.first][g.second]);
+        }
+    }
+
+    uint8_t read_byte() {
+        check_available(1);
+        return data[pos++];
+    }
+
+    uint64_t read_varint() {
+        uint64_t result = 0;
+        for (int shift = 0;; shift += 7) {
+            user_assert(shift < 64) << "Invalid integer in serialized Halide data\n";
+            uint8_t b = read_byte();
+            result |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return result;
+            }
+        }
+    }
+
+    int64_t read_signed() {
+        uint64_t v = read_varint();
+        return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+
+    int read_int() {
+        return (int)read_signed();
+    }
+
+    bool read_bool() {
+        return read_byte() != 0;
+    }
+
+    uint64_t read_fixed64() {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) {
+            v |= (uint64_t)read_byte() << (i * 8);
+        }
+        return v;
+    }
+
+    double read_double() {
+        uint64_t bits = read_fixed64();
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    vector<uint8_t> read_bytes() {
+        size_t size = read_varint();
+        check_available(size);
+        vector<uint8_t> result(data.begin() + pos, data.begin() + pos + size);
+        pos += size;
+        return result;
+    }
+
+    void read(string &s) {
+        uint64_t v = read_varint();
+        if (v) {
+            s = lookup(strings, v - 1, "string");
+            return;
+        }
+        vector<uint8_t> bytes = read_bytes();
+        s.assign(bytes.begin(), bytes.end());
+        strings.push_back(s);
+    }
+
+    string read_string() {
+        string s;
+        read(s);
+        return s;
+    }
+
+    template<typename T>
+    void read(vector<T> &v) {
+        size_t size = read_varint();
+        v.clear();
+        v.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            v.emplace_back();
+            read(v.back());
+        }
+    }
+
+    void read(vector<halide_cplusplus_type_name> &v) {
+        size_t size = read_varint();
+        v.clear();
+        for (size_t i = 0; i < size; i++) {
+            v.push_back(read_type_name());
+        }
+    }
+
+    halide_cplusplus_type_name read_type_name() {
+        auto cpp_type_type = (halide_cplusplus_type_name::CPPTypeType)read_varint();
+        string name = read_string();
+        return halide_cplusplus_type_name(cpp_type_type, name);
+    }
+
+    void read(Type &t) {
+        auto code = (halide_type_code_t)read_byte();
+        int bits = read_byte();
+        int lanes = (int)read_varint();
+        const halide_handle_cplusplus_type *handle_type = nullptr;
+        if (read_bool()) {
+            halide_cplusplus_type_name inner_name = read_type_name();
+            halide_handle_cplusplus_type h(inner_name);
+            read(h.namespaces);
+            read(h.enclosing_types);
+            h.cpp_type_modifiers = read_bytes();
+            h.reference_type = (halide_handle_cplusplus_type::ReferenceType)read_varint();
+            handle_type = intern_handle_type(h);
+        }
+        t = Type(code, bits, lanes, handle_type);
+    }
+
+    Type read_type() {
+        Type t;
+        read(t);
+        return t;
+    }
+
+    void read(ModulusRemainder &m) {
+        m.modulus = read_signed();
+        m.remainder = read_signed();
+    }
+
+    void read(Range &r) {
+        read(r.min);
+        read(r.extent);
+    }
+
+    void read(FunctionPtr &f) {
+        uint64_t v = read_varint();
+        if (!v) {
+            f = FunctionPtr();
+            return;
+        }
+        f = lookup(functions, v - 1, "Function").get_contents();
+        if (read_bool()) {
+            f.weaken();
+        }
+    }
+
+    void read(Parameter &p) {
+        uint64_t v = read_varint();
+        if (v != 1) {
+            p = v ? lookup(parameters, v - 2, "Parameter") : Parameter();
+            return;
+        }
+        Type type = read_type();
+        int dimensions = (int)read_varint();
+        string name = read_string();
+        bool is_buffer = read_bool();
+
+        // Parameters supplied by the caller replace those in the data,
+        // along with their constraints and values.
+        auto it = user_params.find(name);
+        bool replaced = it != user_params.end();
+        if (replaced) {
+            p = it->second;
+            user_assert(p.type() == type && p.dimensions() == dimensions && p.is_buffer() == is_buffer)
+                << "Parameter " << name << " passed to deserialization does not match the "
+                << (is_buffer ? "buffer" : "scalar") << " parameter of type " << type
+                << " and dimensionality " << dimensions << " in the serialized data\n";
+        } else {
+            p = Parameter(type, is_buffer, dimensions, name);
+        }
+        parameters.push_back(p);
+
+        if (is_buffer) {
+            for (int i = 0; i < dimensions; i++) {
+                Expr min = read_expr();
+                Expr extent = read_expr();
+                Expr stride = read_expr();
+                Expr min_estimate = read_expr();
+                Expr extent_estimate = read_expr();
+                if (!replaced) {
+                    p.set_min_constraint(i, min);
+                    p.set_extent_constraint(i, extent);
+                    p.set_stride_constraint(i, stride);
+                    p.set_min_constraint_estimate(i, min_estimate);
+                    p.set_extent_constraint_estimate(i, extent_estimate);
+                }
+            }
+            int host_alignment = read_int();
+            Buffer<> buffer = read_buffer();
+            if (!replaced) {
+                p.set_host_alignment(host_alignment);
+                p.set_buffer(buffer);
+            }
+        } else {
+            uint64_t bits = read_fixed64();
+            Expr min = read_expr();
+            Expr max = read_expr();
+            Expr estimate = read_expr();
+            if (!replaced) {
+                memcpy(p.scalar_address(), &bits, sizeof(bits));
+                p.set_min_value(min);
+                p.set_max_value(max);
+                p.set_estimate(estimate);
+            }
+        }
+    }
+
+    void read(Buffer<> &b) {
+        uint64_t v = read_varint();
+        if (v != 1) {
+            b = v ? lookup(buffers, v - 2, "Buffer") : Buffer<>();
+            return;
+        }
+        string name = read_string();
+        Type type = read_type();
+        int dimensions = (int)read_varint();
+        vector<int> mins, extents;
+        for (int i = 0; i < dimensions; i++) {
+            mins.push_back(read_int());
+            extents.push_back(read_int());
+        }
+        b = Buffer<>(type, extents, name);
+        b.set_min(mins);
+        vector<uint8_t> contents = read_bytes();
+        user_assert(contents.size() == b.size_in_bytes())
+            << "Invalid contents for Buffer " << name << " in serialized Halide data\n";
+        memcpy(b.data(), contents.data(), contents.size());
+        buffers.push_back(b);
+    }
+
+    Buffer<> read_buffer() {
+        Buffer<> b;
+        read(b);
+        return b;
+    }
+
+    void read(ReductionVariable &r) {
+        read(r.var);
+        read(r.min);
+        read(r.extent);
+    }
+
+    void read(ReductionDomain &r) {
+        uint64_t v = read_varint();
+        if (v != 1) {
+            r = v ? lookup(rdoms, v - 2, "RDom") : ReductionDomain();
+            return;
+        }
+        vector<ReductionVariable> domain;
+        read(domain);
+        r = ReductionDomain(domain);
+        rdoms.push_back(r);
+        r.set_predicate(read_expr());
+        if (read_bool()) {
+            r.freeze();
+        }
+    }
+
+    template<typename T>
+    Expr read_binary() {
+        Expr a = read_expr();
+        Expr b = read_expr();
+        return T::make(std::move(a), std::move(b));
+    }
+
+    void read(Expr &result) {
+        uint64_t tag = read_varint();
+        if (tag == 0) {
+            result = Expr();
+            return;
+        } else if (tag == 1) {
+            result = lookup(exprs, read_varint(), "Expr");
+            return;
+        }
+        user_assert(tag - 2 <= (uint64_t)StrongestExprNodeType)
+            << "Invalid Expr in serialized Halide data\n";
+        switch ((IRNodeType)(tag - 2)) {
+        case IRNodeType::IntImm: {
+            Type t = read_type();
+            result = IntImm::make(t, read_signed());
+            break;
+        }
+        case IRNodeType::UIntImm: {
+            Type t = read_type();
+            result = UIntImm::make(t, read_varint());
+            break;
+        }
+        case IRNodeType::FloatImm: {
+            Type t = read_type();
+            result = FloatImm::make(t, read_double());
+            break;
+        }
+        case IRNodeType::StringImm:
+            result = StringImm::make(read_string());
+            break;
+        case IRNodeType::Broadcast: {
+            Expr value = read_expr();
+            result = Broadcast::make(value, (int)read_varint());
+            break;
+        }
+        case IRNodeType::Cast: {
+            Type t = read_type();
+            result = Cast::make(t, read_expr());
+            break;
+        }
+        case IRNodeType::Variable: {
+            Type t = read_type();
+            string name = read_string();
+            Parameter param;
+            read(param);
+            Buffer<> image = read_buffer();
+            ReductionDomain rdom;
+            read(rdom);
+            result = Variable::make(t, name, image, param, rdom);
+            break;
+        }
+        case IRNodeType::Add:
+            result = read_binary<Add>();
+            break;
+        case IRNodeType::Sub:
+            result = read_binary<Sub>();
+            break;
+        case IRNodeType::Mod:
+            result = read_binary<Mod>();
+            break;
+        case IRNodeType::Mul:
+            result = read_binary<Mul>();
+            break;
+        case IRNodeType::Div:
+            result = read_binary<Div>();
+            break;
+        case IRNodeType::Min:
+            result = read_binary<Min>();
+            break;
+        case IRNodeType::Max:
+            result = read_binary<Max>();
+            break;
+        case IRNodeType::EQ:
+            result = read_binary<EQ>();
+            break;
+        case IRNodeType::NE:
+            result = read_binary<NE>();
+            break;
+        case IRNodeType::LT:
+            result = read_binary<LT>();
+            break;
+        case IRNodeType::LE:
+            result = read_binary<LE>();
+            break;
+        case IRNodeType::GT:
+            result = read_binary<GT>();
+            break;
+        case IRNodeType::GE:
+            result = read_binary<GE>();
+            break;
+        case IRNodeType::And:
+            result = read_binary<And>();
+            break;
+        case IRNodeType::Or:
+            result = read_binary<Or>();
+            break;
+        case IRNodeType::Not:
+            result = Not::make(read_expr());
+            break;
+        case IRNodeType::Select: {
+            Expr condition = read_expr();
+            Expr true_value = read_expr();
+            Expr false_value = read_expr();
+            result = Select::make(condition, true_value, false_value);
+            break;
+        }
+        case IRNodeType::Load: {
+            Type t = read_type();
+            string name = read_string();
+            Expr index = read_expr();
+            Buffer<> image = read_buffer();
+            Parameter param;
+            read(param);
+            Expr predicate = read_expr();
+            ModulusRemainder alignment;
+            read(alignment);
+            result = Load::make(t, name, index, image, param, predicate, alignment);
+            break;
+        }
+        case IRNodeType::Ramp: {
+            Expr base = read_expr();
+            Expr stride = read_expr();
+            result = Ramp::make(base, stride, (int)read_varint());
+            break;
+        }
+        case IRNodeType::Call: {
+            Type t = read_type();
+            string name = read_string();
+            vector<Expr> args;
+            read(args);
+            auto call_type = (Call::CallType)read_varint();
+            FunctionPtr func;
+            read(func);
+            int value_index = (int)read_varint();
+            Buffer<> image = read_buffer();
+            Parameter param;
+            read(param);
+            result = Call::make(t, name, args, call_type, func, value_index, image, param);
+            break;
+        }
+        case IRNodeType::Let: {
+            string name = read_string();
+            Expr value = read_expr();
+            Expr body = read_expr();
+            result = Let::make(name, value, body);
+            break;
+        }
+        case IRNodeType::Shuffle: {
+            vector<Expr> vectors;
+            read(vectors);
+            vector<int> indices(read_varint());
+            for (int &i : indices) {
+                i = read_int();
+            }
+            result = Shuffle::make(vectors, indices);
+            break;
+        }
+        default:
+            user_error << "Invalid Expr in serialized Halide data\n";
+        }
+        exprs.push_back(result);
+    }
+
+    Expr read_expr() {
+        Expr e;
+        read(e);
+        return e;
+    }
+
+    void read(PrefetchDirective &p) {
+        read(p.name);
+        read(p.var);
+        read(p.offset);
+        p.strategy = (PrefetchBoundStrategy)read_varint();
+        read(p.param);
+    }
+
+    void read(Stmt &result) {
+        uint64_t tag = read_varint();
+        if (tag == 0) {
+            result = Stmt();
+            return;
+        } else if (tag == 1) {
+            result = lookup(stmts, read_varint(), "Stmt");
+            return;
+        }
+        user_assert(tag - 2 > (uint64_t)StrongestExprNodeType && tag - 2 <= (uint64_t)IRNodeType::Atomic)
+            << "Invalid Stmt in serialized Halide data\n";
+        switch ((IRNodeType)(tag - 2)) {
+        case IRNodeType::LetStmt: {
+            string name = read_string();
+            Expr value = read_expr();
+            Stmt body = read_stmt();
+            result = LetStmt::make(name, value, body);
+            break;
+        }
+        case IRNodeType::AssertStmt: {
+            Expr condition = read_expr();
+            Expr message = read_expr();
+            result = AssertStmt::make(condition, message);
+            break;
+        }
+        case IRNodeType::ProducerConsumer: {
+            string name = read_string();
+            bool is_producer = read_bool();
+            result = ProducerConsumer::make(name, is_producer, read_stmt());
+            break;
+        }
+        case IRNodeType::For: {
+            string name = read_string();
+            Expr min = read_expr();
+            Expr extent = read_expr();
+            auto for_type = (ForType)read_varint();
+            auto device_api = (DeviceAPI)read_varint();
+            result = For::make(name, min, extent, for_type, device_api, read_stmt());
+            break;
+        }
+        case IRNodeType::Acquire: {
+            Expr semaphore = read_expr();
+            Expr count = read_expr();
+            result = Acquire::make(semaphore, count, read_stmt());
+            break;
+        }
+        case IRNodeType::Store: {
+            string name = read_string();
+            Expr value = read_expr();
+            Expr index = read_expr();
+            Parameter param;
+            read(param);
+            Expr predicate = read_expr();
+            ModulusRemainder alignment;
+            read(alignment);
+            result = Store::make(name, value, index, param, predicate, alignment);
+            break;
+        }
+        case IRNodeType::Provide: {
+            string name = read_string();
+            vector<Expr> values, args;
+            read(values);
+            read(args);
+            result = Provide::make(name, values, args);
+            break;
+        }
+        case IRNodeType::Allocate: {
+            string name = read_string();
+            Type t = read_type();
+            auto memory_type = (MemoryType)read_varint();
+            vector<Expr> extents;
+            read(extents);
+            Expr condition = read_expr();
+            Stmt body = read_stmt();
+            Expr new_expr = read_expr();
+            string free_function = read_string();
+            result = Allocate::make(name, t, memory_type, extents, condition, body, new_expr, free_function);
+            break;
+        }
+        case IRNodeType::Free:
+            result = Free::make(read_string());
+            break;
+        case IRNodeType::Realize: {
+            string name = read_string();
+            vector<Type> types;
+            read(types);
+            auto memory_type = (MemoryType)read_varint();
+            Region bounds;
+            read(bounds);
+            Expr condition = read_expr();
+            result = Realize::make(name, types, memory_type, bounds, condition, read_stmt());
+            break;
+        }
+        case IRNodeType::Block: {
+            Stmt first = read_stmt();
+            Stmt rest = read_stmt();
+            result = Block::make(first, rest);
+            break;
+        }
+        case IRNodeType::Fork: {
+            Stmt first = read_stmt();
+            Stmt rest = read_stmt();
+            result = Fork::make(first, rest);
+            break;
+        }
+        case IRNodeType::IfThenElse: {
+            Expr condition = read_expr();
+            Stmt then_case = read_stmt();
+            Stmt else_case = read_stmt();
+            result = IfThenElse::make(condition, then_case, else_case);
+            break;
+        }
+        case IRNodeType::Evaluate:
+            result = Evaluate::make(read_expr());
+            break;
+        case IRNodeType::Prefetch: {
+            string name = read_string();
+            vector<Type> types;
+            read(types);
+            Region bounds;
+            read(bounds);
+            PrefetchDirective prefetch;
+            read(prefetch);
+            Expr condition = read_expr();
+            result = Prefetch::make(name, types, bounds, prefetch, condition, read_stmt());
+            break;
+        }
+        case IRNodeType::Atomic: {
+            string producer_name = read_string();
+            string mutex_name = read_string();
+            result = Atomic::make(producer_name, mutex_name, read_stmt());
+            break;
+        }
+        default:
+            user_error << "Invalid Stmt in serialized Halide data\n";
+        }
+        stmts.push_back(result);
+    }
+
+    Stmt read_stmt() {
+        Stmt s;
+        read(s);
+        return s;
+    }
+
+    void read(LoopLevel &l) {
+        uint64_t v = read_varint();
+        if (v) {
+            l = lookup(loop_levels, v - 1, "LoopLevel");
+            return;
+        }
+        string func_name = read_string();
+        string var_name = read_string();
+        bool is_rvar = read_bool();
+        int stage_index = read_int();
+        bool locked = read_bool();
+        l = LoopLevel(func_name, var_name, is_rvar, stage_index, locked);
+        loop_levels.push_back(l);
+    }
+
+    void read(Split &s) {
+        read(s.old_var);
+        read(s.outer);
+        read(s.inner);
+        read(s.factor);
+        s.exact = read_bool();
+        s.tail = (TailStrategy)read_varint();
+        s.split_type = (Split::SplitType)read_varint();
+    }
+
+    void read(Dim &d) {
+        read(d.var);
+        d.for_type = (ForType)read_varint();
+        d.device_api = (DeviceAPI)read_varint();
+        d.dim_type = (Dim::Type)read_varint();
+    }
+
+    void read(Bound &b) {
+        read(b.var);
+        read(b.min);
+        read(b.extent);
+        read(b.modulus);
+        read(b.remainder);
+    }
+
+    void read(StorageDim &d) {
+        read(d.var);
+        read(d.alignment);
+        read(d.fold_factor);
+        d.fold_forward = read_bool();
+    }
+
+    void read(FusedPair &p) {
+        read(p.func_1);
+        read(p.func_2);
+        p.stage_1 = read_varint();
+        p.stage_2 = read_varint();
+        read(p.var_name);
+    }
+
+    void read(StageSchedule &s) {
+        read(s.rvars());
+        read(s.splits());
+        read(s.dims());
+        read(s.prefetches());
+        read(s.fuse_level().level);
+        s.fuse_level().align.clear();
+        size_t num_aligns = read_varint();
+        for (size_t i = 0; i < num_aligns; i++) {
+            string var = read_string();
+            s.fuse_level().align[var] = (LoopAlignStrategy)read_varint();
+        }
+        read(s.fused_pairs());
+        s.touched() = read_bool();
+        s.allow_race_conditions() = read_bool();
+        s.atomic() = read_bool();
+        s.override_atomic_associativity_test() = read_bool();
+    }
+
+    void read(FuncSchedule &s) {
+        read(s.store_level());
+        read(s.compute_level());
+        read(s.storage_dims());
+        read(s.bounds());
+        read(s.estimates());
+        size_t num_wrappers = read_varint();
+        for (size_t i = 0; i < num_wrappers; i++) {
+            string name = read_string();
+            read(s.wrappers()[name]);
+        }
+        s.memory_type() = (MemoryType)read_varint();
+        s.memoized() = read_bool();
+        s.async() = read_bool();
+        s.nontemporal_stores() = read_bool();
+    }
+
+    void read(Specialization &s) {
+        read(s.condition);
+        read(s.definition);
+        read(s.failure_message);
+    }
+
+    void read(Definition &d) {
+        if (!read_bool()) {
+            d = Definition();
+            return;
+        }
+        bool is_init = read_bool();
+        vector<Expr> args, values;
+        read(args);
+        read(values);
+        d = Definition(args, values, ReductionDomain(), is_init);
+        read(d.predicate());
+        read(d.schedule());
+        read(d.specializations());
+    }
+
+    void read(ExternFuncArgument &a) {
+        a.arg_type = (ExternFuncArgument::ArgType)read_varint();
+        read(a.func);
+        read(a.buffer);
+        read(a.expr);
+        read(a.image_param);
+    }
+
+    void read_function_definition(Function &f) {
+        string name = read_string();
+        string origin_name = read_string();
+        vector<Type> output_types;
+        read(output_types);
+        vector<string> args;
+        read(args);
+        FuncSchedule func_schedule;
+        read(func_schedule);
+        Definition init_def;
+        read(init_def);
+        vector<Definition> updates;
+        read(updates);
+        string debug_file = read_string();
+        vector<Parameter> output_buffers;
+        read(output_buffers);
+        vector<ExternFuncArgument> extern_arguments;
+        read(extern_arguments);
+        string extern_function_name = read_string();
+        auto extern_mangling = (NameMangling)read_varint();
+        auto extern_function_device_api = (DeviceAPI)read_varint();
+        Expr extern_proxy_expr = read_expr();
+        bool trace_loads = read_bool();
+        bool trace_stores = read_bool();
+        bool trace_realizations = read_bool();
+        vector<string> trace_tags;
+        read(trace_tags);
+        bool frozen = read_bool();
+        f.update_with_deserialization(name, origin_name, output_types, args, func_schedule,
+                                      init_def, updates, debug_file, output_buffers,
+                                      extern_arguments, extern_function_name, extern_mangling,
+                                      extern_function_device_api, extern_proxy_expr,
+                                      trace_loads, trace_stores, trace_realizations,
+                                      trace_tags, frozen);
+    }
+
+    Target read_target() {
+        return Target(read_string());
+    }
+
+    void read(LoweredArgument &a) {
+        read(a.name);
+        a.kind = (Argument::Kind)read_varint();
+        a.dimensions = (uint8_t)read_varint();
+        read(a.type);
+        read(a.argument_estimates.scalar_def);
+        read(a.argument_estimates.scalar_min);
+        read(a.argument_estimates.scalar_max);
+        read(a.argument_estimates.scalar_estimate);
+        read(a.argument_estimates.buffer_estimates);
+        read(a.alignment);
+    }
+
+    LoweredFunc read_lowered_func() {
+        string name = read_string();
+        vector<LoweredArgument> args;
+        read(args);
+        Stmt body = read_stmt();
+        auto linkage = (LinkageType)read_varint();
+        auto name_mangling = (NameMangling)read_varint();
+        return LoweredFunc(name, args, body, linkage, name_mangling);
+    }
+
+    ExternalCode read_external_code() {
+        auto kind = (ExternalCode::Kind)read_varint();
+        Target llvm_target = read_target();
+        auto device_code_kind = (DeviceAPI)read_varint();
+        vector<uint8_t> code = read_bytes();
+        string nametag = read_string();
+        return ExternalCode(kind, llvm_target, device_code_kind, code, nametag);
+    }
+
+    Module read_module() {
+        string name = read_string();
+        Module m(name, read_target());
+        size_t num_functions = read_varint();
+        for (size_t i = 0; i < num_functions; i++) {
+            m.append(read_lowered_func());
+        }
+        vector<Buffer<>> buffers;
+        read(buffers);
+        for (const Buffer<> &b : buffers) {
+            m.append(b);
+        }
+        size_t num_submodules = read_varint();
+        for (size_t i = 0; i < num_submodules; i++) {
+            m.append(read_module());
+        }
+        size_t num_external_code = read_varint();
+        for (size_t i = 0; i < num_external_code; i++) {
+            m.append(read_external_code());
+        }
+        size_t num_metadata_names = read_varint();
+        for (size_t i = 0; i < num_metadata_names; i++) {
+            string from = read_string();
+            m.remap_metadata_name(from, read_string());
+        }
+        m.set_any_strict_float(read_bool());
+        if (read_bool()) {
+            AutoSchedulerResults results;
+            read(results.scheduler_name);
+            results.target = read_target();
+            read(results.machine_params_string);
+            read(results.schedule_source);
+            results.featurization = read_bytes();
+            m.set_auto_scheduler_results(results);
+        }
+        return m;
+    }
+
+    Pipeline read_pipeline() {
+        vector<Func> outputs;
+        size_t num_outputs = read_varint();
+        for (size_t i = 0; i < num_outputs; i++) {
+            FunctionPtr f;
+            read(f);
+            user_assert(f.defined()) << "Invalid Pipeline in serialized Halide data\n";
+            outputs.emplace_back(Function(f));
+        }
+        vector<Stmt> requirements;
+        read(requirements);
+        return Pipeline(outputs, requirements);
+    }
+
+    // Fill in the definitions of all the Functions, and check that
+    // all of the data was used.
+    void finish() {
+        for (Function &f : functions) {
+            read_function_definition(f);
+        }
+        user_assert(pos == data.size())
+            << "Unexpected trailing data after serialized Halide data\n";
+    }
+};
+
+vector<uint8_t> serialize_expr(const Expr &e) {
+    Serializer s;
+    s.write(e);
+    return s.finish(Payload::Expr);
+}
+
+Expr deserialize_expr(const vector<uint8_t> &data) {
+    map<string, Parameter> params;
+    Deserializer d(data, Payload::Expr, params);
+    Expr e = d.read_expr();
+    d.finish();
+    return e;
+}
+
+vector<uint8_t> serialize_stmt(const Stmt &s) {
+    Serializer w;
+    w.write(s);
+    return w.finish(Payload::Stmt);
+}
+
+Stmt deserialize_stmt(const vector<uint8_t> &data) {
+    map<string, Parameter> params;
+    Deserializer d(data, Payload::Stmt, params);
+    Stmt s = d.read_stmt();
+    d.finish();
+    return s;
+}
+
+vector<uint8_t> serialize_functions(const vector<Function> &funcs) {
+    Serializer s;
+    s.write_varint(funcs.size());
+    for (const Function &f : funcs) {
+        s.write(f.get_contents());
+    }
+    return s.finish(Payload::Functions);
+}
+
+vector<Function> deserialize_functions(const vector<uint8_t> &data,
+                                       const map<string, Parameter> &params) {
+    Deserializer d(data, Payload::Functions, params);
+    vector<Function> funcs;
+    size_t num_funcs = d.read_varint();
+    for (size_t i = 0; i < num_funcs; i++) {
+        FunctionPtr f;
+        d.read(f);
+        user_assert(f.defined()) << "Invalid Function in serialized Halide data\n";
+        funcs.emplace_back(f);
+    }
+    d.finish();
+    return funcs;
+}
+
+namespace {
+
+void check_round_trip(const Expr &e) {
+    Expr result = deserialize_expr(serialize_expr(e));
+    internal_assert(equal(e, result))
+        << "Serialization round trip failed:\n"
+        << e << "\n"
+        << " -> " << result << "\n";
+}
+
+void check_round_trip(const Stmt &s) {
+    Stmt result = deserialize_stmt(serialize_stmt(s));
+    internal_assert(equal(s, result))
+        << "Serialization round trip failed:\n"
+        << s << "\n"
+        << " -> " << result << "\n";
+}
+
+}  // namespace
+
+void serialization_test() {
+    Expr x = Variable::make(Int(32), "x");
+    Expr y = Variable::make(Int(32), "y");
+    Expr f = Variable::make(Float(32), "f");
+
+    check_round_trip(Expr());
+    check_round_trip(x + y * 3);
+    check_round_trip(Expr(-17) - x);
+    check_round_trip(make_const(Int(64), -((int64_t)1 << 62)));
+    check_round_trip(make_const(UInt(64), ~(uint64_t)0));
+    check_round_trip(f * 0.1f + cast<float>(x));
+    check_round_trip(Expr(0.125) / Expr(3.0));
+    check_round_trip(select(x < y && !(y >= 4), min(x, y), max(x % 3, y / 2)));
+    check_round_trip(Let::make("z", x + 1, Variable::make(Int(32), "z") * 2));
+    check_round_trip(Ramp::make(x, 2, 8) + Broadcast::make(y, 8));
+    check_round_trip(Shuffle::make_interleave({Ramp::make(x, 1, 4), Ramp::make(y, 1, 4)}));
+    check_round_trip(Load::make(Float(32), "buf", x, Buffer<>(), Parameter(), const_true(), ModulusRemainder(4, 1)));
+    check_round_trip(Call::make(Int(32), "extern_fn", {x, Expr("a string")}, Call::Extern));
+    check_round_trip(Variable::make(Handle(), "h"));
+
+    // Handle types are preserved.
+    Expr h = reinterpret(type_of<int *>(), make_zero(UInt(64)));
+    Expr h2 = deserialize_expr(serialize_expr(h));
+    internal_assert(h2.type() == h.type() && h2.type().handle_type);
+
+    // Shared subexpressions are shared again after a round trip.
+    Expr shared = x * y + 1;
+    Expr e = deserialize_expr(serialize_expr(shared + shared));
+    const Add *add = e.as<Add>();
+    internal_assert(add && add->a.same_as(add->b));
+
+    // Parameters keep their identity and their values.
+    Parameter p(Int(32), false, 0, "p");
+    p.set_scalar<int>(42);
+    p.set_min_value(Expr(3));
+    Expr pv = Variable::make(Int(32), "p", p);
+    e = deserialize_expr(serialize_expr(pv + pv * 2));
+    add = e.as<Add>();
+    internal_assert(add);
+    const Variable *v1 = add->a.as<Variable>();
+    const Mul *mul = add->b.as<Mul>();
+    internal_assert(v1 && mul);
+    const Variable *v2 = mul->a.as<Variable>();
+    internal_assert(v2 && v1->param.defined() && v1->param.same_as(v2->param) && !v1->param.same_as(p));
+    internal_assert(v1->param.scalar<int>() == 42 && equal(v1->param.min_value(), Expr(3)));
+
+    // Constant images keep their contents.
+    Buffer<int> im(3, 2, "im");
+    im.set_min(1, -1);
+    im.for_each_element([&](int x, int y) { im(x, y) = x * 10 + y; });
+    e = deserialize_expr(serialize_expr(Call::make(Buffer<>(im), {x, y})));
+    const Call *call = e.as<Call>();
+    internal_assert(call && call->image.defined() && call->image.name() == "im");
+    Buffer<int> im2 = call->image;
+    internal_assert(im2.dim(0).min() == 1 && im2.dim(1).min() == -1 && im2(3, 0) == 30);
+
+    Stmt body = Store::make("buf", f, x, Parameter(), const_true(), ModulusRemainder());
+    Stmt loop = For::make("x", 0, y, ForType::Vectorized, DeviceAPI::Host, body);
+    check_round_trip(loop);
+    check_round_trip(Block::make({loop, Evaluate::make(x), Free::make("buf")}));
+    check_round_trip(LetStmt::make("y", 10, IfThenElse::make(x > 0, loop, Stmt())));
+    check_round_trip(Allocate::make("buf", Float(32), MemoryType::Stack, {y, 4}, const_true(), loop));
+    check_round_trip(ProducerConsumer::make_produce("buf", Fork::make(loop, loop)));
+    check_round_trip(AssertStmt::make(x > 0, Call::make(Int(32), "halide_error_fake", {Expr("failed")}, Call::Extern)));
+    check_round_trip(Atomic::make("buf", "", loop));
+
+    std::cout << "Serialization test passed\n";
+}
+
+}  // namespace Internal
+
+std::vector<uint8_t> serialize_pipeline(const Pipeline &pipeline) {
+    user_assert(pipeline.defined()) << "Can't serialize an undefined Pipeline\n";
+    Internal::Serializer s;
+    s.write(pipeline);
+    return s.finish(Internal::Payload::Pipeline);
+}
+
+Pipeline deserialize_pipeline(const std::vector<uint8_t> &data,
+                              const std::map<std::string, Internal::Parameter> &params) {
+    Internal::Deserializer d(data, Internal::Payload::Pipeline, params);
+    Pipeline p = d.read_pipeline();
+    d.finish();
+    return p;
+}
+
+std::vector<uint8_t> serialize_module(const Module &module) {
+    Internal::Serializer s;
+    s.write(module);
+    return s.finish(Internal::Payload::Module);
+}
+
+Module deserialize_module(const std::vector<uint8_t> &data) {
+    std::map<std::string, Internal::Parameter> params;
+    Internal::Deserializer d(data, Internal::Payload::Module, params);
+    Module m = d.read_module();
+    d.finish();
+    return m;
+}
+
+}  // namespace Halide
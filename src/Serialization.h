@@ -0,0 +1,73 @@
+#ifndef HALIDE_SERIALIZATION_H
+#define HALIDE_SERIALIZATION_H
+
+/** \file
+ * Defines a compact, versioned binary format for Halide IR, Functions,
+ * Pipelines, and lowered Modules, and methods to read and write it.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Expr.h"
+#include "Function.h"
+#include "Module.h"
+#include "Parameter.h"
+#include "Pipeline.h"
+
+namespace Halide {
+
+/** Serialize a lowered Module, including its buffers, submodules and
+ * external code, so that it can be compiled later without re-running
+ * lowering. */
+std::vector<uint8_t> serialize_module(const Module &module);
+
+/** Reconstruct a Module written by serialize_module. Asserts if the
+ * data is malformed or was written by an incompatible version of
+ * Halide. */
+Module deserialize_module(const std::vector<uint8_t> &data);
+
+/** Serialize the algorithm and schedule of every Func a Pipeline
+ * depends on, along with the Params, ImageParams, RDoms and constant
+ * images they use. JIT state (handlers, jit externs, custom lowering
+ * passes and compiled code) is not included. */
+std::vector<uint8_t> serialize_pipeline(const Pipeline &pipeline);
+
+/** Reconstruct a Pipeline written by serialize_pipeline. Params and
+ * ImageParams are recreated with their names, constraints, and bound
+ * values. To instead use an existing parameter, e.g. so that it can
+ * be set before realizing, pass it in params, keyed by its name. */
+Pipeline deserialize_pipeline(const std::vector<uint8_t> &data,
+                              const std::map<std::string, Internal::Parameter> &params =
+                                  std::map<std::string, Internal::Parameter>());
+
+namespace Internal {
+
+/** Serialize and deserialize individual pieces of IR. Shared
+ * subexpressions are written once and are shared again when read
+ * back. */
+// @{
+std::vector<uint8_t> serialize_expr(const Expr &e);
+Expr deserialize_expr(const std::vector<uint8_t> &data);
+std::vector<uint8_t> serialize_stmt(const Stmt &s);
+Stmt deserialize_stmt(const std::vector<uint8_t> &data);
+// @}
+
+/** Serialize a set of Functions and everything they transitively
+ * call, and read them back. The deserialized Functions reference
+ * each other (strongly or weakly) exactly as the originals did. */
+// @{
+std::vector<uint8_t> serialize_functions(const std::vector<Function> &funcs);
+std::vector<Function> deserialize_functions(const std::vector<uint8_t> &data,
+                                            const std::map<std::string, Parameter> &params =
+                                                std::map<std::string, Parameter>());
+// @}
+
+void serialization_test();
+
+}  // namespace Internal
+
+}  // namespace Halide
+
+#endif
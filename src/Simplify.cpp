@@ -2,9 +2,14 @@
 #include "Simplify_Internal.h"
 
 #include "CSE.h"
+#include "IREquality.h"
 #include "IRMutator.h"
 #include "Substitute.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
 namespace Halide {
 namespace Internal {
 
@@ -289,10 +294,259 @@ Simplify::ScopedFact::~ScopedFact() {
     }
 }
 
+namespace {
+
+// The things simplifying an Expr depends on, other than the
+// structure of the Expr: the constant bounds and alignment of the
+// variables it refers to, and the identity of the Functions, buffers,
+// parameters, and reduction domains it refers to, which structural
+// equality ignores.
+struct SimplifyCacheKey {
+    struct Referent {
+        FunctionPtr func;
+        Parameter param;
+        Buffer<> image;
+        ReductionDomain rdom;
+
+        bool same_as(const Referent &other) const {
+            return (func.same_as(other.func) &&
+                    param.same_as(other.param) &&
+                    image.get() == other.image.get() &&
+                    rdom.same_as(other.rdom));
+        }
+    };
+
+    Expr expr;
+    bool remove_dead_lets = false;
+    uint64_t hash = 0;
+    vector<pair<string, Simplify::ExprInfo>> facts;
+    vector<Referent> referents;
+
+    bool matches(const SimplifyCacheKey &other) const {
+        if (hash != other.hash ||
+            remove_dead_lets != other.remove_dead_lets ||
+            facts.size() != other.facts.size() ||
+            referents.size() != other.referents.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < facts.size(); i++) {
+            const Simplify::ExprInfo &a = facts[i].second, &b = other.facts[i].second;
+            if (facts[i].first != other.facts[i].first ||
+                a.min_defined != b.min_defined ||
+                a.max_defined != b.max_defined ||
+                (a.min_defined && a.min != b.min) ||
+                (a.max_defined && a.max != b.max) ||
+                !(a.alignment == b.alignment)) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < referents.size(); i++) {
+            if (!referents[i].same_as(other.referents[i])) {
+                return false;
+            }
+        }
+        return equal(expr, other.expr);
+    }
+};
+
+// Walk an Expr as a tree to build its cache key. The hash only
+// depends on things that equal() compares, so equal Exprs get equal
+// hashes. Exprs that are too large to hash cheaply, or that are
+// nasty graphs, aren't worth caching.
+class MakeSimplifyCacheKey : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void mix(uint64_t v) {
+        key.hash ^= v + 0x9e3779b97f4a7c15ULL + (key.hash << 6) + (key.hash >> 2);
+    }
+
+    void include(const Expr &e) override {
+        if (++nodes > max_nodes) {
+            return;
+        }
+        mix((uint64_t)e->node_type);
+        mix(((uint64_t)e.type().code() << 24) | (e.type().bits() << 16) | e.type().lanes());
+        e.accept(this);
+    }
+
+    void add_referent(const FunctionPtr &func, const Parameter &param,
+                      const Buffer<> &image, const ReductionDomain &rdom) {
+        if (func.defined() || param.defined() || image.defined() || rdom.defined()) {
+            key.referents.push_back({func, param, image, rdom});
+        }
+    }
+
+    void visit(const IntImm *op) override {
+        mix((uint64_t)op->value);
+    }
+
+    void visit(const UIntImm *op) override {
+        mix(op->value);
+    }
+
+    void visit(const FloatImm *op) override {
+        mix(reinterpret_bits<uint64_t>(op->value));
+    }
+
+    void visit(const StringImm *op) override {
+        mix(std::hash<string>()(op->value));
+    }
+
+    void visit(const Variable *op) override {
+        mix(std::hash<string>()(op->name));
+        if (std::find(names.begin(), names.end(), op->name) == names.end()) {
+            names.push_back(op->name);
+            // Mirror what the Simplify constructor takes from the scopes.
+            Simplify::ExprInfo info;
+            if (bounds.contains(op->name)) {
+                const Interval &i = bounds.get(op->name);
+                if (const int64_t *i_min = as_const_int(i.min)) {
+                    info.min_defined = true;
+                    info.min = *i_min;
+                }
+                if (const int64_t *i_max = as_const_int(i.max)) {
+                    info.max_defined = true;
+                    info.max = *i_max;
+                }
+            }
+            if (alignment.contains(op->name)) {
+                info.alignment = alignment.get(op->name);
+            }
+            if (info.min_defined || info.max_defined || info.alignment.modulus != 1) {
+                key.facts.emplace_back(op->name, info);
+            }
+        }
+        add_referent(FunctionPtr(), op->param, op->image, op->reduction_domain);
+    }
+
+    void visit(const Load *op) override {
+        mix(std::hash<string>()(op->name));
+        add_referent(FunctionPtr(), op->param, op->image, ReductionDomain());
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Call *op) override {
+        mix(std::hash<string>()(op->name));
+        mix(op->args.size());
+        add_referent(op->func, op->param, op->image, ReductionDomain());
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Let *op) override {
+        mix(std::hash<string>()(op->name));
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Shuffle *op) override {
+        for (int i : op->indices) {
+            mix(i);
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+    const Scope<Interval> &bounds;
+    const Scope<ModulusRemainder> &alignment;
+    vector<string> names;
+    int nodes = 0;
+
+public:
+    static constexpr int max_nodes = 1000;
+
+    SimplifyCacheKey key;
+
+    MakeSimplifyCacheKey(const Expr &e, bool remove_dead_lets,
+                         const Scope<Interval> &bounds,
+                         const Scope<ModulusRemainder> &alignment)
+        : bounds(bounds), alignment(alignment) {
+        key.expr = e;
+        key.remove_dead_lets = remove_dead_lets;
+        mix(remove_dead_lets);
+        include(e);
+        for (const auto &f : key.facts) {
+            mix(f.second.min);
+            mix(f.second.max);
+            mix(f.second.alignment.modulus);
+            mix(f.second.alignment.remainder);
+        }
+    }
+
+    bool cacheable() const {
+        return nodes <= max_nodes;
+    }
+};
+
+// A lossy cache of the results of simplifying Exprs. On collision,
+// the old entry is evicted.
+class SimplifyCache {
+public:
+    std::mutex mutex;
+    std::atomic<bool> enabled;
+    SimplifyCacheStats stats;
+
+    struct Entry {
+        SimplifyCacheKey key;
+        Expr result;
+    };
+    vector<Entry> entries;
+    static constexpr int bits = 12;
+
+    SimplifyCache()
+        : enabled(get_env_variable("HL_SIMPLIFY_CACHE") == "1"),
+          entries((size_t)1 << bits) {
+    }
+
+    void clear() {
+        for (auto &e : entries) {
+            e = Entry();
+        }
+    }
+
+    Expr find(const SimplifyCacheKey &key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Entry &entry = entries[key.hash & ((1 << bits) - 1)];
+        if (entry.key.expr.defined() && entry.key.matches(key)) {
+            stats.hits++;
+            return entry.result;
+        }
+        stats.misses++;
+        return Expr();
+    }
+
+    void insert(SimplifyCacheKey &&key, const Expr &result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry &entry = entries[key.hash & ((1 << bits) - 1)];
+        entry.key = std::move(key);
+        entry.result = result;
+    }
+};
+
+SimplifyCache &simplify_cache() {
+    static SimplifyCache cache;
+    return cache;
+}
+
+}  // namespace
+
 Expr simplify(const Expr &e, bool remove_dead_let_stmts,
               const Scope<Interval> &bounds,
               const Scope<ModulusRemainder> &alignment) {
-    return Simplify(remove_dead_let_stmts, &bounds, &alignment).mutate(e, nullptr);
+    SimplifyCache &cache = simplify_cache();
+    // Constants and variables are cheap to simplify, so don't bother
+    // caching them.
+    if (!cache.enabled || is_const(e) || e.as<Variable>()) {
+        return Simplify(remove_dead_let_stmts, &bounds, &alignment).mutate(e, nullptr);
+    }
+
+    MakeSimplifyCacheKey m(e, remove_dead_let_stmts, bounds, alignment);
+    if (!m.cacheable()) {
+        return Simplify(remove_dead_let_stmts, &bounds, &alignment).mutate(e, nullptr);
+    }
+    Expr result = cache.find(m.key);
+    if (!result.defined()) {
+        result = Simplify(remove_dead_let_stmts, &bounds, &alignment).mutate(e, nullptr);
+        cache.insert(std::move(m.key), result);
+    }
+    return result;
 }
 
 Stmt simplify(const Stmt &s, bool remove_dead_let_stmts,
@@ -359,7 +613,7 @@ bool can_prove(Expr e, const Scope<Interval> &bounds) {
         e = renamer.mutate(e);
 
         // Look for a concrete counter-example with random probing
-        static std::mt19937 rng(0);
+        static thread_local std::mt19937 rng(0);
         for (int i = 0; i < 100; i++) {
             map<string, Expr> s;
             for (auto p : renamer.out_vars) {
@@ -391,5 +645,33 @@ bool can_prove(Expr e, const Scope<Interval> &bounds) {
     return is_one(e);
 }
 
+void set_simplify_cache(bool enabled) {
+    SimplifyCache &cache = simplify_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (!enabled) {
+        cache.clear();
+        cache.stats = SimplifyCacheStats();
+    }
+    cache.enabled = enabled;
+}
+
+void clear_simplify_cache() {
+    SimplifyCache &cache = simplify_cache();
+    if (cache.enabled) {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.clear();
+    }
+}
+
+bool simplify_cache_enabled() {
+    return simplify_cache().enabled;
+}
+
+SimplifyCacheStats simplify_cache_stats() {
+    SimplifyCache &cache = simplify_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.stats;
+}
+
 }  // namespace Internal
 }  // namespace Halide
@@ -36,6 +36,32 @@ bool can_prove(Expr e, const Scope<Interval> &bounds = Scope<Interval>::empty_sc
  * stage in lowering than full simplification of a stmt. */
 Stmt simplify_exprs(const Stmt &);
 
+/** Turn the simplifier's cache on or off. When it is on, the results
+ * of simplifying Exprs are cached, keyed on their structure and on the
+ * bounds and alignment of the variables they refer to, so that
+ * simplifying an equal Expr again under the same facts reuses the
+ * earlier result. The cache holds a bounded number of results, and
+ * evicts older ones on collision. It is off by default, unless the
+ * environment variable HL_SIMPLIFY_CACHE is set to 1. Turning it off
+ * discards all cached results. */
+void set_simplify_cache(bool enabled);
+
+/** Check whether the simplifier's cache is on. */
+bool simplify_cache_enabled();
+
+/** Discard the results held by the simplifier's cache, without
+ * turning it off. The cached Exprs refer to the images, parameters
+ * and Functions of the pipelines they came from, so lower() calls
+ * this when it is done to avoid keeping them alive. */
+void clear_simplify_cache();
+
+/** Counts of Exprs whose simplification was found in, or missing
+ * from, the cache since it was last turned on. */
+struct SimplifyCacheStats {
+    int64_t hits = 0, misses = 0;
+};
+SimplifyCacheStats simplify_cache_stats();
+
 }  // namespace Internal
 }  // namespace Halide
 
@@ -79,6 +79,13 @@ Expr expand_expr(const Expr &e, const Scope<Expr> &scope) {
     return result;
 }
 
+// The loops a function has already been slid along in some dimension,
+// innermost first, and the direction it was slid in.
+struct SlidDimension {
+    std::vector<string> loop_vars;
+    bool slide_up;
+};
+
 }  // namespace
 
 // Perform sliding window optimization for a function over a
@@ -89,6 +96,14 @@ class SlidingWindowOnFunctionAndLoop : public IRMutator {
     Expr loop_min;
     Scope<Expr> scope;
 
+    // The bounds of the loops we're inside of, within the loop we're
+    // sliding over.
+    Scope<Interval> enclosing_loops;
+
+    // The dimensions of the function that have already been slid
+    // along loops inside this one.
+    map<int, SlidDimension> &slid_dimensions;
+
     map<string, Expr> replacements;
 
     using IRMutator::visit;
@@ -110,6 +125,87 @@ class SlidingWindowOnFunctionAndLoop : public IRMutator {
         return true;
     }
 
+    // Slide a dimension that has already been slid along some inner
+    // loops. Those loops only compute the full footprint on their
+    // first iteration, so that's the only iteration left to
+    // shrink. Everything up to the region required on the last
+    // iteration of the inner loops during the previous iteration of
+    // this loop has already been computed.
+    Stmt slide_already_slid_dimension(const Stmt &stmt, const string &prefix, const string &dim,
+                                      SlidDimension &slid, bool can_slide_up, bool can_slide_down,
+                                      const Expr &min_required, const Expr &max_required) {
+        if (!func.updates().empty()) {
+            // The inner slide expanded the bounds of the last stage
+            // to cover the earlier ones, and we'd clobber that.
+            debug(3) << "Not sliding " << func.name()
+                     << " over dimension " << dim
+                     << " along loop variable " << loop_var
+                     << " because it has update definitions and was already slid along an inner loop\n";
+            return stmt;
+        }
+
+        if (slid.slide_up ? !can_slide_up : !can_slide_down) {
+            debug(3) << "Not sliding " << func.name()
+                     << " over dimension " << dim
+                     << " along loop variable " << loop_var
+                     << " because it moves in the opposite direction along an inner loop\n";
+            return stmt;
+        }
+
+        Expr first_inner_iteration = const_true();
+        map<string, Expr> first_inner_values, prev_values;
+        for (const string &v : slid.loop_vars) {
+            if (!enclosing_loops.contains(v)) {
+                debug(3) << "Not sliding " << func.name()
+                         << " over dimension " << dim
+                         << " along loop variable " << loop_var
+                         << " because it was slid along " << v << ", which is not an enclosing loop\n";
+                return stmt;
+            }
+            const Interval &bounds = enclosing_loops.get(v);
+            first_inner_iteration = first_inner_iteration && (Variable::make(Int(32), v) <= bounds.min);
+            first_inner_values[v] = bounds.min;
+            prev_values[v] = bounds.max;
+        }
+
+        Expr loop_var_expr = Variable::make(Int(32), loop_var);
+        prev_values[loop_var] = loop_var_expr - 1;
+        Expr steady_state = loop_var_expr > loop_min && first_inner_iteration;
+
+        Expr min_first = substitute(first_inner_values, min_required);
+        Expr max_first = substitute(first_inner_values, max_required);
+
+        if (slid.slide_up) {
+            Expr prev_max_plus_one = substitute(prev_values, max_required) + 1;
+            if (can_prove(min_first >= prev_max_plus_one)) {
+                debug(3) << "Not sliding " << func.name()
+                         << " over dimension " << dim
+                         << " along loop variable " << loop_var
+                         << " there's no overlap in the region computed across iterations\n";
+                return stmt;
+            }
+            replacements[prefix + dim + ".min"] = select(steady_state, max(prev_max_plus_one, min_required), min_required);
+        } else {
+            Expr prev_min_minus_one = substitute(prev_values, min_required) - 1;
+            if (can_prove(max_first <= prev_min_minus_one)) {
+                debug(3) << "Not sliding " << func.name()
+                         << " over dimension " << dim
+                         << " along loop variable " << loop_var
+                         << " there's no overlap in the region computed across iterations\n";
+                return stmt;
+            }
+            replacements[prefix + dim + ".max"] = select(steady_state, min(prev_min_minus_one, max_required), max_required);
+        }
+
+        debug(3) << "Sliding " << func.name()
+                 << " over dimension " << dim
+                 << " along loop variable " << loop_var
+                 << " on the first iteration of the inner loops it was already slid along\n";
+
+        slid.loop_vars.push_back(loop_var);
+        return stmt;
+    }
+
     Stmt visit(const ProducerConsumer *op) override {
         if (!op->is_producer || (op->name != func.name())) {
             return IRMutator::visit(op);
@@ -213,6 +309,13 @@ class SlidingWindowOnFunctionAndLoop : public IRMutator {
                 return stmt;
             }
 
+            auto slid = slid_dimensions.find(dim_idx);
+            if (slid != slid_dimensions.end()) {
+                return slide_already_slid_dimension(stmt, prefix, dim, slid->second,
+                                                    can_slide_up, can_slide_down,
+                                                    min_required, max_required);
+            }
+
             // Ok, we've isolated a function, a dimension to slide
             // along, and loop variable to slide over.
             debug(3) << "Sliding " << func.name()
@@ -283,6 +386,8 @@ class SlidingWindowOnFunctionAndLoop : public IRMutator {
                     stmt = LetStmt::make(n, max(var, b[dim_idx].max), stmt);
                 }
             }
+
+            slid_dimensions[dim_idx] = {{loop_var}, can_slide_up};
             return stmt;
         }
     }
@@ -307,6 +412,8 @@ class SlidingWindowOnFunctionAndLoop : public IRMutator {
                      << min << ", " << extent << "\n";
             return op;
         } else {
+            ScopedBinding<Interval> bind(enclosing_loops, op->name,
+                                         Interval(min, simplify(min + extent - 1)));
             return IRMutator::visit(op);
         }
     }
@@ -331,8 +438,8 @@ class SlidingWindowOnFunctionAndLoop : public IRMutator {
     }
 
 public:
-    SlidingWindowOnFunctionAndLoop(Function f, string v, Expr v_min)
-        : func(std::move(f)), loop_var(std::move(v)), loop_min(std::move(v_min)) {
+    SlidingWindowOnFunctionAndLoop(Function f, string v, Expr v_min, map<int, SlidDimension> &slid)
+        : func(std::move(f)), loop_var(std::move(v)), loop_min(std::move(v_min)), slid_dimensions(slid) {
     }
 };
 
@@ -340,6 +447,10 @@ public:
 class SlidingWindowOnFunction : public IRMutator {
     Function func;
 
+    // The dimensions we have slid the function along so far, and
+    // the loops we slid them over.
+    map<int, SlidDimension> slid_dimensions;
+
     using IRMutator::visit;
 
     Stmt visit(const For *op) override {
@@ -350,8 +461,9 @@ class SlidingWindowOnFunction : public IRMutator {
         new_body = mutate(new_body);
 
         if (op->for_type == ForType::Serial ||
-            op->for_type == ForType::Unrolled) {
-            new_body = SlidingWindowOnFunctionAndLoop(func, op->name, op->min).mutate(new_body);
+            op->for_type == ForType::Unrolled ||
+            op->for_type == ForType::SoftwarePipelined) {
+            new_body = SlidingWindowOnFunctionAndLoop(func, op->name, op->min, slid_dimensions).mutate(new_body);
         }
 
         if (new_body.same_as(op->body)) {
@@ -404,6 +404,10 @@ private:
             stream << keyword("gpu_thread");
         } else if (op->for_type == ForType::GPULane) {
             stream << keyword("gpu_lane");
+        } else if (op->for_type == ForType::UnrolledAndJammed) {
+            stream << keyword("unrolled_and_jammed");
+        } else if (op->for_type == ForType::SoftwarePipelined) {
+            stream << keyword("software_pipelined");
         } else {
             internal_error << "Unknown for type: " << ((int)op->for_type) << "\n";
         }
@@ -440,7 +440,9 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
     }
 
     Stmt visit(const For *op) override {
-        if (op->for_type != ForType::Serial && op->for_type != ForType::Unrolled) {
+        if (op->for_type != ForType::Serial &&
+            op->for_type != ForType::Unrolled &&
+            op->for_type != ForType::SoftwarePipelined) {
             // We can't proceed into a parallel for loop.
 
             // TODO: If there's no overlap between the region touched
@@ -796,8 +798,19 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
 
         // If there's no communication of values from one loop
         // iteration to the next (which may happen due to sliding),
-        // then we're safe to fold an inner loop.
-        if (box_contains(provided, required)) {
+        // then we're safe to fold an inner loop. If the region
+        // provided depends on whether this is the first iteration,
+        // something was slid along this loop, even if the bounds over
+        // any inner loops make it look like the whole region is
+        // provided on every iteration.
+        bool slid_along_loop = false;
+        Expr steady_state = (op->min < Variable::make(Int(32), op->name));
+        for (const Interval &i : provided.bounds) {
+            slid_along_loop = slid_along_loop ||
+                              !substitute(steady_state, const_true(), i.min).same_as(i.min) ||
+                              !substitute(steady_state, const_true(), i.max).same_as(i.max);
+        }
+        if (!slid_along_loop && box_contains(provided, required)) {
             body = mutate(body);
         }
 
@@ -119,6 +119,7 @@ struct Target {
         WasmSignExt = halide_target_feature_wasm_signext,
         SVE = halide_target_feature_sve,
         SVE2 = halide_target_feature_sve2,
+        LLVMFastCompile = halide_target_feature_llvm_fast_compile,
         FeatureEnd = halide_target_feature_end
     };
     Target()
@@ -1,6 +1,7 @@
 #include "UnrollLoops.h"
 #include "Bounds.h"
 #include "CSE.h"
+#include "ExprUsesVar.h"
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "Simplify.h"
@@ -28,36 +29,122 @@ class UnrollLoops : public IRMutator {
         }
     }
 
-    Stmt visit(const For *for_loop) override {
-        if (for_loop->for_type == ForType::Unrolled) {
-            // Give it one last chance to simplify to an int
-            Expr extent = simplify(for_loop->extent);
-            Stmt body = for_loop->body;
-            const IntImm *e = extent.as<IntImm>();
-
-            if (e == nullptr) {
-                // We're about to hard fail. Get really aggressive
-                // with the simplifier.
-                for (auto it = lets.rbegin(); it != lets.rend(); it++) {
-                    extent = Let::make(it->first, it->second, extent);
-                }
-                extent = remove_likelies(extent);
-                extent = substitute_in_all_lets(extent);
-                extent = simplify(extent);
-                e = extent.as<IntImm>();
+    // Find the number of copies to make when unrolling a loop. If
+    // the extent isn't constant, this is a constant upper bound on
+    // it, if there is one, and use_guard is set. Returns nullptr if
+    // there's no such bound.
+    const IntImm *unrolled_extent(const For *for_loop, Expr &extent, bool &use_guard) {
+        // Give it one last chance to simplify to an int
+        extent = simplify(for_loop->extent);
+        const IntImm *e = extent.as<IntImm>();
+
+        if (e == nullptr) {
+            // We're about to hard fail. Get really aggressive
+            // with the simplifier.
+            for (auto it = lets.rbegin(); it != lets.rend(); it++) {
+                extent = Let::make(it->first, it->second, extent);
+            }
+            extent = remove_likelies(extent);
+            extent = substitute_in_all_lets(extent);
+            extent = simplify(extent);
+            e = extent.as<IntImm>();
+        }
+
+        use_guard = false;
+        if (e == nullptr) {
+            // Still no luck. Try taking an upper bound and
+            // injecting an if statement around the body.
+            Expr extent_upper = find_constant_bound(extent, Direction::Upper, Scope<Interval>());
+            if (extent_upper.defined()) {
+                e = extent_upper.as<IntImm>();
+                use_guard = true;
             }
+        }
+        return e;
+    }
+
+    // Make the copies of the body of an unrolled loop.
+    Stmt unrolled_copies(const For *for_loop, const Stmt &body, int extent, bool use_guard) {
+        Stmt iters;
+        for (int i = extent - 1; i >= 0; i--) {
+            Stmt iter = substitute(for_loop->name, for_loop->min + i, body);
+            if (!iters.defined()) {
+                iters = iter;
+            } else {
+                iters = Block::make(iter, iters);
+            }
+            if (use_guard) {
+                iters = IfThenElse::make(likely_if_innermost(i < for_loop->extent), iters);
+            }
+        }
+        return iters;
+    }
+
+    // Unroll a loop, and jam the copies of the loop directly inside
+    // it into one loop. Returns an undefined Stmt if there's no loop
+    // directly inside (other than lets), or if its bounds depend on
+    // the outer loop.
+    Stmt unroll_and_jam(const For *for_loop) {
+        // Lets that depend on the loop variable go inside each copy,
+        // and the others stay outside the jammed loop.
+        Scope<> varying;
+        varying.push(for_loop->name);
+        vector<const LetStmt *> outer_lets, inner_lets;
+        Stmt body = for_loop->body;
+        while (const LetStmt *let = body.as<LetStmt>()) {
+            if (expr_uses_vars(let->value, varying)) {
+                varying.push(let->name);
+                inner_lets.push_back(let);
+            } else {
+                outer_lets.push_back(let);
+            }
+            body = let->body;
+        }
 
-            Expr extent_upper;
-            bool use_guard = false;
-            if (e == nullptr) {
-                // Still no luck. Try taking an upper bound and
-                // injecting an if statement around the body.
-                extent_upper = find_constant_bound(extent, Direction::Upper, Scope<Interval>());
-                if (extent_upper.defined()) {
-                    e = extent_upper.as<IntImm>();
-                    use_guard = true;
-                }
+        const For *inner = body.as<For>();
+        if (!inner ||
+            expr_uses_vars(inner->min, varying) ||
+            expr_uses_vars(inner->extent, varying)) {
+            return Stmt();
+        }
+
+        Expr extent;
+        bool use_guard;
+        const IntImm *e = unrolled_extent(for_loop, extent, use_guard);
+        if (e == nullptr) {
+            return Stmt();
+        }
+
+        Stmt inner_body = inner->body;
+        for (auto it = inner_lets.rbegin(); it != inner_lets.rend(); it++) {
+            inner_body = LetStmt::make((*it)->name, (*it)->value, inner_body);
+        }
+        inner_body = unrolled_copies(for_loop, inner_body, e->value, use_guard);
+
+        Stmt result = For::make(inner->name, inner->min, inner->extent,
+                                inner->for_type, inner->device_api, inner_body);
+        for (auto it = outer_lets.rbegin(); it != outer_lets.rend(); it++) {
+            result = LetStmt::make((*it)->name, (*it)->value, result);
+        }
+        return result;
+    }
+
+    Stmt visit(const For *for_loop) override {
+        if (for_loop->for_type == ForType::UnrolledAndJammed) {
+            Stmt jammed = unroll_and_jam(for_loop);
+            if (jammed.defined()) {
+                return mutate(jammed);
             }
+            debug(1) << "Can't jam the loop inside " << for_loop->name
+                     << ", so unrolling it without jamming\n";
+        }
+
+        if (for_loop->for_type == ForType::Unrolled ||
+            for_loop->for_type == ForType::UnrolledAndJammed) {
+            Expr extent;
+            bool use_guard;
+            const IntImm *e = unrolled_extent(for_loop, extent, use_guard);
+            Stmt body = for_loop->body;
 
             if (e == nullptr && permit_failed_unroll) {
                 // Still no luck, but we're allowed to fail. Rewrite
@@ -77,20 +164,7 @@ class UnrollLoops : public IRMutator {
                 user_warning << "Warning: Unrolling a for loop of extent 1: " << for_loop->name << "\n";
             }
 
-            Stmt iters;
-            for (int i = e->value - 1; i >= 0; i--) {
-                Stmt iter = substitute(for_loop->name, for_loop->min + i, body);
-                if (!iters.defined()) {
-                    iters = iter;
-                } else {
-                    iters = Block::make(iter, iters);
-                }
-                if (use_guard) {
-                    iters = IfThenElse::make(likely_if_innermost(i < for_loop->extent), iters);
-                }
-            }
-
-            return iters;
+            return unrolled_copies(for_loop, body, e->value, use_guard);
 
         } else {
             return IRMutator::visit(for_loop);
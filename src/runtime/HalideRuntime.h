@@ -327,6 +327,89 @@ extern void halide_join_thread(struct halide_thread *);
  */
 extern int halide_set_num_threads(int n);
 
+/** Priority classes for the parallel work of a pipeline invocation
+ * in the default thread pool. An idle thread always starts on
+ * runnable work of a higher priority before work of a lower one, and
+ * threads working on lower priority parallel loops return to the
+ * pool between chunks of iterations while higher priority work is
+ * outstanding. Running iterations are never preempted. */
+typedef enum halide_thread_pool_priority_t {
+    halide_thread_pool_priority_normal = 0,
+    halide_thread_pool_priority_high = 1,
+} halide_thread_pool_priority_t;
+
+/** Limits on how a pipeline invocation may use the default thread
+ * pool. See halide_set_custom_get_thread_pool_limits. */
+struct halide_thread_pool_limits_t {
+    /** The maximum number of threads, including the one that called
+     * the pipeline, that may work on parallel loops for the same
+     * user_context at once. Zero means no limit. Tasks that may block
+     * (e.g. those produced by async()) are not limited, because
+     * limiting them could deadlock the pipeline. */
+    int max_threads;
+
+    /** The priority of parallel work done for this user_context. */
+    halide_thread_pool_priority_t priority;
+};
+
+/** Look up the thread pool limits for the given user_context. The
+ * default thread pool calls this once per parallel loop, so the
+ * limits of a pipeline invocation can be chosen by the caller via
+ * the user_context it passes in. The default implementation applies
+ * no limit and uses halide_thread_pool_priority_normal. Returns
+ * non-zero on failure, in which case the defaults are used. Only
+ * respected by the default implementations of halide_do_par_for and
+ * halide_do_parallel_tasks. */
+// @{
+typedef int (*halide_get_thread_pool_limits_t)(void *user_context,
+                                               struct halide_thread_pool_limits_t *limits);
+extern halide_get_thread_pool_limits_t halide_set_custom_get_thread_pool_limits(halide_get_thread_pool_limits_t f);
+extern int halide_get_thread_pool_limits(void *user_context,
+                                         struct halide_thread_pool_limits_t *limits);
+extern int halide_default_get_thread_pool_limits(void *user_context,
+                                                 struct halide_thread_pool_limits_t *limits);
+// @}
+
+/** An opaque handle to a pipeline started with
+ * halide_start_pipeline_async. */
+struct halide_async_pipeline_t;
+
+/** The argv-style entry point of a pipeline, e.g. the foo_argv
+ * function generated alongside an AOT-compiled pipeline foo. */
+typedef int (*halide_argv_pipeline_t)(void **args);
+
+/** Called on a thread pool thread when a pipeline started with
+ * halide_start_pipeline_async finishes, with the pipeline's
+ * result. It must not wait on or release the handle. */
+typedef void (*halide_async_pipeline_callback_t)(void *user_context, int result);
+
+/** Run a pipeline on the thread pool without blocking the calling
+ * thread. The args are passed to the pipeline's argv entry point, and
+ * they and everything they point to must remain valid until the
+ * pipeline has finished. The callback may be NULL. Returns NULL if
+ * the handle could not be allocated. The handle must eventually be
+ * released with halide_async_pipeline_release. Only the default
+ * thread pool runs pipelines asynchronously; on platforms without
+ * threads the pipeline runs before this function returns. */
+extern struct halide_async_pipeline_t *halide_start_pipeline_async(void *user_context,
+                                                                   halide_argv_pipeline_t pipeline,
+                                                                   void **args,
+                                                                   halide_async_pipeline_callback_t callback);
+
+/** Check whether an asynchronously started pipeline has finished,
+ * without blocking. If it has, returns true and sets result (if it is
+ * not NULL) to the pipeline's result. */
+extern bool halide_async_pipeline_poll(struct halide_async_pipeline_t *handle, int *result);
+
+/** Wait for an asynchronously started pipeline to finish and return
+ * its result. While waiting, the calling thread helps the thread
+ * pool. Only one thread at a time may wait on a handle. */
+extern int halide_async_pipeline_wait(struct halide_async_pipeline_t *handle);
+
+/** Wait for an asynchronously started pipeline to finish, then free
+ * its handle. */
+extern void halide_async_pipeline_release(struct halide_async_pipeline_t *handle);
+
 /** Halide calls these functions to allocate and free memory. To
  * replace in AOT code, use the halide_set_custom_malloc and
  * halide_set_custom_free, or (on platforms that support weak
@@ -1312,6 +1395,7 @@ typedef enum halide_target_feature_t {
     halide_target_feature_sve,                    ///< Enable ARM Scalable Vector Extensions
     halide_target_feature_sve2,                   ///< Enable ARM Scalable Vector Extensions v2
     halide_target_feature_egl,                    ///< Force use of EGL support.
+    halide_target_feature_llvm_fast_compile,      ///< Run only a minimal LLVM optimization pipeline and instruction selector, trading code quality for compile time. (Ignored for non-LLVM targets.)
 
     halide_target_feature_end  ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
@@ -1644,6 +1728,23 @@ struct halide_filter_metadata_t {
     const char *name;
 };
 
+/** Run a batch of independent invocations of the same pipeline as
+ * the tasks of a single parallel loop on the thread pool. Each entry
+ * of item_args is the argument array for one invocation of the
+ * pipeline's argv entry point, with arguments in the same order as in
+ * the metadata generated alongside it. Before any item runs, the
+ * buffer arguments of every item are checked against the metadata and
+ * against the first item, must have a host pointer and must not be
+ * dirty on a device, and each item is run as a bounds query to check
+ * that its buffers contain the region it will access. So the pipeline
+ * may be compiled with no_asserts, but not with no_bounds_query, and
+ * its other constraints (e.g. on scalar arguments) are not checked.
+ * Returns zero if all the items succeeded, or the error code of one of
+ * them otherwise. */
+extern int halide_do_batch(void *user_context, halide_argv_pipeline_t pipeline,
+                           const struct halide_filter_metadata_t *metadata,
+                           void ***item_args, int num_items);
+
 /** halide_register_argv_and_metadata() is a **user-defined** function that
  * must be provided in order to use the registration.cc files produced
  * by Generators when the 'registration' output is requested. Each registration.cc
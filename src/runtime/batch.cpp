@@ -0,0 +1,186 @@
+#include "HalideRuntime.h"
+#include "printer.h"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+struct batch_closure {
+    halide_argv_pipeline_t pipeline;
+    void ***item_args;
+};
+
+WEAK int run_batch_item(void *user_context, int idx, uint8_t *closure) {
+    batch_closure *c = (batch_closure *)closure;
+    return c->pipeline(c->item_args[idx]);
+}
+
+// Check that a buffer argument of a batch item has the same shape as
+// in the first item.
+WEAK int check_batch_buffer(void *user_context, const char *name, int item,
+                            const halide_buffer_t *buf, const halide_buffer_t *first) {
+    if (buf == NULL) {
+        error(user_context) << "Buffer argument " << name << " is NULL in batch item " << item;
+        return halide_error_code_buffer_argument_is_null;
+    }
+    if (buf->type != first->type) {
+        error(user_context) << "Buffer argument " << name << " has type " << buf->type
+                            << " in batch item " << item << " but type " << first->type
+                            << " in batch item 0";
+        return halide_error_code_bad_type;
+    }
+    if (buf->dimensions != first->dimensions) {
+        error(user_context) << "Buffer argument " << name << " has " << buf->dimensions
+                            << " dimensions in batch item " << item << " but "
+                            << first->dimensions << " in batch item 0";
+        return halide_error_code_bad_dimensions;
+    }
+    for (int d = 0; d < buf->dimensions; d++) {
+        if (buf->dim[d].min != first->dim[d].min ||
+            buf->dim[d].extent != first->dim[d].extent ||
+            buf->dim[d].stride != first->dim[d].stride) {
+            error(user_context) << "Buffer argument " << name << " has a different shape in dimension "
+                                << d << " in batch item " << item << " than in batch item 0";
+            return halide_error_code_constraint_violated;
+        }
+    }
+    return 0;
+}
+
+// Check that a buffer can be used on the host.
+WEAK int check_batch_host(void *user_context, const char *name, const halide_buffer_t *buf) {
+    if (buf->host == NULL) {
+        return halide_error_host_is_null(user_context, name);
+    }
+    if (buf->device_dirty()) {
+        return halide_error_device_dirty_with_no_device_support(user_context, name);
+    }
+    return 0;
+}
+
+// Check that a buffer contains the region a bounds query asked for.
+WEAK int check_batch_region(void *user_context, const char *name,
+                            const halide_buffer_t *buf, const halide_buffer_t *required) {
+    for (int d = 0; d < buf->dimensions; d++) {
+        int min = buf->dim[d].min;
+        int max = min + buf->dim[d].extent - 1;
+        int required_min = required->dim[d].min;
+        int required_max = required_min + required->dim[d].extent - 1;
+        if (required->dim[d].extent > 0 &&
+            (required_min < min || required_max > max)) {
+            return halide_error_access_out_of_bounds(user_context, name, d,
+                                                     required_min, required_max, min, max);
+        }
+    }
+    return 0;
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK int halide_do_batch(void *user_context, halide_argv_pipeline_t pipeline,
+                         const halide_filter_metadata_t *metadata,
+                         void ***item_args, int num_items) {
+    if (num_items <= 0) {
+        return 0;
+    }
+
+    // Validate the buffer arguments of all the items up front, so
+    // that the items can be run by a pipeline compiled without its
+    // own checks.
+    const int num_args = metadata->num_arguments;
+    int num_dims = 0;
+    for (int i = 0; i < num_args; i++) {
+        const halide_filter_argument_t &arg = metadata->arguments[i];
+        if (arg.kind == halide_argument_kind_input_scalar) {
+            continue;
+        }
+        const halide_buffer_t *first = (const halide_buffer_t *)item_args[0][i];
+        if (first == NULL) {
+            return halide_error_buffer_argument_is_null(user_context, arg.name);
+        }
+        if (first->type != arg.type) {
+            uint32_t type_given_bits, correct_type_bits;
+            memcpy(&type_given_bits, &first->type, sizeof(uint32_t));
+            memcpy(&correct_type_bits, &arg.type, sizeof(uint32_t));
+            return halide_error_bad_type(user_context, arg.name, type_given_bits, correct_type_bits);
+        }
+        if (first->dimensions != arg.dimensions) {
+            return halide_error_bad_dimensions(user_context, arg.name, first->dimensions, arg.dimensions);
+        }
+        num_dims += arg.dimensions;
+        for (int j = 0; j < num_items; j++) {
+            const halide_buffer_t *buf = (const halide_buffer_t *)item_args[j][i];
+            int result = check_batch_buffer(user_context, arg.name, j, buf, first);
+            if (result == 0) {
+                result = check_batch_host(user_context, arg.name, buf);
+            }
+            if (result != 0) {
+                return result;
+            }
+        }
+    }
+
+    // Ask the pipeline what region of each buffer every item will
+    // touch, and check that it's there. Scalar arguments may differ
+    // between items, and may change the region, so each item gets a
+    // bounds query of its own. A pipeline compiled without bounds
+    // query support would run instead, with no host buffers.
+    if (strstr(metadata->target, "no_bounds_query") != NULL) {
+        error(user_context) << "halide_do_batch can't check the items of a pipeline "
+                            << "compiled with no_bounds_query";
+        return halide_error_code_generic_error;
+    }
+    void **query_args = (void **)__builtin_alloca(num_args * sizeof(void *));
+    halide_buffer_t *query_bufs = (halide_buffer_t *)__builtin_alloca(num_args * sizeof(halide_buffer_t));
+    halide_dimension_t *query_dims = (halide_dimension_t *)__builtin_alloca(num_dims * sizeof(halide_dimension_t));
+    for (int j = 0; j < num_items; j++) {
+        halide_dimension_t *dims = query_dims;
+        for (int i = 0; i < num_args; i++) {
+            if (metadata->arguments[i].kind == halide_argument_kind_input_scalar) {
+                query_args[i] = item_args[j][i];
+                continue;
+            }
+            const halide_buffer_t *buf = (const halide_buffer_t *)item_args[j][i];
+            halide_buffer_t &query = query_bufs[i];
+            query = *buf;
+            query.host = NULL;
+            query.device = 0;
+            query.device_interface = NULL;
+            query.flags = 0;
+            query.dim = dims;
+            memcpy(dims, buf->dim, buf->dimensions * sizeof(halide_dimension_t));
+            dims += buf->dimensions;
+            query_args[i] = &query;
+        }
+        int result = pipeline(query_args);
+        if (result != 0) {
+            return result;
+        }
+        for (int i = 0; i < num_args; i++) {
+            const halide_filter_argument_t &arg = metadata->arguments[i];
+            if (arg.kind == halide_argument_kind_input_scalar) {
+                continue;
+            }
+            result = check_batch_region(user_context, arg.name,
+                                        (const halide_buffer_t *)item_args[j][i], &query_bufs[i]);
+            if (result != 0) {
+                return result;
+            }
+        }
+    }
+
+    // Run all the items as a single parallel job, so that the thread
+    // pool is only woken once.
+    batch_closure closure;
+    closure.pipeline = pipeline;
+    closure.item_args = item_args;
+    return halide_do_par_for(user_context, run_batch_item, 0, num_items, (uint8_t *)&closure);
+}
+
+}  // extern "C"
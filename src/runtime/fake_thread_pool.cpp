@@ -114,6 +114,63 @@ WEAK int halide_set_num_threads(int n) {
     return 1;
 }
 
+WEAK int halide_default_get_thread_pool_limits(void *user_context,
+                                               halide_thread_pool_limits_t *limits) {
+    limits->max_threads = 0;
+    limits->priority = halide_thread_pool_priority_normal;
+    return 0;
+}
+
+WEAK halide_get_thread_pool_limits_t halide_set_custom_get_thread_pool_limits(halide_get_thread_pool_limits_t f) {
+    // There is only one thread, so there is nothing to limit or prioritize.
+    return halide_default_get_thread_pool_limits;
+}
+
+WEAK int halide_get_thread_pool_limits(void *user_context,
+                                       halide_thread_pool_limits_t *limits) {
+    return halide_default_get_thread_pool_limits(user_context, limits);
+}
+
+struct halide_async_pipeline_t {
+    void *user_context;
+    int result;
+};
+
+WEAK halide_async_pipeline_t *halide_start_pipeline_async(void *user_context,
+                                                          halide_argv_pipeline_t pipeline,
+                                                          void **args,
+                                                          halide_async_pipeline_callback_t callback) {
+    halide_async_pipeline_t *p =
+        (halide_async_pipeline_t *)halide_malloc(user_context, sizeof(halide_async_pipeline_t));
+    if (p == NULL) {
+        return NULL;
+    }
+    // There are no other threads to run it on, so run it now.
+    p->user_context = user_context;
+    p->result = pipeline(args);
+    if (callback) {
+        callback(user_context, p->result);
+    }
+    return p;
+}
+
+WEAK bool halide_async_pipeline_poll(halide_async_pipeline_t *p, int *result) {
+    if (result) {
+        *result = p->result;
+    }
+    return true;
+}
+
+WEAK int halide_async_pipeline_wait(halide_async_pipeline_t *p) {
+    return p->result;
+}
+
+WEAK void halide_async_pipeline_release(halide_async_pipeline_t *p) {
+    if (p != NULL) {
+        halide_free(p->user_context, p);
+    }
+}
+
 WEAK halide_do_task_t halide_set_custom_do_task(halide_do_task_t f) {
     halide_do_task_t result = custom_do_task;
     custom_do_task = f;
@@ -17,6 +17,9 @@
 // cat src/runtime/runtime_internal.h src/runtime/HalideRuntime*.h | grep "^[^ ][^(]*halide_[^ ]*(" | grep -v '#define' | sed "s/[^(]*halide/halide/" | sed "s/(.*//" | sed "s/^h/    \(void *)\&h/" | sed "s/$/,/" | sort | uniq
 
 extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
+    (void *)&halide_async_pipeline_poll,
+    (void *)&halide_async_pipeline_release,
+    (void *)&halide_async_pipeline_wait,
     (void *)&halide_buffer_copy,
     (void *)&halide_buffer_to_string,
     (void *)&halide_can_use_target_features,
@@ -34,6 +37,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_current_time_ns,
     (void *)&halide_debug_to_file,
     (void *)&halide_default_can_use_target_features,
+    (void *)&halide_default_get_thread_pool_limits,
     (void *)&halide_device_and_host_free,
     (void *)&halide_device_and_host_free_as_destructor,
     (void *)&halide_device_and_host_malloc,
@@ -43,6 +47,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_device_malloc,
     (void *)&halide_device_release,
     (void *)&halide_device_sync,
+    (void *)&halide_do_batch,
     (void *)&halide_do_par_for,
     (void *)&halide_do_parallel_tasks,
     (void *)&halide_do_task,
@@ -84,6 +89,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_get_gpu_device,
     (void *)&halide_get_library_symbol,
     (void *)&halide_get_symbol,
+    (void *)&halide_get_thread_pool_limits,
     (void *)&halide_get_trace_file,
     (void *)&halide_hexagon_detach_device_handle,
     (void *)&halide_hexagon_device_interface,
@@ -179,6 +185,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_set_custom_free,
     (void *)&halide_set_custom_get_library_symbol,
     (void *)&halide_set_custom_get_symbol,
+    (void *)&halide_set_custom_get_thread_pool_limits,
     (void *)&halide_set_custom_load_library,
     (void *)&halide_set_custom_malloc,
     (void *)&halide_set_custom_print,
@@ -192,6 +199,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_sleep_ms,
     (void *)&halide_spawn_thread,
     (void *)&halide_start_clock,
+    (void *)&halide_start_pipeline_async,
     (void *)&halide_string_to_string,
     (void *)&halide_trace,
     (void *)&halide_trace_helper,
@@ -40,6 +40,12 @@ struct work {
     int active_workers;
     int exit_status;
     int next_semaphore;
+    // The next iteration to be claimed, relative to task.min, for
+    // jobs whose iterations are claimed without holding the lock.
+    int next_iteration;
+    // The limits from halide_get_thread_pool_limits for user_context.
+    int max_threads;
+    halide_thread_pool_priority_t priority;
     // which condition variable is the owner sleeping on. NULL if it isn't sleeping.
     bool owner_is_sleeping;
 
@@ -62,6 +68,19 @@ struct work {
     bool running() {
         return task.extent || active_workers;
     }
+
+    // Jobs that can't block and have no semaphores to acquire can
+    // have their iterations claimed by atomically incrementing
+    // next_iteration instead of taking the lock for each one.
+    bool claims_iterations_atomically() {
+        return !task.serial && task.num_semaphores == 0 && task.min_threads == 0;
+    }
+
+    // Whether max_threads applies to this job. Jobs that may block
+    // are never limited, as they may need more threads to complete.
+    bool thread_limited() {
+        return max_threads > 0 && task.min_threads == 0;
+    }
 };
 
 #define MAX_THREADS 256
@@ -90,6 +109,14 @@ WEAK int default_desired_num_threads() {
     return desired_num_threads;
 }
 
+// The number of threads from the pool that are helping with
+// thread-limited jobs for some user_context. The thread that owns a
+// job for a user_context is not counted.
+struct limited_context {
+    void *user_context;
+    int helpers;
+};
+
 // The work queue and thread pool is weak, so one big work queue is shared by all halide functions
 struct work_queue_t {
     // all fields are protected by this mutex.
@@ -138,6 +165,17 @@ struct work_queue_t {
     // to prevent deadlock due to oversubscription of threads.
     int threads_reserved;
 
+    // The user_contexts with threads helping on their thread-limited
+    // jobs. Each helper is a distinct busy thread, so there can't be
+    // more than MAX_THREADS of them.
+    limited_context limited_contexts[MAX_THREADS];
+    int num_limited_contexts;
+
+    // The number of high priority jobs that have been enqueued and
+    // have not yet been completed. Read without the lock by workers
+    // on lower priority jobs, so always accessed atomically.
+    int high_priority_jobs;
+
     bool running() const {
         return !shutdown;
     }
@@ -194,6 +232,98 @@ WEAK void dump_job_state() {
 
 WEAK void worker_thread(void *);
 
+// Find the entry for user_context in work_queue.limited_contexts,
+// or NULL if no thread is helping with its jobs. Must be called with
+// the lock held.
+WEAK limited_context *find_limited_context(void *user_context) {
+    for (int i = 0; i < work_queue.num_limited_contexts; i++) {
+        if (work_queue.limited_contexts[i].user_context == user_context) {
+            return &work_queue.limited_contexts[i];
+        }
+    }
+    return NULL;
+}
+
+// Whether this thread may start working on a job, given the limit on
+// the number of threads helping with jobs for its user_context. A
+// thread that owns a job for the same user_context is already
+// working on its behalf, so it doesn't count towards the limit.
+WEAK bool needs_helper_slot(work *job, work *owned_job) {
+    return job->thread_limited() &&
+           !(owned_job && owned_job->user_context == job->user_context);
+}
+
+WEAK bool helper_slot_available(work *job) {
+    limited_context *c = find_limited_context(job->user_context);
+    // The thread that called the pipeline counts towards max_threads.
+    return !c || c->helpers < job->max_threads - 1;
+}
+
+WEAK void acquire_helper_slot(void *user_context) {
+    limited_context *c = find_limited_context(user_context);
+    if (!c) {
+        halide_assert(NULL, work_queue.num_limited_contexts < MAX_THREADS);
+        c = &work_queue.limited_contexts[work_queue.num_limited_contexts++];
+        c->user_context = user_context;
+        c->helpers = 0;
+    }
+    c->helpers++;
+}
+
+WEAK void release_helper_slot(void *user_context) {
+    limited_context *c = find_limited_context(user_context);
+    halide_assert(NULL, c && c->helpers > 0);
+    if (--c->helpers == 0) {
+        *c = work_queue.limited_contexts[--work_queue.num_limited_contexts];
+    }
+}
+
+// Run iterations of a job that claims them atomically, until they've
+// all been claimed or one of them fails. Iterations are claimed in
+// chunks that shrink as the job nears completion, so that cheap
+// iterations don't all pay for an atomic operation, but the last few
+// are still spread across the threads. Workers on normal priority
+// jobs return to the pool after each chunk if there is high priority
+// work outstanding. Called without the lock held.
+WEAK int run_claimed_iterations(work *job, int extent, int threads) {
+    int result = 0;
+    while (result == 0) {
+        int claimed;
+        Synchronization::atomic_load_relaxed(&job->next_iteration, &claimed);
+        int chunk = (extent - claimed) / (2 * threads);
+        if (chunk < 1) {
+            chunk = 1;
+        }
+        int start = Synchronization::atomic_fetch_add_acquire_release(&job->next_iteration, chunk);
+        if (start >= extent) {
+            break;
+        }
+        int end = start + chunk < extent ? start + chunk : extent;
+        if (job->task_fn) {
+            for (int i = start; i < end && result == 0; i++) {
+                result = halide_do_task(job->user_context, job->task_fn,
+                                        job->task.min + i, job->task.closure);
+            }
+        } else {
+            result = halide_do_loop_task(job->user_context, job->task.fn,
+                                         job->task.min + start, end - start,
+                                         job->task.closure, job);
+        }
+        if (job->priority == halide_thread_pool_priority_normal) {
+            int high_priority_jobs;
+            Synchronization::atomic_load_relaxed(&work_queue.high_priority_jobs, &high_priority_jobs);
+            if (high_priority_jobs > 0) {
+                break;
+            }
+        }
+    }
+    if (result != 0) {
+        // Stop the other workers from claiming any more iterations.
+        Synchronization::atomic_store_release(&job->next_iteration, &extent);
+    }
+    return result;
+}
+
 WEAK void worker_thread_already_locked(work *owned_job) {
     while (owned_job ? owned_job->running() : !work_queue.shutdown) {
         work *job = work_queue.jobs;
@@ -222,8 +352,31 @@ WEAK void worker_thread_already_locked(work *owned_job) {
 
         dump_job_state();
 
-        // Find a job to run, prefering things near the top of the stack.
-        while (job) {
+        // Find a job to run, prefering high priority jobs, and then
+        // things near the top of the stack.
+        int high_priority_jobs;
+        Synchronization::atomic_load_relaxed(&work_queue.high_priority_jobs, &high_priority_jobs);
+        halide_thread_pool_priority_t priority =
+            high_priority_jobs > 0 ? halide_thread_pool_priority_high : halide_thread_pool_priority_normal;
+        while (true) {
+            if (!job) {
+                // Nothing of this priority is runnable. Try the next
+                // one down, unless we own a job of this priority, in
+                // which case taking on lower priority work could delay it.
+                if (priority == halide_thread_pool_priority_normal ||
+                    (owned_job && owned_job->priority == priority)) {
+                    break;
+                }
+                priority = halide_thread_pool_priority_normal;
+                job = work_queue.jobs;
+                prev_ptr = &work_queue.jobs;
+                continue;
+            }
+            if (job->priority != priority) {
+                prev_ptr = &(job->next_job);
+                job = job->next_job;
+                continue;
+            }
             print_job(job, "", "Considering job ");
             // Only schedule tasks with enough free worker threads
             // around to complete. They may get stolen later, but only
@@ -258,8 +411,12 @@ WEAK void worker_thread_already_locked(work *owned_job) {
             if (!can_add_worker) {
                 log_message("Cannot add worker to job " << job->task.name);
             }
+            bool under_thread_limit = !needs_helper_slot(job, owned_job) || helper_slot_available(job);
+            if (!under_thread_limit) {
+                log_message("Thread limit reached for job " << job->task.name);
+            }
 
-            if (enough_threads && can_use_this_thread_stack && can_add_worker) {
+            if (enough_threads && can_use_this_thread_stack && can_add_worker && under_thread_limit) {
                 if (job->make_runnable()) {
                     break;
                 } else {
@@ -300,6 +457,11 @@ WEAK void worker_thread_already_locked(work *owned_job) {
         // though there are no outstanding tasks for it.
         job->active_workers++;
 
+        bool helping = needs_helper_slot(job, owned_job);
+        if (helping) {
+            acquire_helper_slot(job->user_context);
+        }
+
         if (job->parent_job == NULL) {
             work_queue.threads_reserved += job->task.min_threads;
             log_message("Reserved " << job->task.min_threads << " on work queue for " << job->task.name << " giving " << work_queue.threads_reserved << " of " << work_queue.threads_created + 1);
@@ -345,6 +507,30 @@ WEAK void worker_thread_already_locked(work *owned_job) {
                 job->next_job = work_queue.jobs;
                 work_queue.jobs = job;
             }
+        } else if (job->claims_iterations_atomically()) {
+            int extent = job->task.extent;
+            int threads = work_queue.threads_created + 1;
+            if (job->thread_limited() && job->max_threads < threads) {
+                threads = job->max_threads;
+            }
+
+            // Release the lock and do the tasks.
+            halide_mutex_unlock(&work_queue.mutex);
+            result = run_claimed_iterations(job, extent, threads);
+            halide_mutex_lock(&work_queue.mutex);
+
+            // If this was the first worker to run out of iterations
+            // to claim, remove the job from the stack.
+            int claimed;
+            Synchronization::atomic_load_relaxed(&job->next_iteration, &claimed);
+            if (job->task.extent != 0 && claimed >= job->task.extent) {
+                prev_ptr = &work_queue.jobs;
+                while (*prev_ptr != job) {
+                    prev_ptr = &(*prev_ptr)->next_job;
+                }
+                *prev_ptr = job->next_job;
+                job->task.extent = 0;
+            }
         } else {
             // Claim a task from it.
             work myjob = *job;
@@ -398,6 +584,10 @@ WEAK void worker_thread_already_locked(work *owned_job) {
             log_message("Returned " << job->task.min_threads << " to " << job->parent_job->task.name << " for " << job->task.name << " giving " << job->parent_job->threads_reserved << " of " << job->parent_job->task.min_threads);
         }
 
+        if (helping) {
+            release_helper_slot(job->user_context);
+        }
+
         // We are no longer active on this job
         job->active_workers--;
 
@@ -458,6 +648,10 @@ WEAK void enqueue_work_already_locked(int num_jobs, work *jobs, work *task_paren
             job_has_acquires = true;
         }
 
+        if (jobs[i].priority == halide_thread_pool_priority_high) {
+            Synchronization::atomic_fetch_add_acquire_release(&work_queue.high_priority_jobs, 1);
+        }
+
         if (jobs[i].task.serial) {
             workers_to_wake++;
         } else {
@@ -552,6 +746,33 @@ WEAK halide_do_parallel_tasks_t custom_do_parallel_tasks = halide_default_do_par
 WEAK halide_semaphore_init_t custom_semaphore_init = halide_default_semaphore_init;
 WEAK halide_semaphore_try_acquire_t custom_semaphore_try_acquire = halide_default_semaphore_try_acquire;
 WEAK halide_semaphore_release_t custom_semaphore_release = halide_default_semaphore_release;
+WEAK halide_get_thread_pool_limits_t custom_get_thread_pool_limits = halide_default_get_thread_pool_limits;
+
+// Set the limits of a job. Nested jobs inherit the limits of their
+// parent. Must be called without the lock held, as it may call into
+// user code.
+WEAK void set_job_limits(work *job, void *user_context, work *parent_job) {
+    if (parent_job) {
+        job->max_threads = parent_job->max_threads;
+        job->priority = parent_job->priority;
+        return;
+    }
+    halide_thread_pool_limits_t limits;
+    if (halide_get_thread_pool_limits(user_context, &limits) != 0) {
+        halide_default_get_thread_pool_limits(user_context, &limits);
+    }
+    job->max_threads = limits.max_threads > 0 ? limits.max_threads : 0;
+    job->priority = limits.priority > halide_thread_pool_priority_normal ?
+                        halide_thread_pool_priority_high :
+                        halide_thread_pool_priority_normal;
+}
+
+// Called by the owner of a job once it has completed, with the lock held.
+WEAK void job_finished(work *job) {
+    if (job->priority == halide_thread_pool_priority_high) {
+        Synchronization::atomic_fetch_add_acquire_release(&work_queue.high_priority_jobs, -1);
+    }
+}
 
 }  // namespace Internal
 }  // namespace Runtime
@@ -599,13 +820,16 @@ WEAK int halide_default_do_par_for(void *user_context, halide_task_t f,
     job.exit_status = 0;
     job.active_workers = 0;
     job.next_semaphore = 0;
+    job.next_iteration = 0;
     job.owner_is_sleeping = false;
     job.siblings = &job;  // guarantees no other job points to the same siblings.
     job.sibling_count = 0;
     job.parent_job = NULL;
+    set_job_limits(&job, user_context, NULL);
     halide_mutex_lock(&work_queue.mutex);
     enqueue_work_already_locked(1, &job, NULL);
     worker_thread_already_locked(&job);
+    job_finished(&job);
     halide_mutex_unlock(&work_queue.mutex);
     return job.exit_status;
 }
@@ -627,8 +851,10 @@ WEAK int halide_default_do_parallel_tasks(void *user_context, int num_tasks,
         jobs[i].exit_status = 0;
         jobs[i].active_workers = 0;
         jobs[i].next_semaphore = 0;
+        jobs[i].next_iteration = 0;
         jobs[i].owner_is_sleeping = false;
         jobs[i].parent_job = (work *)task_parent;
+        set_job_limits(jobs + i, user_context, (work *)task_parent);
     }
 
     if (num_tasks == 0) {
@@ -642,6 +868,7 @@ WEAK int halide_default_do_parallel_tasks(void *user_context, int num_tasks,
         // It doesn't matter what order we join the tasks in, because
         // we'll happily assist with siblings too.
         worker_thread_already_locked(jobs + i);
+        job_finished(jobs + i);
         if (jobs[i].exit_status != 0) {
             exit_status = jobs[i].exit_status;
         }
@@ -650,6 +877,111 @@ WEAK int halide_default_do_parallel_tasks(void *user_context, int num_tasks,
     return exit_status;
 }
 
+struct halide_async_pipeline_t {
+    work job;
+    halide_argv_pipeline_t pipeline;
+    void **args;
+    halide_async_pipeline_callback_t callback;
+    int result;
+};
+
+namespace {
+
+WEAK int run_async_pipeline(void *user_context, int idx, uint8_t *closure) {
+    halide_async_pipeline_t *p = (halide_async_pipeline_t *)closure;
+    // The result is reported through the handle rather than as the
+    // exit status of the job, which is only for failures of the task
+    // system.
+    p->result = p->pipeline(p->args);
+    if (p->callback) {
+        p->callback(user_context, p->result);
+    }
+    job_finished(&p->job);
+    return 0;
+}
+
+}  // namespace
+
+WEAK halide_async_pipeline_t *halide_start_pipeline_async(void *user_context,
+                                                          halide_argv_pipeline_t pipeline,
+                                                          void **args,
+                                                          halide_async_pipeline_callback_t callback) {
+    halide_async_pipeline_t *p =
+        (halide_async_pipeline_t *)halide_malloc(user_context, sizeof(halide_async_pipeline_t));
+    if (p == NULL) {
+        return NULL;
+    }
+    p->pipeline = pipeline;
+    p->args = args;
+    p->callback = callback;
+    p->result = 0;
+
+    // A job with a single task that runs the pipeline. Unlike other
+    // jobs, its owner doesn't work on it until someone waits on it.
+    // It may run for a long time, so it is queued as a task that
+    // needs a thread of its own, like an extern stage that blocks:
+    // it reserves a pool thread while it runs, and the owner of some
+    // other job can't pick it up and be stuck in it long after its
+    // own job has finished.
+    work &job = p->job;
+    job.task.fn = NULL;
+    job.task.min = 0;
+    job.task.extent = 1;
+    job.task.serial = false;
+    job.task.semaphores = NULL;
+    job.task.num_semaphores = 0;
+    job.task.closure = (uint8_t *)p;
+    job.task.min_threads = 1;
+    job.task.name = "async pipeline";
+    job.task_fn = run_async_pipeline;
+    job.user_context = user_context;
+    job.exit_status = 0;
+    job.active_workers = 0;
+    job.next_semaphore = 0;
+    job.next_iteration = 0;
+    job.owner_is_sleeping = false;
+    job.siblings = &job;
+    job.sibling_count = 0;
+    job.parent_job = NULL;
+    set_job_limits(&job, user_context, NULL);
+    halide_mutex_lock(&work_queue.mutex);
+    // Enqueuing a job that needs a thread makes sure the pool has one
+    // beyond the calling thread. The calling thread isn't going to
+    // work on it though, so make sure that thread is awake.
+    enqueue_work_already_locked(1, &job, NULL);
+    if (work_queue.target_a_team_size < 1) {
+        work_queue.target_a_team_size = 1;
+        halide_cond_broadcast(&work_queue.wake_b_team);
+    }
+    halide_mutex_unlock(&work_queue.mutex);
+    return p;
+}
+
+WEAK bool halide_async_pipeline_poll(halide_async_pipeline_t *p, int *result) {
+    halide_mutex_lock(&work_queue.mutex);
+    bool done = !p->job.running();
+    halide_mutex_unlock(&work_queue.mutex);
+    if (done && result) {
+        *result = p->result;
+    }
+    return done;
+}
+
+WEAK int halide_async_pipeline_wait(halide_async_pipeline_t *p) {
+    halide_mutex_lock(&work_queue.mutex);
+    worker_thread_already_locked(&p->job);
+    halide_mutex_unlock(&work_queue.mutex);
+    return p->result;
+}
+
+WEAK void halide_async_pipeline_release(halide_async_pipeline_t *p) {
+    if (p == NULL) {
+        return;
+    }
+    halide_async_pipeline_wait(p);
+    halide_free(p->job.user_context, p);
+}
+
 WEAK int halide_set_num_threads(int n) {
     if (n < 0) {
         halide_error(NULL, "halide_set_num_threads: must be >= 0.");
@@ -667,6 +999,24 @@ WEAK int halide_set_num_threads(int n) {
     return old;
 }
 
+WEAK int halide_default_get_thread_pool_limits(void *user_context,
+                                               halide_thread_pool_limits_t *limits) {
+    limits->max_threads = 0;
+    limits->priority = halide_thread_pool_priority_normal;
+    return 0;
+}
+
+WEAK halide_get_thread_pool_limits_t halide_set_custom_get_thread_pool_limits(halide_get_thread_pool_limits_t f) {
+    halide_get_thread_pool_limits_t result = custom_get_thread_pool_limits;
+    custom_get_thread_pool_limits = f;
+    return result;
+}
+
+WEAK int halide_get_thread_pool_limits(void *user_context,
+                                       halide_thread_pool_limits_t *limits) {
+    return custom_get_thread_pool_limits(user_context, limits);
+}
+
 WEAK void halide_shutdown_thread_pool() {
     if (work_queue.initialized) {
         // Wake everyone up and tell them the party's over and it's time
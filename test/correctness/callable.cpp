@@ -0,0 +1,122 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <thread>
+
+using namespace Halide;
+
+int error_count = 0;
+void my_error_handler(void *user_context, const char *msg) {
+    error_count++;
+}
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("Skipping test for WebAssembly as it does not support compile_to_callable.\n");
+        return 0;
+    }
+
+    ImageParam in(Int(32), 2);
+    Param<int> p;
+    Param<float> q;
+    Var x, y;
+
+    Func f;
+    f(x, y) = in(x, y) * p + cast<int>(q) + x;
+    f.set_error_handler(my_error_handler);
+
+    Callable c = f.compile_to_callable({in, p, q});
+
+    if (c.arguments().size() != 4 || !c.arguments()[3].is_output()) {
+        printf("Callable has the wrong argument list\n");
+        return -1;
+    }
+
+    Buffer<int> input(32, 32);
+    input.for_each_element([&](int x, int y) { input(x, y) = x * 3 + y; });
+
+    // Call from many threads at once, each with its own arguments.
+    const int kThreads = 8;
+    Buffer<int> outputs[kThreads];
+    std::thread threads[kThreads];
+    for (int t = 0; t < kThreads; t++) {
+        outputs[t] = Buffer<int>(32, 32);
+        threads[t] = std::thread([&, t]() {
+            for (int i = 0; i < 20; i++) {
+                int result = c(input, t, 2.0f, outputs[t]);
+                if (result != 0) {
+                    printf("Callable returned %d\n", result);
+                    exit(-1);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    for (int t = 0; t < kThreads; t++) {
+        for (int y = 0; y < 32; y++) {
+            for (int x = 0; x < 32; x++) {
+                int correct = input(x, y) * t + 2 + x;
+                if (outputs[t](x, y) != correct) {
+                    printf("outputs[%d](%d, %d) = %d instead of %d\n",
+                           t, x, y, outputs[t](x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // The argv form takes pointers to scalars and raw buffers.
+    {
+        int pv = 5;
+        float qv = 1.0f;
+        Buffer<int> out(8, 8);
+        const void *args[] = {input.raw_buffer(), &pv, &qv, out.raw_buffer()};
+        if (c.call_argv(4, args) != 0) {
+            printf("call_argv failed\n");
+            return -1;
+        }
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                int correct = input(x, y) * 5 + 1 + x;
+                if (out(x, y) != correct) {
+                    printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // Runtime errors go to the error handler the Func had when it was compiled.
+    {
+        Buffer<int> out(64, 64);
+        int result = c(input, 1, 0.0f, out);
+        if (result == 0 || error_count != 1) {
+            printf("Expected a bounds error (result %d, %d errors)\n", result, error_count);
+            return -1;
+        }
+    }
+
+    // The Callable keeps working after the Func is rescheduled and realized.
+    {
+        f.vectorize(x, 4);
+        in.set(input);
+        p.set(2);
+        q.set(0.0f);
+        Buffer<int> a = f.realize(16, 16);
+        Buffer<int> b(16, 16);
+        c(input, 2, 0.0f, b);
+        for (int y = 0; y < 16; y++) {
+            for (int x = 0; x < 16; x++) {
+                if (a(x, y) != b(x, y)) {
+                    printf("a(%d, %d) = %d but b(%d, %d) = %d\n", x, y, a(x, y), x, y, b(x, y));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
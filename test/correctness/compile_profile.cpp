@@ -0,0 +1,86 @@
+#include "Halide.h"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+
+bool contains_event(const std::string &report, const std::string &name) {
+    return report.find("{\"name\": \"" + name) != std::string::npos;
+}
+
+int main(int argc, char **argv) {
+    Func f("f"), g("g"), h("h");
+    Var x("x"), y("y");
+    f(x, y) = x + y;
+    g(x, y) = f(x, y) + f(x, y + 1);
+    h(x, y) = g(x, y) * 2;
+
+    f.store_root().compute_at(g, y);
+    g.compute_root().vectorize(x, 8);
+    h.parallel(y);
+
+    std::string object = Internal::get_test_tmp_dir() + "compile_profile.o";
+    std::string profile = Internal::get_test_tmp_dir() + "compile_profile.json";
+    Internal::ensure_no_file_exists(object);
+    Internal::ensure_no_file_exists(profile);
+
+    bool profiling_was_on = Internal::compile_profiling_enabled();
+    h.compile_to({{Output::object, object}, {Output::compile_profile, profile}},
+                 {}, "compile_profile", get_host_target());
+
+    Internal::assert_file_exists(object);
+    Internal::assert_file_exists(profile);
+
+    std::ifstream file(profile);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string report = contents.str();
+
+    if (report.find("{\"traceEvents\": [") != 0) {
+        printf("Compile profile is not a Chrome trace:\n%s\n", report.c_str());
+        return -1;
+    }
+
+    for (const char *phase : {"lower compile_profile", "schedule_functions", "bounds_inference",
+                              "sliding_window", "storage_flattening", "vectorize_loops",
+                              "llvm_codegen compile_profile", "llvm_optimize", "llvm_emit_file"}) {
+        if (!contains_event(report, phase)) {
+            printf("Compile profile has no event for %s:\n%s\n", phase, report.c_str());
+            return -1;
+        }
+    }
+
+    if (report.find("\"ir_nodes\": ") == std::string::npos ||
+        report.find("\"llvm_instructions\": ") == std::string::npos ||
+        report.find("\"peak_rss_delta_kb\": ") == std::string::npos) {
+        printf("Compile profile is missing sizes:\n%s\n", report.c_str());
+        return -1;
+    }
+
+    // Asking for a profile only turns profiling on while compiling.
+    if (Internal::compile_profiling_enabled() != profiling_was_on) {
+        printf("compile_to changed whether compile profiling is on\n");
+        return -1;
+    }
+
+    // JIT compilation is recorded too, when profiling is on.
+    Target t = get_jit_target_from_environment();
+    if (t.arch != Target::WebAssembly) {
+        Internal::set_compile_profiling(true);
+        Internal::reset_compile_profile();
+        h.realize(64, 64);
+        std::ostringstream jit_report;
+        Internal::write_compile_profile(jit_report);
+        if (!contains_event(jit_report.str(), "jit_compile") ||
+            contains_event(jit_report.str(), "llvm_emit_file")) {
+            printf("Unexpected JIT compile profile:\n%s\n", jit_report.str().c_str());
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
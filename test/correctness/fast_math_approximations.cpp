@@ -0,0 +1,153 @@
+#include "Halide.h"
+#include <cmath>
+#include <stdio.h>
+
+using namespace Halide;
+
+typedef Expr (*approx_t)(const Expr &, ApproximationPrecision);
+typedef double (*reference_t)(double);
+
+double exp2_ref(double x) {
+    return std::exp2(x);
+}
+
+double log2_ref(double x) {
+    return std::log2(x);
+}
+
+double tanh_ref(double x) {
+    return std::tanh(x);
+}
+
+double sigmoid_ref(double x) {
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+double erf_ref(double x) {
+    return std::erf(x);
+}
+
+double atan_ref(double x) {
+    return std::atan(x);
+}
+
+struct Test {
+    const char *name;
+    approx_t approx;
+    reference_t reference;
+    float lo, hi;
+    // How the error is measured: relative to the reference, or
+    // relative to max(1, |reference|).
+    bool relative;
+};
+
+bool check(const Test &test, ApproximationPrecision precision, double tolerance) {
+    const int N = 100000;
+    Var x;
+    Func f;
+    Expr in = test.lo + (test.hi - test.lo) * (x / (float)N);
+    f(x) = test.approx(in, precision);
+    f.vectorize(x, 8);
+    Buffer<float> result = f.realize(N);
+
+    double max_error = 0;
+    for (int i = 0; i < N; i++) {
+        float v = test.lo + (test.hi - test.lo) * (i / (float)N);
+        double correct = test.reference(v);
+        double error = std::abs(result(i) - correct);
+        if (test.relative) {
+            error /= std::abs(correct);
+        } else {
+            error /= std::max(1.0, std::abs(correct));
+        }
+        max_error = std::max(error, max_error);
+    }
+
+    printf("%s at precision %d: max error %g\n", test.name, (int)precision, max_error);
+    if (max_error > tolerance) {
+        printf("Error exceeds tolerance %g\n", tolerance);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const Test tests[] = {
+        {"fast_exp2", fast_exp2, exp2_ref, -120.0f, 120.0f, true},
+        {"fast_log2", fast_log2, log2_ref, 1e-3f, 1e3f, false},
+        {"fast_tanh", fast_tanh, tanh_ref, -10.0f, 10.0f, false},
+        {"fast_sigmoid", fast_sigmoid, sigmoid_ref, -20.0f, 20.0f, false},
+        {"fast_erf", fast_erf, erf_ref, -5.0f, 5.0f, false},
+        {"fast_atan", fast_atan, atan_ref, -50.0f, 50.0f, false},
+    };
+
+    const ApproximationPrecision precisions[] = {
+        ApproximationPrecision::Low,
+        ApproximationPrecision::Medium,
+        ApproximationPrecision::High,
+    };
+    const double tolerances[] = {1e-3, 1e-5, 1e-6};
+
+    for (const Test &test : tests) {
+        for (int p = 0; p < 3; p++) {
+            if (!check(test, precisions[p], tolerances[p])) {
+                return -1;
+            }
+        }
+    }
+
+    // Check that fast_exp2 saturates to a huge value or zero well
+    // outside the range of a float exponent, and that fast_sigmoid
+    // goes to one or zero there.
+    for (int p = 0; p < 3; p++) {
+        float inputs[] = {-1e30f, -1e10f, -1000.0f, -200.0f, 200.0f, 1000.0f, 1e10f, 1e30f};
+        const int n = sizeof(inputs) / sizeof(inputs[0]);
+        Buffer<float> in(inputs);
+        Var x;
+        Func e, s;
+        e(x) = fast_exp2(in(x), precisions[p]);
+        s(x) = fast_sigmoid(in(x), precisions[p]);
+        e.vectorize(x, 8);
+        s.vectorize(x, 8);
+        Buffer<float> e_result = e.realize(n);
+        Buffer<float> s_result = s.realize(n);
+        for (int i = 0; i < n; i++) {
+            bool e_correct = inputs[i] > 0 ? e_result(i) > 1e38f : e_result(i) == 0.0f;
+            float s_correct = inputs[i] > 0 ? 1.0f : 0.0f;
+            if (!e_correct) {
+                printf("fast_exp2(%g) at precision %d = %g\n",
+                       inputs[i], p, e_result(i));
+                return -1;
+            }
+            if (std::abs(s_result(i) - s_correct) > tolerances[p]) {
+                printf("fast_sigmoid(%g) at precision %d = %g instead of %g\n",
+                       inputs[i], p, s_result(i), s_correct);
+                return -1;
+            }
+        }
+    }
+
+    // Check atan2 in every quadrant, and at the origin.
+    for (int p = 0; p < 3; p++) {
+        Var x, y;
+        Func f;
+        Expr fx = (x - 50) / 10.0f, fy = (y - 50) / 10.0f;
+        f(x, y) = fast_atan2(fy, fx, precisions[p]);
+        f.vectorize(x, 8);
+        Buffer<float> result = f.realize(101, 101);
+        for (int j = 0; j < 101; j++) {
+            for (int i = 0; i < 101; i++) {
+                float vx = (i - 50) / 10.0f, vy = (j - 50) / 10.0f;
+                double correct = std::atan2((double)vy, (double)vx);
+                if (std::abs(result(i, j) - correct) > tolerances[p]) {
+                    printf("fast_atan2(%f, %f) at precision %d = %f instead of %f\n",
+                           vy, vx, p, result(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "Halide.h"
+#include <iostream>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::ConciseCasts;
+using namespace Halide::Internal;
+
+typedef Expr (*idiom_maker_t)(Expr, Expr);
+
+struct Idiom {
+    const char *name;
+    idiom_maker_t make;
+    Call::IntrinsicOp intrinsic;
+};
+
+template<typename T>
+Expr wide(Expr e) {
+    return cast(type_of<T>().with_bits(sizeof(T) * 16).with_lanes(e.type().lanes()), e);
+}
+
+template<typename T>
+Expr narrow(Expr e) {
+    return cast(type_of<T>().with_lanes(e.type().lanes()), e);
+}
+
+template<typename T>
+Expr sat(Expr e) {
+    return saturating_cast(type_of<T>().with_lanes(e.type().lanes()), e);
+}
+
+// All of these are written in a form that differs from the canonical
+// one the backends look for: promoted to a wider type than necessary,
+// or with shifts instead of divisions.
+template<typename T>
+Expr sat_add(Expr a, Expr b) {
+    return sat<T>(i32(a) + i32(b));
+}
+
+template<typename T>
+Expr sat_sub(Expr a, Expr b) {
+    return sat<T>(i32(a) - i32(b));
+}
+
+template<typename T>
+Expr halving_add(Expr a, Expr b) {
+    return narrow<T>((i32(a) + i32(b)) >> 1);
+}
+
+template<typename T>
+Expr rounding_halving_add(Expr a, Expr b) {
+    return narrow<T>((i32(b) + 1 + i32(a)) >> 1);
+}
+
+template<typename T>
+Expr halving_sub(Expr a, Expr b) {
+    return narrow<T>((i32(a) - i32(b)) / 2);
+}
+
+template<typename T>
+Expr mul_shift_right(Expr a, Expr b) {
+    return narrow<T>((wide<T>(a) * wide<T>(b)) / (1 << (sizeof(T) * 8)));
+}
+
+template<typename T>
+Expr rounding_mul_shift_right(Expr a, Expr b) {
+    const int q = sizeof(T) * 8 - 1;
+    return narrow<T>((wide<T>(a) * wide<T>(b) + (1 << (q - 1))) / (1 << q));
+}
+
+template<typename T>
+Expr rounding_shift_right(Expr a, Expr b) {
+    return narrow<T>((i32(a) + 8) >> 4);
+}
+
+template<typename T>
+Expr saturating_narrow(Expr a, Expr b) {
+    return sat<T>(wide<T>(a) * wide<T>(b));
+}
+
+template<typename T>
+bool test() {
+    const Idiom idioms[] = {
+        {"saturating_add", sat_add<T>, Call::saturating_add},
+        {"saturating_sub", sat_sub<T>, Call::saturating_sub},
+        {"halving_add", halving_add<T>, Call::halving_add},
+        {"rounding_halving_add", rounding_halving_add<T>, Call::rounding_halving_add},
+        {"halving_sub", halving_sub<T>, Call::halving_sub},
+        {"mul_shift_right", mul_shift_right<T>, Call::mul_shift_right},
+        {"rounding_mul_shift_right", rounding_mul_shift_right<T>, Call::rounding_mul_shift_right},
+        {"rounding_shift_right", rounding_shift_right<T>, Call::rounding_shift_right},
+        {"saturating_narrow", saturating_narrow<T>, Call::saturating_narrow},
+    };
+
+    const int W = 1024;
+    Buffer<T> in_a(W), in_b(W);
+    for (int i = 0; i < W; i++) {
+        in_a(i) = (T)rand();
+        in_b(i) = (T)rand();
+    }
+    // Make sure the extremes of the type get exercised.
+    in_a(0) = in_b(0) = std::numeric_limits<T>::min();
+    in_a(1) = in_b(1) = std::numeric_limits<T>::max();
+    in_a(2) = std::numeric_limits<T>::min();
+    in_b(2) = std::numeric_limits<T>::max();
+
+    Target target = get_jit_target_from_environment();
+    Var x;
+
+    for (const Idiom &idiom : idioms) {
+        // Check the idiom is recognized.
+        Expr va = Variable::make(type_of<T>().with_lanes(16), "a");
+        Expr vb = Variable::make(type_of<T>().with_lanes(16), "b");
+        Expr found = find_intrinsics(simplify(idiom.make(va, vb)));
+        const Call *c = found.as<Call>();
+        if (!c || !c->is_intrinsic(idiom.intrinsic)) {
+            std::cout << idiom.name << " for " << type_of<T>()
+                      << " was not recognized: " << found << "\n";
+            return false;
+        }
+
+        // Check that the vectorized version, which uses the
+        // intrinsic, matches the scalar version, which doesn't.
+        Func f, g;
+        f(x) = idiom.make(in_a(x), in_b(x));
+        g(x) = idiom.make(in_a(x), in_b(x));
+        f.vectorize(x, target.natural_vector_size<T>() * 2);
+
+        Buffer<T> out_f = f.realize(W, target);
+        Buffer<T> out_g = g.realize(W, target);
+        for (int i = 0; i < W; i++) {
+            if (out_f(i) != out_g(i)) {
+                std::cout << idiom.name << " for " << type_of<T>()
+                          << ": f(" << (int)in_a(i) << ", " << (int)in_b(i) << ") = "
+                          << (int)out_f(i) << " instead of " << (int)out_g(i) << "\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!test<uint8_t>() ||
+        !test<int8_t>() ||
+        !test<uint16_t>() ||
+        !test<int16_t>()) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
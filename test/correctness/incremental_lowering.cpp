@@ -0,0 +1,129 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+Buffer<float> run(const Buffer<float> &lut, int variant, Param<int> &offset) {
+    Var x("x"), y("y"), xo("xo"), xi("xi");
+    Func a("a"), b("b"), c("c"), d("d");
+    RDom r(0, 5, "r");
+
+    a(x, y) = lut(clamp(x + y, 0, lut.width() - 1)) + offset;
+    b(x, y) = a(x - 1, y) + a(x, y) + a(x + 1, y);
+    c(x, y) = 0.0f;
+    c(x, y) += b(x + r, y);
+    d(x, y) = c(x, y) * 2 + b(x, y);
+
+    a.compute_root().vectorize(x, 8);
+    b.compute_root().split(x, xo, xi, 8).vectorize(xi).parallel(y);
+    c.compute_root().update().vectorize(x, 8).unroll(r);
+    if (variant == 0) {
+        d.vectorize(x, 8);
+    } else {
+        d.vectorize(x, 8).parallel(y);
+    }
+
+    return d.realize(64, 32);
+}
+
+int check(const Buffer<float> &lut, int offset, const Buffer<float> &result, const char *when) {
+    auto a = [&](int x, int y) {
+        return lut(std::min(std::max(x + y, 0), lut.width() - 1)) + offset;
+    };
+    auto b = [&](int x, int y) {
+        return a(x - 1, y) + a(x, y) + a(x + 1, y);
+    };
+    for (int y = 0; y < result.height(); y++) {
+        for (int x = 0; x < result.width(); x++) {
+            float c = 0.0f;
+            for (int r = 0; r < 5; r++) {
+                c += b(x + r, y);
+            }
+            float correct = c * 2 + b(x, y);
+            if (result(x, y) != correct) {
+                printf("%s: result(%d, %d) = %f instead of %f\n", when, x, y, result(x, y), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Internal::set_incremental_lowering(true);
+
+    Param<int> offset("offset", 3);
+    Buffer<float> lut(128, "lut");
+    lut.for_each_element([&](int x) { lut(x) = x * 0.5f; });
+
+    Buffer<float> result = run(lut, 0, offset);
+    if (check(lut, 3, result, "first lowering") != 0) return -1;
+
+    Internal::IncrementalLoweringStats stats = Internal::incremental_lowering_stats();
+    if (stats.hits != 0 || stats.misses == 0) {
+        printf("Expected only misses the first time: %d hits, %d misses\n", stats.hits, stats.misses);
+        return -1;
+    }
+
+    // Rebuilding the same pipeline gives its Funcs new names, but the
+    // producers should all be found in the cache.
+    int misses = stats.misses;
+    result = run(lut, 0, offset);
+    if (check(lut, 3, result, "identical pipeline") != 0) return -1;
+    stats = Internal::incremental_lowering_stats();
+    if (stats.misses != misses || stats.hits != misses) {
+        printf("Expected only hits the second time: %d hits, %d misses\n", stats.hits, stats.misses - misses);
+        return -1;
+    }
+
+    // Changing the schedule of only the output reuses the producers
+    // it doesn't affect.
+    int hits = stats.hits;
+    result = run(lut, 1, offset);
+    if (check(lut, 3, result, "new output schedule") != 0) return -1;
+    stats = Internal::incremental_lowering_stats();
+    if (stats.hits == hits) {
+        printf("Expected some producers to be reused after a schedule change\n");
+        return -1;
+    }
+
+    // Reused producers must use the new pipeline's images and
+    // parameters, not the ones they were first lowered with.
+    Buffer<float> other_lut(128, "lut");
+    other_lut.for_each_element([&](int x) { other_lut(x) = 100.0f - x; });
+    Param<int> other_offset("offset", 7);
+    hits = stats.hits;
+    result = run(other_lut, 0, other_offset);
+    if (check(other_lut, 7, result, "new images and params") != 0) return -1;
+    stats = Internal::incremental_lowering_stats();
+    if (stats.hits == hits) {
+        printf("Expected producers using other images and params to be reused\n");
+        return -1;
+    }
+
+    // Producers that use a parameter whose range has changed since
+    // they were lowered can't be reused, even if they use the same
+    // Param.
+    misses = stats.misses;
+    offset.set_range(0, 100);
+    result = run(lut, 0, offset);
+    if (check(lut, 3, result, "new param range") != 0) return -1;
+    stats = Internal::incremental_lowering_stats();
+    if (stats.misses == misses) {
+        printf("Expected producers using a param with a new range to be lowered again\n");
+        return -1;
+    }
+
+    // Turning it off discards everything.
+    Internal::set_incremental_lowering(false);
+    stats = Internal::incremental_lowering_stats();
+    if (stats.hits != 0 || stats.misses != 0) {
+        printf("Expected no hits or misses after turning incremental lowering off\n");
+        return -1;
+    }
+    result = run(lut, 1, offset);
+    if (check(lut, 3, result, "incremental lowering off") != 0) return -1;
+
+    printf("Success!\n");
+    return 0;
+}
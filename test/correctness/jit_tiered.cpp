@@ -0,0 +1,152 @@
+#include "Halide.h"
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+
+using namespace Halide;
+
+int check(const Buffer<float> &im, const char *when) {
+    for (int y = 0; y < im.height(); y++) {
+        for (int x = 0; x < im.width(); x++) {
+            float correct = 0.0f;
+            for (int i = 0; i < 5; i++) {
+                correct += (float)((x + i) * y) * 0.25f;
+            }
+            if (im(x, y) != correct) {
+                printf("%s: im(%d, %d) = %f instead of %f\n", when, x, y, im(x, y), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.arch == Target::WebAssembly) {
+        printf("[SKIP] Skipping test for WebAssembly as it does not support tiered compilation.\n");
+        return 0;
+    }
+
+    Var x, y;
+    RDom r(0, 5);
+
+    auto make_pipeline = [&]() {
+        Func f, g;
+        f(x, y) = cast<float>(x * y) * 0.25f;
+        g(x, y) = sum(f(x + r, y));
+        f.compute_at(g, y).vectorize(x, 8);
+        g.vectorize(x, 8).parallel(y);
+        return g;
+    };
+
+    {
+        // Code compiled for a fast compile target must still be correct.
+        Func g = make_pipeline();
+        g.compile_jit(t.with_feature(Target::LLVMFastCompile));
+        Buffer<float> im = g.realize(64, 64, t.with_feature(Target::LLVMFastCompile));
+        if (check(im, "LLVMFastCompile") != 0) return -1;
+    }
+
+    {
+        // Tiered compilation gives the right answer whichever tier
+        // realize happens to use.
+        Pipeline p(make_pipeline());
+        p.compile_jit_tiered(t);
+        if (!p.optimized_jit_pending()) {
+            printf("Expected the optimized tier to be pending after compile_jit_tiered\n");
+            return -1;
+        }
+        Buffer<float> im = p.realize(64, 64, t);
+        if (check(im, "before waiting") != 0) return -1;
+
+        for (int i = 0; i < 10; i++) {
+            im = p.realize(64, 64, t);
+            if (check(im, "while optimizing") != 0) return -1;
+        }
+
+        p.wait_for_optimized_jit();
+        if (p.optimized_jit_pending()) {
+            printf("Expected wait_for_optimized_jit to switch to the optimized tier\n");
+            return -1;
+        }
+        im = p.realize(64, 64, t);
+        if (check(im, "after waiting") != 0) return -1;
+
+        // Waiting again is a no-op.
+        p.wait_for_optimized_jit();
+        im = p.realize(64, 64, t);
+        if (check(im, "after waiting twice") != 0) return -1;
+    }
+
+    {
+        // Without waiting, realize switches to the optimized tier
+        // once it is ready.
+        Pipeline p(make_pipeline());
+        p.compile_jit_tiered(t);
+        auto start = std::chrono::steady_clock::now();
+        while (p.optimized_jit_pending()) {
+            if (std::chrono::steady_clock::now() - start > std::chrono::seconds(60)) {
+                printf("realize never switched to the optimized tier\n");
+                return -1;
+            }
+            Buffer<float> im = p.realize(64, 64, t);
+            if (check(im, "before switching") != 0) return -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        Buffer<float> im = p.realize(64, 64, t);
+        if (check(im, "after switching") != 0) return -1;
+    }
+
+    {
+        // Destroying the pipeline while the optimized tier is still
+        // compiling must be safe.
+        Func g = make_pipeline();
+        g.compile_jit_tiered(t);
+        Buffer<float> im = g.realize(64, 64, t);
+        if (check(im, "before destruction") != 0) return -1;
+    }
+
+    {
+        // Invalidating the compiled code also discards the pending
+        // optimized tier, and realize recompiles.
+        Pipeline p(make_pipeline());
+        p.compile_jit_tiered(t);
+        p.invalidate_cache();
+        Buffer<float> im = p.realize(64, 64, t);
+        if (check(im, "after invalidation") != 0) return -1;
+        p.wait_for_optimized_jit();
+        im = p.realize(64, 64, t);
+        if (check(im, "after invalidation and waiting") != 0) return -1;
+    }
+
+    {
+        // Other pipelines can be compiled, on this thread and others,
+        // while the optimized tier of one is still compiling.
+        Pipeline p(make_pipeline());
+        p.compile_jit_tiered(t);
+        std::vector<Buffer<float>> results(4);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < results.size(); i++) {
+            threads.emplace_back([&, i]() {
+                Pipeline q(make_pipeline());
+                results[i] = q.realize(64, 64, t);
+            });
+        }
+        Pipeline q(make_pipeline());
+        Buffer<float> im = q.realize(64, 64, t);
+        if (check(im, "compiled alongside the optimized tier") != 0) return -1;
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        for (const auto &result : results) {
+            if (check(result, "compiled on another thread") != 0) return -1;
+        }
+        p.wait_for_optimized_jit();
+        im = p.realize(64, 64, t);
+        if (check(im, "after compiling others") != 0) return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the non-temporal stores to each buffer, and the fences.
+class CountNontemporalStores : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Store *op) override {
+        const Call *c = op->value.as<Call>();
+        if (c && c->is_intrinsic(Call::nontemporal_store)) {
+            stores[op->name]++;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Call *op) override {
+        if (op->is_intrinsic(Call::store_fence)) {
+            fences++;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    std::map<std::string, int> stores;
+    int fences = 0;
+};
+
+class CheckNontemporalStores : public IRMutator {
+    std::map<std::string, int> &stores;
+    int &fences;
+
+public:
+    CheckNontemporalStores(std::map<std::string, int> &s, int &f)
+        : stores(s), fences(f) {
+    }
+
+    using IRMutator::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        CountNontemporalStores counter;
+        s.accept(&counter);
+        stores = counter.stores;
+        fences = counter.fences;
+        return s;
+    }
+};
+
+// Check that in the production of an async Func, the fence comes
+// before the semaphore releases that tell the consumer it's done.
+class CheckFenceBeforeRelease : public IRVisitor {
+    using IRVisitor::visit;
+
+    const std::string &func;
+    bool inside = false, fenced = false;
+
+    void visit(const ProducerConsumer *op) override {
+        if (op->is_producer && op->name == func) {
+            inside = true;
+            fenced = false;
+            IRVisitor::visit(op);
+            inside = false;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Call *op) override {
+        if (inside && op->is_intrinsic(Call::store_fence)) {
+            fenced = true;
+        } else if (inside && op->name == "halide_semaphore_release") {
+            releases++;
+            if (!fenced) {
+                unfenced_releases++;
+            }
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    int releases = 0, unfenced_releases = 0;
+
+    CheckFenceBeforeRelease(const std::string &f)
+        : func(f) {
+    }
+};
+
+class CheckAsyncFences : public IRMutator {
+    std::string func;
+    int &releases, &unfenced_releases;
+
+public:
+    CheckAsyncFences(const std::string &f, int &r, int &u)
+        : func(f), releases(r), unfenced_releases(u) {
+    }
+
+    using IRMutator::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        CheckFenceBeforeRelease checker(func);
+        s.accept(&checker);
+        releases = checker.releases;
+        unfenced_releases = checker.unfenced_releases;
+        return s;
+    }
+};
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y");
+    Func f("f"), g("g"), h("h");
+    f(x, y) = x + y;
+    g(x, y) = f(x, y) * 2;
+    h(x, y) = g(x, y) + f(x + 1, y);
+
+    // f is computed in parallel, so each task fences its own stores
+    // as well as the whole production of f. g is only stored to with
+    // scalar stores, so it isn't touched.
+    f.compute_root().vectorize(x, 8).parallel(y).store_nontemporal();
+    g.compute_root().store_nontemporal();
+    h.vectorize(x, 8).store_nontemporal();
+
+    std::map<std::string, int> stores;
+    int fences = 0;
+    h.add_custom_lowering_pass(new CheckNontemporalStores(stores, fences));
+    Buffer<int> result = h.realize(64, 64);
+
+    for (int y = 0; y < 64; y++) {
+        for (int x = 0; x < 64; x++) {
+            int correct = (x + y) * 2 + (x + 1 + y);
+            if (result(x, y) != correct) {
+                printf("result(%d, %d) = %d instead of %d\n", x, y, result(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    if (stores["f"] == 0 || stores["h"] == 0 || stores["g"] != 0) {
+        printf("Expected non-temporal stores to f and h only. Got %d, %d and %d to f, g and h\n",
+               stores["f"], stores["g"], stores["h"]);
+        return -1;
+    }
+
+    // One fence per parallel task of f, one for each production of
+    // f and h.
+    if (fences != 3) {
+        printf("Expected 3 fences, got %d\n", fences);
+        return -1;
+    }
+
+    {
+        // An async producer must fence its stores before it tells
+        // its consumer they are done.
+        Func f("f"), out("out");
+        f(x, y) = x + y;
+        out(x, y) = f(x, y) + f(x + 1, y);
+        f.compute_at(out, y).vectorize(x, 8).store_nontemporal().async();
+        out.vectorize(x, 8);
+
+        int releases = 0, unfenced_releases = 0;
+        out.add_custom_lowering_pass(new CheckAsyncFences("f", releases, unfenced_releases));
+        Buffer<int> result = out.realize(64, 64);
+
+        for (int y = 0; y < 64; y++) {
+            for (int x = 0; x < 64; x++) {
+                int correct = (x + y) + (x + 1 + y);
+                if (result(x, y) != correct) {
+                    printf("async: result(%d, %d) = %d instead of %d\n", x, y, result(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+
+        if (releases == 0 || unfenced_releases != 0) {
+            printf("Expected the production of f to fence its stores before its %d semaphore releases, "
+                   "but %d were not fenced\n",
+                   releases, unfenced_releases);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "Halide.h"
+#include <map>
+#include <regex>
+#include <sstream>
+#include <stdio.h>
+
+using namespace Halide;
+
+// A pipeline with several root-level producers, so that there is
+// something to lower in parallel.
+Func build() {
+    Var x("x"), y("y"), xo("xo"), xi("xi");
+    std::vector<Func> stages;
+    Func first("first");
+    first(x, y) = x + y * 3;
+    first.compute_root().vectorize(x, 8);
+    stages.push_back(first);
+    for (int i = 1; i < 6; i++) {
+        Func prev = stages.back();
+        Func f("stage_" + std::to_string(i));
+        f(x, y) = prev(x - 1, y) + prev(x + 1, y) * i;
+        if (i % 2) {
+            f.compute_root().split(x, xo, xi, 4).unroll(xi);
+        } else {
+            f.compute_root().vectorize(x, 8).parallel(y);
+        }
+        stages.push_back(f);
+    }
+    Func out("out");
+    out(x, y) = stages.back()(x, y) - stages[2](x, y);
+    out.vectorize(x, 8);
+    return out;
+}
+
+Buffer<int> run() {
+    return build().realize(64, 16);
+}
+
+// Lower a pipeline and print the result. The names made by
+// unique_name depend on what else has been lowered, so they are
+// numbered in order of first appearance instead. The simplifier puts
+// two variables combined by a commutative operator in the order of
+// their names, so those are put back in a standard order too.
+std::string lower_to_string(Func f) {
+    Module m = f.compile_to_module({}, "out", get_host_target());
+    std::ostringstream stream;
+    stream << m.functions()[0].body;
+    std::string s = stream.str();
+
+    std::regex numbered("\\b[A-Za-z_][0-9]+\\b|\\$[0-9]+");
+    std::map<std::string, std::string> names;
+    std::string renamed;
+    auto last = s.cbegin();
+    for (std::sregex_iterator it(s.begin(), s.end(), numbered), end; it != end; ++it) {
+        renamed.append(last, (*it)[0].first);
+        auto name = names.find(it->str());
+        if (name == names.end()) {
+            name = names.emplace(it->str(), "#" + std::to_string(names.size())).first;
+        }
+        renamed += name->second;
+        last = (*it)[0].second;
+    }
+    renamed.append(last, s.cend());
+
+    const std::string var = "([#A-Za-z_][#\\w.]*)";
+    std::regex commuted("\\(" + var + "(\\*| \\+ | == | != | && | \\|\\| )" + var + "\\)|" +
+                        "(min|max)\\(" + var + ", " + var + "\\)");
+    std::string result;
+    last = renamed.cbegin();
+    for (std::sregex_iterator it(renamed.begin(), renamed.end(), commuted), end; it != end; ++it) {
+        const std::smatch &op = *it;
+        result.append(last, op[0].first);
+        bool is_call = op[4].matched;
+        std::string a = is_call ? op[5] : op[1];
+        std::string b = is_call ? op[6] : op[3];
+        if (b < a) {
+            std::swap(a, b);
+        }
+        if (is_call) {
+            result += op[4].str() + "(" + a + ", " + b + ")";
+        } else {
+            result += "(" + a + op[2].str() + b + ")";
+        }
+        last = op[0].second;
+    }
+    result.append(last, renamed.cend());
+    return result;
+}
+
+int check(const Buffer<int> &result, const Buffer<int> &correct, const char *when) {
+    for (int y = 0; y < result.height(); y++) {
+        for (int x = 0; x < result.width(); x++) {
+            if (result(x, y) != correct(x, y)) {
+                printf("%s: result(%d, %d) = %d instead of %d\n", when, x, y, result(x, y), correct(x, y));
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Internal::set_parallel_lowering(false);
+    Buffer<int> correct = run();
+
+    Internal::set_parallel_lowering(true);
+    if (!Internal::parallel_lowering_enabled()) {
+        printf("Failed to turn on parallel lowering\n");
+        return -1;
+    }
+    Buffer<int> result = run();
+    if (check(result, correct, "parallel lowering") != 0) return -1;
+
+    // Lowering in parallel gives the same Stmt as lowering serially,
+    // however many threads are used, every time.
+    Func f = build();
+    Internal::set_parallel_lowering(false);
+    std::string serial = lower_to_string(f);
+    for (int threads : {1, 2, 3, 8, 0}) {
+        for (int i = 0; i < 3; i++) {
+            Internal::set_parallel_lowering(true, threads);
+            std::string parallel = lower_to_string(f);
+            if (parallel != serial) {
+                printf("Lowering with %d threads gave a different Stmt:\n%s\n"
+                       "Lowering serially gave:\n%s\n",
+                       threads, parallel.c_str(), serial.c_str());
+                return -1;
+            }
+        }
+    }
+
+    // It also works together with incremental lowering, both when
+    // the producers are lowered and when they are found in the cache.
+    Internal::set_incremental_lowering(true);
+    result = run();
+    if (check(result, correct, "parallel and incremental lowering") != 0) return -1;
+    result = run();
+    if (check(result, correct, "parallel lowering with cache hits") != 0) return -1;
+    if (Internal::incremental_lowering_stats().hits == 0) {
+        printf("Expected producers to be found in the cache\n");
+        return -1;
+    }
+    Internal::set_incremental_lowering(false);
+    Internal::set_parallel_lowering(false);
+
+    printf("Success!\n");
+    return 0;
+}
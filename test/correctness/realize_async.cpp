@@ -0,0 +1,117 @@
+#include "Halide.h"
+#include <atomic>
+#include <stdio.h>
+
+using namespace Halide;
+
+std::atomic<int> completions{0};
+
+bool error_occurred = false;
+void my_error_handler(void *user_context, const char *msg) {
+    error_occurred = true;
+}
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("Skipping test for WebAssembly as realize_async is not supported there.\n");
+        return 0;
+    }
+
+    Var x, y;
+
+    {
+        // Keep several realizations in flight from one thread.
+        Func f;
+        f(x, y) = x * 3 + y;
+        f.parallel(y);
+        Pipeline p(f);
+
+        const int n = 8;
+        std::vector<Buffer<int>> outs;
+        std::vector<PendingRealization> pending;
+        for (int i = 0; i < n; i++) {
+            Buffer<int> out(64, 64);
+            out.set_min(i * 10, i);
+            outs.push_back(out);
+            pending.push_back(p.realize_async(out, get_jit_target_from_environment(),
+                                              ParamMap::empty_map(),
+                                              [](int exit_status) {
+                                                  if (exit_status == 0) {
+                                                      completions++;
+                                                  }
+                                              }));
+        }
+
+        for (int i = 0; i < n; i++) {
+            pending[i].wait();
+            if (!pending[i].ready()) {
+                printf("Realization %d not ready after wait\n", i);
+                return -1;
+            }
+            auto check = [&](int x, int y) -> int {
+                if (outs[i](x, y) != x * 3 + y) {
+                    printf("outs[%d](%d, %d) = %d instead of %d\n",
+                           i, x, y, outs[i](x, y), x * 3 + y);
+                    exit(-1);
+                }
+                return 0;
+            };
+            outs[i].for_each_element(check);
+        }
+
+        if (completions != n) {
+            printf("on_complete was called %d times instead of %d\n", (int)completions, n);
+            return -1;
+        }
+    }
+
+    {
+        // The values of scalar params are captured when the
+        // realization starts, even if they were passed in a
+        // temporary ParamMap, or the param changes before it runs.
+        Param<int> k;
+        Func f;
+        f(x, y) = x * k + y;
+        f.parallel(y);
+        Pipeline p(f);
+
+        k.set(5);
+        Buffer<int> out1(64, 64), out2(64, 64);
+        PendingRealization pending1 = p.realize_async(out1, get_jit_target_from_environment(), {{k, 7}});
+        PendingRealization pending2 = p.realize_async(out2);
+        k.set(0);
+        pending1.wait();
+        pending2.wait();
+
+        for (int y = 0; y < 64; y++) {
+            for (int x = 0; x < 64; x++) {
+                if (out1(x, y) != x * 7 + y || out2(x, y) != x * 5 + y) {
+                    printf("out1(%d, %d) = %d and out2(%d, %d) = %d instead of %d and %d\n",
+                           x, y, out1(x, y), x, y, out2(x, y), x * 7 + y, x * 5 + y);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // Errors are reported when the realization is waited on.
+        Param<int> p;
+        Func f;
+        f(x) = require(p > 0, x, "p must be positive");
+        f.set_error_handler(my_error_handler);
+        Pipeline pipe(f);
+
+        p.set(-1);
+        Buffer<int> out(10);
+        PendingRealization pending = pipe.realize_async(out);
+        pending.wait();
+        if (!error_occurred) {
+            printf("Expected an error from the failing realization\n");
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
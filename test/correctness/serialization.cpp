@@ -0,0 +1,99 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int check(const Buffer<float> &a, const Buffer<float> &b, const char *when) {
+    for (int y = 0; y < a.height(); y++) {
+        for (int x = 0; x < a.width(); x++) {
+            if (a(x, y) != b(x, y)) {
+                printf("%s: (%d, %d) = %f instead of %f\n", when, x, y, b(x, y), a(x, y));
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+
+    Param<int> offset("offset", 3, 0, 10);
+    ImageParam input(Float(32), 2, "input");
+    input.dim(0).set_min(0);
+
+    Buffer<float> lut(16, "lut");
+    for (int i = 0; i < 16; i++) {
+        lut(i) = i * 0.5f;
+    }
+
+    Var x("x"), y("y"), xo("xo"), xi("xi");
+    Func f("f"), g("g"), h("h");
+    RDom r(0, 5, 0, 5, "r");
+    r.where(r.x < r.y + offset);
+    f(x, y) = input(x, y) * lut(clamp(x + y, 0, 15)) + offset;
+    g(x, y) = 0.0f;
+    g(x, y) += f(x + r.x, y + r.y);
+    h(x, y) = g(x, y) * 2;
+
+    h.split(x, xo, xi, 8).vectorize(xi).parallel(y).specialize(offset > 5);
+    g.compute_at(h, xo).update().unroll(r.x);
+    f.compute_at(f.in(g), y);
+    f.in(g).compute_at(g, x);
+
+    Pipeline p(h);
+    p.add_requirement(offset < 100, "offset is too large");
+
+    Buffer<float> in(80, 80);
+    in.for_each_element([&](int x, int y) { in(x, y) = (float)((x * 7 + y * 3) % 11); });
+    input.set(in);
+    Buffer<float> correct = p.realize(64, 64);
+
+    std::vector<uint8_t> data = serialize_pipeline(p);
+
+    {
+        // The deserialized pipeline has its own copies of the
+        // parameters, with the values they had when serialized.
+        Pipeline q = deserialize_pipeline(data);
+        Buffer<float> result = q.realize(64, 64);
+        if (check(correct, result, "deserialized") != 0) return -1;
+    }
+
+    {
+        // Existing parameters can be substituted in, so that they can
+        // be set before realizing.
+        std::map<std::string, Internal::Parameter> params = {
+            {offset.name(), offset.parameter()},
+            {input.name(), input.parameter()}};
+        Pipeline q = deserialize_pipeline(data, params);
+        offset.set(7);
+        correct = p.realize(64, 64);
+        Buffer<float> result = q.realize(64, 64);
+        if (check(correct, result, "deserialized with parameters") != 0) return -1;
+    }
+
+    if (t.arch != Target::WebAssembly) {
+        // A lowered Module can be saved and compiled directly into a
+        // Callable later, skipping lowering.
+        Target jit_target = t.with_feature(Target::JIT).with_feature(Target::UserContext);
+        Module m = p.compile_to_module({input, offset}, "serialized", jit_target);
+        Module m2 = deserialize_module(serialize_module(m));
+        if (m2.name() != m.name() || m2.target() != m.target() ||
+            m2.functions().size() != m.functions().size()) {
+            printf("Module did not survive serialization\n");
+            return -1;
+        }
+
+        Callable c(m2, "serialized");
+        Buffer<float> result(64, 64);
+        int ret = c(in, offset.get(), result);
+        if (ret != 0) {
+            printf("Callable returned %d\n", ret);
+            return -1;
+        }
+        if (check(correct, result, "deserialized module") != 0) return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
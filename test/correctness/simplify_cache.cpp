@@ -0,0 +1,102 @@
+#include "Halide.h"
+#include <iostream>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+int main(int argc, char **argv) {
+    set_simplify_cache(true);
+
+    Var x("x"), y("y");
+    Param<int> p1("p"), p2("p");
+
+    // Simplifying an equal Expr again is a hit, and gets the same result.
+    Expr e1 = (x * 4 + y * 8) / 4 - x;
+    Expr e2 = (x * 4 + y * 8) / 4 - x;
+    Expr r1 = simplify(e1);
+    SimplifyCacheStats before = simplify_cache_stats();
+    Expr r2 = simplify(e2);
+    SimplifyCacheStats after = simplify_cache_stats();
+    if (!equal(r1, r2) || !equal(r1, y * 2)) {
+        std::cerr << "Unexpected simplification: " << e2 << " -> " << r2 << "\n";
+        return -1;
+    }
+    if (after.hits != before.hits + 1) {
+        printf("Simplifying an equal Expr was not a cache hit\n");
+        return -1;
+    }
+
+    // The facts known about variables are part of the key.
+    Expr e = (x / 2) * 2 == x;
+    Scope<ModulusRemainder> even;
+    even.push(x.name(), ModulusRemainder(2, 0));
+    Scope<Interval> bounds;
+    bounds.push(x.name(), Interval(0, 10));
+    for (int i = 0; i < 2; i++) {
+        if (is_one(simplify(e))) {
+            printf("(x / 2) * 2 == x should not simplify to true for arbitrary x\n");
+            return -1;
+        }
+        if (!is_one(simplify(e, true, Scope<Interval>::empty_scope(), even))) {
+            printf("(x / 2) * 2 == x should simplify to true for even x\n");
+            return -1;
+        }
+        if (!is_one(simplify(x < 11, true, bounds))) {
+            printf("x < 11 should simplify to true for x in [0, 10]\n");
+            return -1;
+        }
+        if (is_one(simplify(x < 11))) {
+            printf("x < 11 should not simplify to true for arbitrary x\n");
+            return -1;
+        }
+    }
+
+    // Parameters with the same name are distinct.
+    Expr q1 = simplify(p1 + 1 + 1);
+    Expr q2 = simplify(p2 + 1 + 1);
+    const Add *add = q2.as<Add>();
+    const Variable *var = add ? add->a.as<Variable>() : nullptr;
+    if (!var || !var->param.same_as(p2.parameter())) {
+        std::cerr << "Simplifying an Expr that uses a different Parameter reused the wrong result: "
+                  << q2 << "\n";
+        return -1;
+    }
+
+    // A pipeline compiled with the cache on computes the right thing.
+    Func f("f"), g("g");
+    f(x, y) = x + y * 2;
+    g(x, y) = f(x / 2, y) + f(x / 2 + 1, y);
+    f.compute_root();
+    g.vectorize(x, 4);
+    Buffer<int> out = g.realize(16, 16);
+    for (int j = 0; j < out.height(); j++) {
+        for (int i = 0; i < out.width(); i++) {
+            int correct = (i / 2 + j * 2) + (i / 2 + 1 + j * 2);
+            if (out(i, j) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n", i, j, out(i, j), correct);
+                return -1;
+            }
+        }
+    }
+
+    // Lowering empties the cache when it is done, so that it doesn't
+    // keep the pipeline alive.
+    before = simplify_cache_stats();
+    simplify(e1);
+    after = simplify_cache_stats();
+    if (after.hits != before.hits || after.misses != before.misses + 1) {
+        printf("The cache still held results after lowering\n");
+        return -1;
+    }
+
+    // Turning the cache off discards it.
+    set_simplify_cache(false);
+    if (simplify_cache_enabled() || simplify_cache_stats().hits != 0) {
+        printf("Turning off the cache did not reset it\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
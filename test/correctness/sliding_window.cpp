@@ -12,7 +12,7 @@ using namespace Halide;
 int count = 0;
 extern "C" DLLEXPORT int call_counter(int x, int y) {
     count++;
-    return 0;
+    return x * 1000 + y;
 }
 HalideExtern_2(int, call_counter, int, int);
 
@@ -221,6 +221,69 @@ int main(int argc, char **argv) {
         }
     }
 
+    {
+        // Sliding along both levels of a split loop. The producer
+        // should not be recomputed at the start of each strip.
+        Var yo, yi;
+        Func f, g;
+
+        f(x, y) = call_counter(x, y);
+        g(x, y) = f(x, y - 1) + f(x, y) + f(x, y + 1);
+
+        g.split(y, yo, yi, 4);
+        f.store_root().compute_at(g, yi);
+
+        count = 0;
+        Buffer<int> im = g.realize(10, 20);
+
+        if (count != 10 * 22) {
+            printf("f was called %d times instead of %d times\n", count, 10 * 22);
+            return -1;
+        }
+
+        // Each strip must still see the rows computed by the one
+        // before it.
+        for (int y = 0; y < 20; y++) {
+            for (int x = 0; x < 10; x++) {
+                int correct = 3 * (x * 1000 + y);
+                if (im(x, y) != correct) {
+                    printf("im(%d, %d) = %d instead of %d\n", x, y, im(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // Sliding in two dimensions across serial tiles.
+        Var xo, yo, xi, yi;
+        Func f, g;
+
+        f(x, y) = call_counter(x, y);
+        g(x, y) = f(x, y) + f(x + 1, y) + f(x, y + 1) + f(x + 1, y + 1);
+
+        g.tile(x, y, xo, yo, xi, yi, 4, 4);
+        f.store_root().compute_at(g, xi);
+
+        count = 0;
+        Buffer<int> im = g.realize(16, 16);
+
+        if (count != 17 * 17) {
+            printf("f was called %d times instead of %d times\n", count, 17 * 17);
+            return -1;
+        }
+
+        for (int y = 0; y < 16; y++) {
+            for (int x = 0; x < 16; x++) {
+                int correct = 4 * (x * 1000 + y) + 2000 + 2;
+                if (im(x, y) != correct) {
+                    printf("im(%d, %d) = %d instead of %d\n", x, y, im(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
     printf("Success!\n");
     return 0;
 }
@@ -0,0 +1,149 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the loads from a buffer that happen outside of the loops
+// over a given variable. A software pipelined loop does the loads for
+// its first iteration before the loop starts.
+class CountLoadsOutsideLoop : public IRVisitor {
+    using IRVisitor::visit;
+
+    const std::string &loop, &buffer;
+    int depth = 0;
+
+    void visit(const For *op) override {
+        bool is_loop = ends_with(op->name, loop);
+        if (is_loop) {
+            depth++;
+        }
+        IRVisitor::visit(op);
+        if (is_loop) {
+            depth--;
+        }
+    }
+
+    void visit(const Load *op) override {
+        if (depth == 0 && op->name == buffer) {
+            loads++;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    int loads = 0;
+    CountLoadsOutsideLoop(const std::string &l, const std::string &b)
+        : loop(l), buffer(b) {
+    }
+};
+
+class CheckPipelined : public IRMutator {
+    std::string loop, buffer;
+    int &loads;
+
+public:
+    CheckPipelined(const std::string &l, const std::string &b, int &count)
+        : loop(l), buffer(b), loads(count) {
+    }
+
+    using IRMutator::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        CountLoadsOutsideLoop counter(loop, buffer);
+        s.accept(&counter);
+        loads = counter.loads;
+        return s;
+    }
+};
+
+const int size = 64;
+
+int check(const Buffer<int> &result, std::function<int(int, int)> correct, const char *name) {
+    for (int y = 0; y < result.height(); y++) {
+        for (int x = 0; x < result.width(); x++) {
+            if (result(x, y) != correct(x, y)) {
+                printf("%s: result(%d, %d) = %d instead of %d\n",
+                       name, x, y, result(x, y), correct(x, y));
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Buffer<int> input(size, size, "input");
+    input.for_each_element([&](int x, int y) { input(x, y) = (x * 17 + y * 31) % 101; });
+    Buffer<int> lut(size, size, "lut");
+    lut.for_each_element([&](int x, int y) { lut(x, y) = (x * 13 + y * 7) % size; });
+
+    {
+        // A vectorized gather. The loads of the next vector, including
+        // the loads from the lookup table they depend on, should be
+        // issued before the current vector is computed.
+        Var x("x"), y("y"), xo("xo"), xi("xi");
+        Func out("out");
+        out(x, y) = input(clamp(lut(x, y), 0, size - 1), y) + input(x, y);
+        out.split(x, xo, xi, 8).vectorize(xi).software_pipeline(xo);
+
+        int loads = 0;
+        out.add_custom_lowering_pass(new CheckPipelined(".xo", "input", loads));
+        Buffer<int> result = out.realize(size, size);
+        if (check(result, [&](int x, int y) { return input(lut(x, y), y) + input(x, y); }, "gather") != 0) {
+            return -1;
+        }
+        if (loads == 0) {
+            printf("gather: Expected loads from input before the loop over xo\n");
+            return -1;
+        }
+    }
+
+    {
+        // A prefix sum. The loads from input can be done early, but
+        // the loads from the Func itself must stay where they are.
+        Var x("x"), y("y");
+        RDom r(1, size - 1, "r");
+        Func sum("sum");
+        sum(x, y) = input(x, y);
+        sum(r, y) = sum(r - 1, y) + input(r, y);
+        sum.update().software_pipeline(r);
+
+        int loads = 0;
+        sum.add_custom_lowering_pass(new CheckPipelined(".r$x", "input", loads));
+        Buffer<int> result = sum.realize(size, size);
+        auto correct = [&](int x, int y) {
+            int s = 0;
+            for (int i = 0; i <= x; i++) {
+                s += input(i, y);
+            }
+            return s;
+        };
+        if (check(result, correct, "prefix sum") != 0) {
+            return -1;
+        }
+        if (loads == 0) {
+            printf("prefix sum: Expected loads from input before the loop over r\n");
+            return -1;
+        }
+    }
+
+    {
+        // A loop with a producer computed inside it can't be
+        // pipelined, and should just run serially.
+        Var x("x"), y("y");
+        Func f("f"), out("out");
+        f(x, y) = input(x, y) * 2;
+        out(x, y) = f(x, y) + f(x, y + 1);
+        f.compute_at(out, y);
+        out.software_pipeline(y);
+
+        Buffer<int> result = out.realize(size, size - 1);
+        if (check(result, [&](int x, int y) { return 2 * (input(x, y) + input(x, y + 1)); }, "serial") != 0) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
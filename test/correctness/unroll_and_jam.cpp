@@ -0,0 +1,110 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the loops over the RDom, and the stores inside them.
+class CountStoresInRLoops : public IRVisitor {
+    using IRVisitor::visit;
+
+    int depth = 0;
+
+    void visit(const For *op) override {
+        bool is_r = op->name.find(".r$x") != std::string::npos;
+        if (is_r) {
+            loops++;
+            depth++;
+        }
+        IRVisitor::visit(op);
+        if (is_r) {
+            depth--;
+        }
+    }
+
+    void visit(const Store *op) override {
+        if (depth > 0 && op->name == "prod") {
+            stores++;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    int loops = 0, stores = 0;
+};
+
+class CheckJammed : public IRMutator {
+    int &loops, &stores;
+
+public:
+    CheckJammed(int &l, int &s)
+        : loops(l), stores(s) {
+    }
+
+    using IRMutator::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        CountStoresInRLoops counter;
+        s.accept(&counter);
+        loops = counter.loops;
+        stores = counter.stores;
+        return s;
+    }
+};
+
+int main(int argc, char **argv) {
+    const int size = 64;
+    Buffer<float> A(size, size), B(size, size);
+    A.for_each_element([&](int x, int y) { A(x, y) = (float)((x * 3 + y) % 7); });
+    B.for_each_element([&](int x, int y) { B(x, y) = (float)((x + y * 5) % 11); });
+
+    for (int jam = 0; jam < 2; jam++) {
+        Var x("x"), y("y"), xi("xi"), yi("yi");
+        RDom r(0, size, "r");
+
+        Func prod("prod"), out("out");
+        prod(x, y) = 0.0f;
+        prod(x, y) += A(r, y) * B(x, r);
+        out(x, y) = prod(x, y);
+
+        // Register-block the matrix multiply: each iteration of r
+        // updates a 8x4 tile of the output, with x vectorized.
+        out.tile(x, y, xi, yi, 8, 4).vectorize(xi);
+        prod.compute_at(out, x).vectorize(x);
+        prod.update().reorder(x, r, y).vectorize(x);
+        if (jam) {
+            prod.update().unroll_and_jam(y);
+        } else {
+            prod.update().unroll(y);
+        }
+
+        int loops = 0, stores = 0;
+        out.add_custom_lowering_pass(new CheckJammed(loops, stores));
+        Buffer<float> result = out.realize(size, size);
+
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                float correct = 0.0f;
+                for (int k = 0; k < size; k++) {
+                    correct += A(k, y) * B(x, k);
+                }
+                if (result(x, y) != correct) {
+                    printf("result(%d, %d) = %f instead of %f\n", x, y, result(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+
+        // Unrolling y makes one loop over r per row of the tile, and
+        // jamming fuses them into one.
+        int expected_loops = jam ? 1 : 4;
+        if (loops != expected_loops || stores != 4) {
+            printf("Expected %d loops over r with 4 stores in total, got %d loops with %d stores\n",
+                   expected_loops, loops, stores);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
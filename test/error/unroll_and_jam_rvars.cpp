@@ -0,0 +1,22 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    RDom r(0, 10, 0, 10);
+
+    Func f("f");
+    Var x, y;
+    f(x, y) = x + y;
+    f(r.x, r.y) += f(r.y, r.x);
+
+    // Jamming r.y into r.x interleaves their iterations, which is not
+    // permitted when it could change the meaning.
+    f.update().unroll_and_jam(r.y);
+
+    f.realize(10, 10);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+#include "halide_benchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "batch.h"
+
+using namespace Halide::Runtime;
+using namespace Halide::Tools;
+
+const int kSize = 64;
+const int kItems = 256;
+
+void my_error_handler(void *user_context, const char *msg) {
+    // Swallow the message; the test checks the returned code instead.
+}
+
+int main(int argc, char **argv) {
+    halide_set_error_handler(my_error_handler);
+
+    std::vector<Buffer<uint8_t>> inputs;
+    std::vector<Buffer<int32_t>> outputs;
+    std::vector<int32_t> offsets(kItems);
+    for (int i = 0; i < kItems; i++) {
+        Buffer<uint8_t> in(kSize, kSize);
+        in.for_each_element([&](int x, int y) { in(x, y) = (uint8_t)(x + y * i); });
+        inputs.push_back(in);
+        outputs.push_back(Buffer<int32_t>(kSize, kSize));
+        offsets[i] = i;
+    }
+
+    std::vector<void *> args(kItems * 3);
+    std::vector<void **> item_args(kItems);
+    for (int i = 0; i < kItems; i++) {
+        args[i * 3 + 0] = inputs[i].raw_buffer();
+        args[i * 3 + 1] = &offsets[i];
+        args[i * 3 + 2] = outputs[i].raw_buffer();
+        item_args[i] = &args[i * 3];
+    }
+
+    int result = halide_do_batch(nullptr, batch_argv, batch_metadata(), item_args.data(), kItems);
+    if (result != 0) {
+        printf("halide_do_batch failed: %d\n", result);
+        return -1;
+    }
+
+    for (int i = 0; i < kItems; i++) {
+        for (int y = 0; y < kSize; y++) {
+            for (int x = 0; x < kSize; x++) {
+                int32_t correct = inputs[i](x, y) * 3 + i;
+                if (outputs[i](x, y) != correct) {
+                    printf("outputs[%d](%d, %d) = %d instead of %d\n",
+                           i, x, y, outputs[i](x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // Compare against calling the pipeline once per item. Batching
+    // runs the items on the thread pool, so it should be faster on a
+    // machine with more than one core, despite the extra checks.
+    double t_batch = benchmark([&]() {
+        halide_do_batch(nullptr, batch_argv, batch_metadata(), item_args.data(), kItems);
+    });
+    double t_serial = benchmark([&]() {
+        for (int i = 0; i < kItems; i++) {
+            batch(inputs[i], offsets[i], outputs[i]);
+        }
+    });
+    printf("Batched: %f us per item\n"
+           "Serial: %f us per item\n",
+           t_batch * 1e6 / kItems, t_serial * 1e6 / kItems);
+    if (std::thread::hardware_concurrency() > 1 && t_batch >= t_serial) {
+        printf("Batching was no faster than calling the pipeline once per item\n");
+        return -1;
+    }
+
+    // An item whose buffers differ in shape from the first item
+    // should be rejected before any item runs.
+    Buffer<int32_t> wrong_shape(kSize + 1, kSize);
+    outputs[0].fill(0);
+    args[(kItems - 1) * 3 + 2] = wrong_shape.raw_buffer();
+    result = halide_do_batch(nullptr, batch_argv, batch_metadata(), item_args.data(), kItems);
+    if (result != halide_error_code_constraint_violated) {
+        printf("Expected a constraint violation, got %d\n", result);
+        return -1;
+    }
+    if (outputs[0](0, 0) != 0) {
+        printf("An item ran despite a malformed batch\n");
+        return -1;
+    }
+
+    // Likewise for a buffer of the wrong type.
+    Buffer<float> wrong_type(kSize, kSize);
+    args[(kItems - 1) * 3 + 2] = wrong_type.raw_buffer();
+    result = halide_do_batch(nullptr, batch_argv, batch_metadata(), item_args.data(), kItems);
+    if (result != halide_error_code_bad_type) {
+        printf("Expected a type error, got %d\n", result);
+        return -1;
+    }
+    args[(kItems - 1) * 3 + 2] = outputs[kItems - 1].raw_buffer();
+
+    // The pipeline is compiled without asserts, so halide_do_batch
+    // must also reject inputs that are too small for the outputs...
+    std::vector<Buffer<uint8_t>> small_inputs;
+    for (int i = 0; i < kItems; i++) {
+        small_inputs.push_back(Buffer<uint8_t>(kSize - 1, kSize));
+        args[i * 3 + 0] = small_inputs[i].raw_buffer();
+    }
+    result = halide_do_batch(nullptr, batch_argv, batch_metadata(), item_args.data(), kItems);
+    if (result != halide_error_code_access_out_of_bounds) {
+        printf("Expected an out of bounds error, got %d\n", result);
+        return -1;
+    }
+    for (int i = 0; i < kItems; i++) {
+        args[i * 3 + 0] = inputs[i].raw_buffer();
+    }
+
+    // ...and buffers with no host memory.
+    Buffer<uint8_t> no_host(nullptr, kSize, kSize);
+    args[3 * 3 + 0] = no_host.raw_buffer();
+    result = halide_do_batch(nullptr, batch_argv, batch_metadata(), item_args.data(), kItems);
+    if (result != halide_error_code_host_is_null) {
+        printf("Expected a null host error, got %d\n", result);
+        return -1;
+    }
+    if (outputs[0](0, 0) != 0) {
+        printf("An item ran despite a malformed batch\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include "Halide.h"
+
+namespace {
+
+class Batch : public Halide::Generator<Batch> {
+public:
+    Input<Buffer<uint8_t>> input{"input", 2};
+    Input<int32_t> offset{"offset"};
+
+    Output<Buffer<int32_t>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+        output(x, y) = cast<int32_t>(input(x, y)) * 3 + offset;
+        output.vectorize(x, natural_vector_size<int32_t>());
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(Batch, batch)
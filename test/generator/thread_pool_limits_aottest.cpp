@@ -0,0 +1,200 @@
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_pool_limits.h"
+
+using namespace Halide::Runtime;
+
+// Each caller of the pipeline passes a pointer to one of these as
+// its user_context, and a distinct client id.
+struct Client {
+    halide_thread_pool_limits_t limits;
+    std::atomic<int> active{0}, peak{0};
+};
+
+Client clients[4];
+
+int get_limits(void *user_context, halide_thread_pool_limits_t *limits) {
+    *limits = ((Client *)user_context)->limits;
+    return 0;
+}
+
+extern "C" int thread_pool_limits_work(int client, int x) {
+    Client &c = clients[client];
+    int active = ++c.active;
+    int peak = c.peak;
+    while (active > peak && !c.peak.compare_exchange_weak(peak, active)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    c.active--;
+    return x;
+}
+
+std::atomic<bool> stop{false};
+
+void run_batch(void *) {
+    Buffer<int> out(2000);
+    while (!stop) {
+        thread_pool_limits(&clients[3], 3, out);
+    }
+}
+
+void run_pipeline(int client, Buffer<int> &out) {
+    int ret = thread_pool_limits(&clients[client], client, out);
+    if (ret) {
+        printf("Non zero exit code: %d\n", ret);
+        exit(-1);
+    }
+    for (int x = 0; x < out.width(); x++) {
+        if (out(x) != x) {
+            printf("out(%d) = %d instead of %d\n", x, out(x), x);
+            exit(-1);
+        }
+    }
+}
+
+// A parallel loop of two iterations, for checking the order in which
+// queued jobs are started. The thread that owns the job blocks in its
+// iteration until released, as does a helper on the blocker job. Other
+// helpers record which job they started.
+struct OrderJob {
+    explicit OrderJob(const char *name)
+        : name(name) {
+    }
+    const char *name;
+    std::atomic<int> owner_started{0};
+    std::atomic<bool> release{false};
+};
+
+OrderJob blocker("blocker"), high_job("high"), normal_job("normal");
+thread_local OrderJob *owned_job = nullptr;
+std::atomic<int> helpers_blocked{0};
+std::atomic<bool> release_helper{false};
+std::mutex started_mutex;
+std::vector<std::string> started_by_helpers;
+
+void wait_for(const std::atomic<bool> &flag) {
+    while (!flag) {
+        std::this_thread::yield();
+    }
+}
+
+int order_task(void *user_context, int idx, uint8_t *closure) {
+    OrderJob *job = (OrderJob *)closure;
+    if (job == owned_job) {
+        job->owner_started++;
+        wait_for(job->release);
+    } else if (job == &blocker) {
+        helpers_blocked++;
+        wait_for(release_helper);
+    } else {
+        std::lock_guard<std::mutex> lock(started_mutex);
+        started_by_helpers.push_back(job->name);
+    }
+    return 0;
+}
+
+void run_order_job(Client *client, OrderJob *job) {
+    owned_job = job;
+    halide_do_par_for(client, order_task, 0, 2, (uint8_t *)job);
+}
+
+int main(int argc, char **argv) {
+    halide_set_custom_get_thread_pool_limits(get_limits);
+
+    // With one thread in the pool, queued high priority work is started
+    // before normal priority work, even if the normal priority job was
+    // queued later (and so is on top of the job stack). First occupy
+    // the pool's thread, and the thread that owns the blocker job.
+    halide_set_num_threads(2);
+    Client normal_client, high_client;
+    normal_client.limits = {0, halide_thread_pool_priority_normal};
+    high_client.limits = {0, halide_thread_pool_priority_high};
+    std::thread blocker_thread(run_order_job, &normal_client, &blocker);
+    while (helpers_blocked == 0 || blocker.owner_started == 0) {
+        std::this_thread::yield();
+    }
+    // Then queue a high priority job, then a normal priority one. The
+    // owner of the normal priority job takes the high priority job's
+    // spare iteration before starting its own. Once the pool's thread
+    // is free, it takes the normal priority job's spare iteration.
+    std::thread high_thread(run_order_job, &high_client, &high_job);
+    while (high_job.owner_started == 0) {
+        std::this_thread::yield();
+    }
+    std::thread normal_thread(run_order_job, &normal_client, &normal_job);
+    while (normal_job.owner_started == 0) {
+        std::this_thread::yield();
+    }
+    release_helper = true;
+    while (true) {
+        std::lock_guard<std::mutex> lock(started_mutex);
+        if (started_by_helpers.size() == 2) {
+            break;
+        }
+    }
+    blocker.release = high_job.release = normal_job.release = true;
+    blocker_thread.join();
+    high_thread.join();
+    normal_thread.join();
+    if (started_by_helpers[0] != "high" || started_by_helpers[1] != "normal") {
+        printf("Queued jobs were started in the wrong order: %s, %s\n",
+               started_by_helpers[0].c_str(), started_by_helpers[1].c_str());
+        return -1;
+    }
+
+    halide_set_num_threads(8);
+
+    Buffer<int> out(64);
+
+    // An unlimited client should spread across the pool, and a limited
+    // one should not.
+    clients[0].limits = {0, halide_thread_pool_priority_normal};
+    clients[1].limits = {2, halide_thread_pool_priority_normal};
+    run_pipeline(0, out);
+    run_pipeline(1, out);
+    printf("Peak threads: %d unlimited, %d with a limit of 2\n",
+           (int)clients[0].peak, (int)clients[1].peak);
+    if (clients[1].peak > 2) {
+        printf("Thread limit exceeded\n");
+        return -1;
+    }
+    if (clients[0].peak <= 2) {
+        printf("Unlimited client did not use the thread pool\n");
+        return -1;
+    }
+
+    // A limited batch client keeps running alongside a high priority
+    // client, and should stay within its limit while the high priority
+    // client's tasks are scheduled ahead of its own.
+    clients[2].limits = {0, halide_thread_pool_priority_high};
+    clients[3].limits = {4, halide_thread_pool_priority_normal};
+
+    halide_thread *t = halide_spawn_thread(&run_batch, NULL);
+    while (clients[3].peak == 0) {
+        std::this_thread::yield();
+    }
+    for (int i = 0; i < 20; i++) {
+        run_pipeline(2, out);
+    }
+    stop = true;
+    halide_join_thread(t);
+
+    printf("Peak threads: %d high priority, %d batch with a limit of 4\n",
+           (int)clients[2].peak, (int)clients[3].peak);
+    if (clients[3].peak > 4) {
+        printf("Thread limit of batch client exceeded\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,24 @@
+#include "Halide.h"
+
+namespace Ext {
+HalideExtern_2(int, thread_pool_limits_work, int, int)
+}
+
+using namespace Halide;
+
+class ThreadPoolLimits : public Generator<ThreadPoolLimits> {
+public:
+    // Identifies the caller, so the test can track how many threads
+    // are working for each one.
+    Input<int> client{"client"};
+
+    Output<Buffer<int>> output{"output", 1};
+
+    void generate() {
+        Var x;
+        output(x) = Ext::thread_pool_limits_work(client, x);
+        output.parallel(x);
+    }
+};
+
+HALIDE_REGISTER_GENERATOR(ThreadPoolLimits, thread_pool_limits)
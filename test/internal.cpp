@@ -17,6 +17,7 @@
 #include "ModulusRemainder.h"
 #include "Monotonic.h"
 #include "Reduction.h"
+#include "Serialization.h"
 #include "Solve.h"
 #include "UniquifyVariableNames.h"
 
@@ -42,6 +43,7 @@ int main(int argc, const char **argv) {
     generator_test();
     propagate_estimate_test();
     uniquify_variable_names_test();
+    serialization_test();
 
     return 0;
 }
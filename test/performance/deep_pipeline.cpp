@@ -0,0 +1,89 @@
+#include "Halide.h"
+
+#include "halide_benchmark.h"
+#include <cstdio>
+#include <vector>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Measures how long the compiler takes to lower image pyramids of
+// increasing depth. Bounds inference over the nested loops of the
+// coarser levels tends to dominate for deep pyramids, so the time
+// per level should stay roughly flat as the depth grows.
+
+Func downsample(Func f, Var x, Var y) {
+    Func downx, downy;
+    downx(x, y) = (f(2 * x - 1, y) + 3.0f * (f(2 * x, y) + f(2 * x + 1, y)) + f(2 * x + 2, y)) / 8.0f;
+    downy(x, y) = (downx(x, 2 * y - 1) + 3.0f * (downx(x, 2 * y) + downx(x, 2 * y + 1)) + downx(x, 2 * y + 2)) / 8.0f;
+    return downy;
+}
+
+Func upsample(Func f, Var x, Var y) {
+    Func upx, upy;
+    upx(x, y) = 0.25f * f((x / 2) - 1 + 2 * (x % 2), y) + 0.75f * f(x / 2, y);
+    upy(x, y) = 0.25f * upx(x, (y / 2) - 1 + 2 * (y % 2)) + 0.75f * upx(x, y / 2);
+    return upy;
+}
+
+// Sharpen an image by boosting each level of its Laplacian pyramid.
+Func pyramid(ImageParam input, int levels) {
+    Var x("x"), y("y"), yo("yo");
+
+    Func clamped = BoundaryConditions::repeat_edge(input);
+    Func floating;
+    floating(x, y) = clamped(x, y) / 65535.0f;
+
+    std::vector<Func> gPyramid(levels), lPyramid(levels), outGPyramid(levels);
+    gPyramid[0](x, y) = floating(x, y);
+    for (int j = 1; j < levels; j++) {
+        gPyramid[j](x, y) = downsample(gPyramid[j - 1], x, y)(x, y);
+    }
+    lPyramid[levels - 1](x, y) = gPyramid[levels - 1](x, y);
+    for (int j = levels - 2; j >= 0; j--) {
+        lPyramid[j](x, y) = gPyramid[j](x, y) - upsample(gPyramid[j + 1], x, y)(x, y);
+    }
+    outGPyramid[levels - 1](x, y) = lPyramid[levels - 1](x, y);
+    for (int j = levels - 2; j >= 0; j--) {
+        outGPyramid[j](x, y) = upsample(outGPyramid[j + 1], x, y)(x, y) + 1.5f * lPyramid[j](x, y);
+    }
+
+    Func output("output");
+    output(x, y) = cast<uint16_t>(clamp(outGPyramid[0](x, y), 0.0f, 1.0f) * 65535.0f);
+
+    // The fine levels are computed in strips of the output, and the
+    // coarse ones all at once.
+    output.split(y, yo, y, 64).parallel(yo).vectorize(x, 8);
+    for (int j = 1; j < levels; j++) {
+        gPyramid[j].compute_root().parallel(y, 8).vectorize(x, 8);
+    }
+    for (int j = 0; j < levels; j++) {
+        if (j < 4) {
+            outGPyramid[j].store_at(output, yo).compute_at(output, y).vectorize(x, 8);
+        } else {
+            outGPyramid[j].compute_root();
+        }
+    }
+
+    return output;
+}
+
+int main(int argc, char **argv) {
+    Target t("x86-64-linux-sse41-avx-avx2");
+
+    for (int levels : {4, 8, 12, 16}) {
+        ImageParam input(UInt(16), 2, "input");
+        Func output = pyramid(input, levels);
+
+        // Lowering takes a while, so just take the best of a few runs.
+        double time = benchmark(3, 1, [&]() {
+            output.compile_to_module({input}, "pyramid", t);
+        });
+
+        printf("Lowering a pyramid with %d levels: %g ms (%g ms per level)\n",
+               levels, time * 1e3, time * 1e3 / levels);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
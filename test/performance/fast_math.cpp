@@ -0,0 +1,81 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+#include <string>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Benchmark the vectorizable transcendental approximations at each
+// precision against the precise versions, in the style of the
+// fast_pow and fast_sine_cosine tests.
+
+const int W = 1024, H = 256;
+
+double time_func(const Expr &e, const Var &x, const Var &y) {
+    Func f;
+    f(x, y) = e;
+    f.vectorize(x, 8);
+    f.compile_jit();
+    Buffer<float> out(W, H);
+    return 1e9 * benchmark([&]() { f.realize(out); }) / (W * H);
+}
+
+int main(int argc, char **argv) {
+    Var x, y;
+    // Inputs in [-8, 8] for the odd functions, and (0, 16] for log2.
+    Expr t = (x + y * W) * (16.0f / (W * H));
+    Expr s = t - 8.0f;
+    Expr u = (x + 1.0f) / W - 0.5f;
+
+    struct {
+        const char *name;
+        Expr precise;
+        Expr fast[3];
+    } funcs[] = {
+        {"exp2", exp(s * logf(2.0f)),
+         {fast_exp2(s, ApproximationPrecision::Low),
+          fast_exp2(s, ApproximationPrecision::Medium),
+          fast_exp2(s, ApproximationPrecision::High)}},
+        {"log2", log(t + 1e-3f) / logf(2.0f),
+         {fast_log2(t + 1e-3f, ApproximationPrecision::Low),
+          fast_log2(t + 1e-3f, ApproximationPrecision::Medium),
+          fast_log2(t + 1e-3f, ApproximationPrecision::High)}},
+        {"tanh", tanh(s),
+         {fast_tanh(s, ApproximationPrecision::Low),
+          fast_tanh(s, ApproximationPrecision::Medium),
+          fast_tanh(s, ApproximationPrecision::High)}},
+        {"sigmoid", 1.0f / (1.0f + exp(-s)),
+         {fast_sigmoid(s, ApproximationPrecision::Low),
+          fast_sigmoid(s, ApproximationPrecision::Medium),
+          fast_sigmoid(s, ApproximationPrecision::High)}},
+        {"erf", erf(s),
+         {fast_erf(s, ApproximationPrecision::Low),
+          fast_erf(s, ApproximationPrecision::Medium),
+          fast_erf(s, ApproximationPrecision::High)}},
+        {"atan2", atan2(s, u),
+         {fast_atan2(s, u, ApproximationPrecision::Low),
+          fast_atan2(s, u, ApproximationPrecision::Medium),
+          fast_atan2(s, u, ApproximationPrecision::High)}},
+    };
+
+    for (const auto &f : funcs) {
+        double precise = time_func(f.precise, x, y);
+        double low = time_func(f.fast[0], x, y);
+        double medium = time_func(f.fast[1], x, y);
+        double high = time_func(f.fast[2], x, y);
+        printf("%s: %f ns per pixel\n"
+               "fast_%s: %f (Low) %f (Medium) %f (High) ns per pixel\n",
+               f.name, precise, f.name, low, medium, high);
+
+        // The precise versions of these call libm once per lane.
+        if ((f.name == std::string("tanh") || f.name == std::string("atan2")) &&
+            precise < 1.5f * medium) {
+            printf("fast_%s is not 1.5x faster than %s\n", f.name, f.name);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -50,6 +50,31 @@ int main(int argc, char **argv) {
         return 0;
     }
 
+    // Now check the overhead of the thread pool on a parallel loop
+    // with many very cheap iterations, where claiming each iteration
+    // could otherwise dominate.
+    {
+        const int rows = 1 << 18;
+        Func cheap, cheap_serial;
+        cheap(x, y) = x + y;
+        cheap_serial(x, y) = x + y;
+        cheap.parallel(y);
+
+        Buffer<int> cheap_out = cheap.realize(4, rows);
+        Buffer<int> cheap_serial_out = cheap_serial.realize(4, rows);
+
+        double cheap_parallel_time = benchmark([&]() { cheap.realize(cheap_out); });
+        double cheap_serial_time = benchmark([&]() { cheap_serial.realize(cheap_serial_out); });
+
+        printf("Cheap iterations: %f ns per iteration in parallel, %f ns in serial\n",
+               1e9 * cheap_parallel_time / rows, 1e9 * cheap_serial_time / rows);
+
+        if (cheap_parallel_time > 4 * cheap_serial_time) {
+            fprintf(stderr, "WARNING: Thread pool overhead per iteration is too high\n");
+            return 0;
+        }
+    }
+
     printf("Success!\n");
     return 0;
 }
@@ -0,0 +1,121 @@
+#include "Halide.h"
+
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Measures how long the compiler takes to lower a pipeline, and how
+// long the simplifier takes on the result. The pipeline is the
+// algorithm and CPU schedule of apps/local_laplacian, which is large
+// enough that lowering it is dominated by the simplifier.
+
+Func downsample(Func f, Var x, Var y) {
+    Func downx, downy;
+    downx(x, y, _) = (f(2 * x - 1, y, _) + 3.0f * (f(2 * x, y, _) + f(2 * x + 1, y, _)) + f(2 * x + 2, y, _)) / 8.0f;
+    downy(x, y, _) = (downx(x, 2 * y - 1, _) + 3.0f * (downx(x, 2 * y, _) + downx(x, 2 * y + 1, _)) + downx(x, 2 * y + 2, _)) / 8.0f;
+    return downy;
+}
+
+Func upsample(Func f, Var x, Var y) {
+    Func upx, upy;
+    upx(x, y, _) = 0.25f * f((x / 2) - 1 + 2 * (x % 2), y, _) + 0.75f * f(x / 2, y, _);
+    upy(x, y, _) = 0.25f * upx(x, (y / 2) - 1 + 2 * (y % 2), _) + 0.75f * upx(x, y / 2, _);
+    return upy;
+}
+
+Func local_laplacian(ImageParam input, Param<int> levels, Param<float> alpha, Param<float> beta) {
+    const int J = 8;
+    Var x("x"), y("y"), c("c"), k("k");
+
+    Func remap;
+    Expr fx = cast<float>(x) / 256.0f;
+    remap(x) = alpha * fx * exp(-fx * fx / 2.0f);
+
+    Func clamped = BoundaryConditions::repeat_edge(input);
+    Func floating;
+    floating(x, y, c) = clamped(x, y, c) / 65535.0f;
+    Func gray;
+    gray(x, y) = 0.299f * floating(x, y, 0) + 0.587f * floating(x, y, 1) + 0.114f * floating(x, y, 2);
+
+    Func gPyramid[J], lPyramid[J], inGPyramid[J], outLPyramid[J], outGPyramid[J];
+    Expr level = k * (1.0f / (levels - 1));
+    Expr idx = gray(x, y) * cast<float>(levels - 1) * 256.0f;
+    idx = clamp(cast<int>(idx), 0, (levels - 1) * 256);
+    gPyramid[0](x, y, k) = beta * (gray(x, y) - level) + level + remap(idx - 256 * k);
+    for (int j = 1; j < J; j++) {
+        gPyramid[j](x, y, k) = downsample(gPyramid[j - 1], x, y)(x, y, k);
+    }
+    lPyramid[J - 1](x, y, k) = gPyramid[J - 1](x, y, k);
+    for (int j = J - 2; j >= 0; j--) {
+        lPyramid[j](x, y, k) = gPyramid[j](x, y, k) - upsample(gPyramid[j + 1], x, y)(x, y, k);
+    }
+    inGPyramid[0](x, y) = gray(x, y);
+    for (int j = 1; j < J; j++) {
+        inGPyramid[j](x, y) = downsample(inGPyramid[j - 1], x, y)(x, y);
+    }
+    for (int j = 0; j < J; j++) {
+        Expr level = inGPyramid[j](x, y) * cast<float>(levels - 1);
+        Expr li = clamp(cast<int>(level), 0, levels - 2);
+        Expr lf = level - cast<float>(li);
+        outLPyramid[j](x, y) = (1.0f - lf) * lPyramid[j](x, y, li) + lf * lPyramid[j](x, y, li + 1);
+    }
+    outGPyramid[J - 1](x, y) = outLPyramid[J - 1](x, y);
+    for (int j = J - 2; j >= 0; j--) {
+        outGPyramid[j](x, y) = upsample(outGPyramid[j + 1], x, y)(x, y) + outLPyramid[j](x, y);
+    }
+
+    Func color;
+    float eps = 0.01f;
+    color(x, y, c) = outGPyramid[0](x, y) * (floating(x, y, c) + eps) / (gray(x, y) + eps);
+    Func output("output");
+    output(x, y, c) = cast<uint16_t>(clamp(color(x, y, c), 0.0f, 1.0f) * 65535.0f);
+
+    remap.compute_root();
+    Var yo;
+    output.reorder(c, x, y).split(y, yo, y, 64).parallel(yo).vectorize(x, 8);
+    gray.compute_root().parallel(y, 32).vectorize(x, 8);
+    for (int j = 1; j < 5; j++) {
+        inGPyramid[j].compute_root().parallel(y, 32).vectorize(x, 8);
+        gPyramid[j].compute_root().reorder_storage(x, k, y).reorder(k, y).parallel(y, 8).vectorize(x, 8);
+        outGPyramid[j].store_at(output, yo).compute_at(output, y).fold_storage(y, 8).vectorize(x, 8);
+    }
+    outGPyramid[0].compute_at(output, y).vectorize(x, 8);
+    for (int j = 5; j < J; j++) {
+        inGPyramid[j].compute_root();
+        gPyramid[j].compute_root().parallel(k);
+        outGPyramid[j].compute_root();
+    }
+
+    return output;
+}
+
+int main(int argc, char **argv) {
+    ImageParam input(UInt(16), 3, "input");
+    Param<int> levels("levels");
+    Param<float> alpha("alpha"), beta("beta");
+    Func output = local_laplacian(input, levels, alpha, beta);
+
+    Target t("x86-64-linux-sse41-avx-avx2");
+    std::vector<Argument> args = {input, levels, alpha, beta};
+
+    // Lowering takes a while, so just take the best of a few runs.
+    Internal::Stmt body;
+    double lower_time = benchmark(3, 1, [&]() {
+        Module m = output.compile_to_module(args, "local_laplacian", t);
+        body = m.functions().back().body;
+    });
+
+    Internal::Stmt simplified;
+    double simplify_time = benchmark(5, 1, [&]() {
+        simplified = Internal::simplify(body);
+    });
+
+    printf("Lowering local_laplacian: %g ms\n"
+           "Simplifying the lowered local_laplacian: %g ms\n",
+           lower_time * 1e3, simplify_time * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
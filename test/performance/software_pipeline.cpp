@@ -0,0 +1,82 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Compares a gather-heavy loop with and without software
+// pipelining. The gathers read from random locations in a table too
+// big to fit in cache, so most of them miss. With software pipelining
+// the gathers for the next vector are issued before the current one
+// is summed and stored, so that their latency overlaps with the
+// work of the previous iteration.
+
+const int table_size = 1 << 22;
+const int width = 1 << 12, height = 256;
+
+Func make_gather(ImageParam table, ImageParam indices, bool pipelined) {
+    Var x("x"), y("y"), xo("xo"), xi("xi");
+
+    Func out("out");
+    Expr idx = clamp(indices(x, y), 0, table_size - 1);
+    out(x, y) = (table(idx) +
+                 table((idx + 1) % table_size) +
+                 table((idx * 7) % table_size) +
+                 table((idx * 13) % table_size));
+
+    out.split(x, xo, xi, 8).vectorize(xi);
+    if (pipelined) {
+        out.software_pipeline(xo);
+    }
+    out.bound(x, 0, width).bound(y, 0, height);
+
+    return out;
+}
+
+int main(int argc, char **argv) {
+    ImageParam table(Float(32), 1), indices(Int(32), 2);
+
+    Buffer<float> table_buf(table_size);
+    for (int i = 0; i < table_size; i++) {
+        table_buf(i) = (rand() % 256) / 256.0f;
+    }
+    Buffer<int> indices_buf(width, height);
+    indices_buf.for_each_element([&](int x, int y) {
+        indices_buf(x, y) = rand() % table_size;
+    });
+    table.set(table_buf);
+    indices.set(indices_buf);
+
+    Buffer<float> serial_output(width, height);
+    Buffer<float> pipelined_output(width, height);
+
+    Func serial = make_gather(table, indices, false);
+    Func pipelined = make_gather(table, indices, true);
+    serial.compile_jit();
+    pipelined.compile_jit();
+
+    double t_serial = benchmark([&]() {
+        serial.realize(serial_output);
+    });
+    double t_pipelined = benchmark([&]() {
+        pipelined.realize(pipelined_output);
+    });
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (serial_output(x, y) != pipelined_output(x, y)) {
+                printf("pipelined(%d, %d) = %f instead of %f\n",
+                       x, y, pipelined_output(x, y), serial_output(x, y));
+                return -1;
+            }
+        }
+    }
+
+    printf("Serial: %fms\n"
+           "Software pipelined: %fms\n",
+           t_serial * 1e3, t_pipelined * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -109,6 +109,40 @@ void same_func_per_thread() {
     }
 }
 
+void callable_per_thread_executor(int index, const Callable &c) {
+    Buffer<int32_t> result(10);
+    for (int i = 0; i < 10; i++) {
+        c(bufs[index], index, result);
+        for (int j = 0; j < 10; j++) {
+            int64_t left = ((j - 1) * (int64_t)bufs[index](std::min(std::max(0, j - 1), 9)) + index * 75);
+            int64_t middle = (j * (int64_t)bufs[index](std::min(std::max(0, j), 9)) + index * 75);
+            int64_t right = ((j + 1) * (int64_t)bufs[index](std::min(std::max(0, j + 1), 9)) + index * 75);
+            assert(result(j) == (int32_t)(left + middle + right));
+        }
+    }
+}
+
+void callable_per_thread() {
+    std::thread threads[16];
+    test_func test;
+    Callable c;
+
+    {
+        std::lock_guard<std::mutex> lock(compiler_mutex);
+
+        c = test.f.compile_to_callable({test.in, test.p});
+    }
+
+    for (auto &thread : threads) {
+        thread = std::thread(callable_per_thread_executor,
+                             (int)(&thread - threads), std::cref(c));
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
 int main(int argc, char **argv) {
     for (auto &buf : bufs) {
         buf = Buffer<int32_t>(10);
@@ -123,7 +157,11 @@ int main(int argc, char **argv) {
     double same_time = benchmark(same_func_per_thread);
     printf("One compilation time: %fs.\n", same_time);
 
+    double callable_time = benchmark(callable_per_thread);
+    printf("One compilation to a Callable time: %fs.\n", callable_time);
+
     assert(same_time < separate_time);
+    assert(callable_time < separate_time);
 
     printf("Success!\n");
     return 0;
@@ -0,0 +1,95 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Compares unrolling the rows of a register-blocked matrix multiply
+// with unrolling and jamming them into the reduction loop. When the
+// rows are only unrolled, each one walks the whole reduction on its
+// own. Once they are jammed, the rows share one pass over the
+// reduction, so each row of B is loaded once per block rather than
+// once per row.
+
+const int matrix_size = 512;
+
+Func make_matrix_mul(ImageParam A, ImageParam B, bool jam) {
+    Var x("x"), y("y"), xi("xi"), yi("yi");
+    RDom k(0, matrix_size, "k");
+
+    Func prod("prod");
+    prod(x, y) = 0.0f;
+    prod(x, y) += A(k, y) * B(x, k);
+
+    Func out("out");
+    out(x, y) = prod(x, y);
+
+    out.tile(x, y, xi, yi, 16, 4)
+        .vectorize(xi, 8)
+        .parallel(y);
+
+    prod.compute_at(out, x)
+        .vectorize(x, 8);
+    prod.update()
+        .reorder(x, k, y)
+        .vectorize(x, 8)
+        .unroll(x);
+    if (jam) {
+        prod.update().unroll_and_jam(y);
+    } else {
+        prod.update().unroll(y);
+    }
+
+    out.bound(x, 0, matrix_size)
+        .bound(y, 0, matrix_size);
+
+    return out;
+}
+
+int main(int argc, char **argv) {
+    ImageParam A(Float(32), 2), B(Float(32), 2);
+
+    Buffer<float> mat_A(matrix_size, matrix_size);
+    Buffer<float> mat_B(matrix_size, matrix_size);
+    for (int iy = 0; iy < matrix_size; iy++) {
+        for (int ix = 0; ix < matrix_size; ix++) {
+            mat_A(ix, iy) = (rand() % 256) / 256.0f;
+            mat_B(ix, iy) = (rand() % 256) / 256.0f;
+        }
+    }
+    A.set(mat_A);
+    B.set(mat_B);
+
+    Buffer<float> unrolled_output(matrix_size, matrix_size);
+    Buffer<float> jammed_output(matrix_size, matrix_size);
+
+    Func unrolled = make_matrix_mul(A, B, false);
+    Func jammed = make_matrix_mul(A, B, true);
+    unrolled.compile_jit();
+    jammed.compile_jit();
+
+    double t_unrolled = benchmark([&]() {
+        unrolled.realize(unrolled_output);
+    });
+    double t_jammed = benchmark([&]() {
+        jammed.realize(jammed_output);
+    });
+
+    for (int iy = 0; iy < matrix_size; iy++) {
+        for (int ix = 0; ix < matrix_size; ix++) {
+            if (std::abs(unrolled_output(ix, iy) - jammed_output(ix, iy)) > 0.001f) {
+                printf("jammed(%d, %d) = %f instead of %f\n",
+                       ix, iy, jammed_output(ix, iy), unrolled_output(ix, iy));
+                return -1;
+            }
+        }
+    }
+
+    printf("Unrolled: %fms\n"
+           "Unrolled and jammed: %fms\n",
+           t_unrolled * 1e3, t_jammed * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}